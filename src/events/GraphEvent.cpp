@@ -30,9 +30,9 @@
 namespace envire { namespace core
 {
 
-std::ostream& operator<<(std::ostream& ostream, const GraphEvent& graph_event)
+std::ostream& operator<<(std::ostream& ostream, const GraphEvent::Type type)
 {
-    switch(graph_event.getType())
+    switch(type)
     {
         case GraphEvent::EDGE_ADDED:
             ostream << "EDGE_ADDED";
@@ -54,8 +54,16 @@ std::ostream& operator<<(std::ostream& ostream, const GraphEvent& graph_event)
             break;
         case GraphEvent::ITEM_REMOVED_FROM_FRAME:
             ostream << "ITEM_REMOVED_FROM_FRAME";
+            break;
+        case GraphEvent::EVENT_BATCH:
+            ostream << "EVENT_BATCH";
     }
     return ostream;
 }
 
+std::ostream& operator<<(std::ostream& ostream, const GraphEvent& graph_event)
+{
+    return ostream << graph_event.getType();
+}
+
 }}
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 #pragma once
 #include <envire_core/events/GraphEventExceptions.hpp>
+#include <iosfwd>
 
 namespace envire { namespace core
 {
@@ -44,7 +45,8 @@ namespace envire { namespace core
             ITEM_ADDED_TO_FRAME,
             ITEM_REMOVED_FROM_FRAME,
             FRAME_ADDED,
-            FRAME_REMOVED
+            FRAME_REMOVED,
+            EVENT_BATCH /**<A GraphEventBatch containing several of the above */
         };
 
         GraphEvent() = delete;
@@ -78,4 +80,6 @@ namespace envire { namespace core
         Type type;
     };
 
+    std::ostream& operator<<(std::ostream&, const GraphEvent::Type);
+
 }}
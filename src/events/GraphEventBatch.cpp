@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <envire_core/events/GraphEventBatch.hpp>
+
+namespace envire { namespace core
+{
+
+GraphEventBatch::GraphEventBatch() : GraphEvent(GraphEvent::EVENT_BATCH)
+{
+}
+
+GraphEventBatch::GraphEventBatch(const GraphEventBatch& other) : GraphEvent(GraphEvent::EVENT_BATCH)
+{
+    other.visitEvents([this](const GraphEvent& event)
+    {
+        events.emplace_back(event.clone());
+    });
+}
+
+std::size_t GraphEventBatch::add(const GraphEvent& event)
+{
+    if(event.getType() == GraphEvent::EVENT_BATCH)
+    {
+        const GraphEventBatch& batch = static_cast<const GraphEventBatch&>(event);
+        std::size_t merged = 0;
+        batch.visitEvents([this, &merged](const GraphEvent& containedEvent)
+        {
+            merged += add(containedEvent);
+        });
+        return merged;
+    }
+
+    std::size_t merged = 0;
+    std::list<std::unique_ptr<GraphEvent>>::iterator it = events.begin();
+    bool skip_event = false;
+    while(it != events.end())
+    {
+        // check if the new event supersedes one of the existing events
+        if((*it)->mergeable(event))
+        {
+            // in this case the remove event doesn't need to be published
+            if(((*it)->getType() == GraphEvent::EDGE_ADDED && event.getType() == GraphEvent::EDGE_REMOVED) ||
+                ((*it)->getType() == GraphEvent::FRAME_ADDED && event.getType() == GraphEvent::FRAME_REMOVED) ||
+                ((*it)->getType() == GraphEvent::ITEM_ADDED_TO_FRAME && event.getType() == GraphEvent::ITEM_REMOVED_FROM_FRAME)
+            )
+            {
+                skip_event = true;
+            }
+
+            it = events.erase(it);
+            ++merged;
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    if(skip_event)
+    {
+        ++merged;
+    }
+    else
+    {
+        events.emplace_back(event.clone());
+    }
+    return merged;
+}
+
+std::unique_ptr<GraphEvent> GraphEventBatch::popFront()
+{
+    std::unique_ptr<GraphEvent> event;
+    if(!events.empty())
+    {
+        event = std::move(events.front());
+        events.pop_front();
+    }
+    return event;
+}
+
+void GraphEventBatch::clear()
+{
+    events.clear();
+}
+
+GraphEvent* GraphEventBatch::clone() const
+{
+    return new GraphEventBatch(*this);
+}
+
+}}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/events/GraphEvent.hpp>
+#include <list>
+#include <memory>
+
+namespace envire { namespace core
+{
+    /**
+     * An event that bundles several other events.
+     * Events are added using add(). While adding, the batch coalesces the
+     * events in the same way the GraphEventQueue does: an event that supersedes
+     * a queued event removes the queued one, and an added/removed pair of the
+     * same frame, edge or item is dropped entirely. Thus the batch always
+     * contains the net change set of all events that have been added.
+     *
+     * Batches are emitted by the Graph when a transaction is committed.
+     */
+    class GraphEventBatch : public GraphEvent
+    {
+    public:
+        GraphEventBatch();
+
+        /**Creates a deep copy of @p other. All contained events are cloned. */
+        GraphEventBatch(const GraphEventBatch& other);
+
+        virtual ~GraphEventBatch() {}
+
+        /**Clones @p event and merges it into the batch.
+         * If @p event is a batch itself, its contained events are merged one by one.
+         * @return the number of events that have been merged away, i.e. queued
+         *         events that were superseded plus @p event itself if it was dropped
+         * @throw CloneMethodNotImplementedException if @p event cannot be cloned */
+        std::size_t add(const GraphEvent& event);
+
+        /**Removes the oldest event from the batch and returns it.
+         * Returns an empty pointer if the batch is empty. */
+        std::unique_ptr<GraphEvent> popFront();
+
+        /**Removes all events from the batch */
+        void clear();
+
+        /** @return true if the batch contains no events */
+        bool empty() const { return events.empty(); }
+
+        /** @return the number of events in the batch */
+        std::size_t size() const { return events.size(); }
+
+        /**Visits all events in the order in which they have been added.
+         * @param func should be callable with (const GraphEvent&) */
+        template <class Func>
+        void visitEvents(Func func) const
+        {
+            for(const std::unique_ptr<GraphEvent>& event : events)
+            {
+                func(*event);
+            }
+        }
+
+        virtual GraphEvent* clone() const;
+
+    private:
+        std::list<std::unique_ptr<GraphEvent>> events;
+    };
+
+}}
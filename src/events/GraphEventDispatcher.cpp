@@ -26,6 +26,7 @@
 
 #include <envire_core/events/GraphEventDispatcher.hpp>
 #include <envire_core/events/GraphEvent.hpp>
+#include <envire_core/events/GraphEventBatch.hpp>
 #include <envire_core/events/EdgeEvents.hpp>
 #include <envire_core/events/ItemAddedEvent.hpp>
 #include <envire_core/events/ItemRemovedEvent.hpp>
@@ -68,6 +69,9 @@ void GraphEventDispatcher::notifyGraphEvent(const GraphEvent& event)
         case GraphEvent::ITEM_REMOVED_FROM_FRAME:
             itemRemoved(dynamic_cast<const ItemRemovedEvent&>(event));
             break;
+        case GraphEvent::EVENT_BATCH:
+            eventBatch(dynamic_cast<const GraphEventBatch&>(event));
+            break;
         default:
         break;
         //no default case because we only handle basic event types here. Item events are handled
@@ -90,6 +94,14 @@ void GraphEventDispatcher::notifyGraphEvent(const GraphEvent& event)
             case GraphEvent::FRAME_REMOVED: break;
             case GraphEvent::ITEM_ADDED_TO_FRAME: break;
             case GraphEvent::ITEM_REMOVED_FROM_FRAME: break;
+            case GraphEvent::EVENT_BATCH:
+                //the batch might contain the frames we are waiting for.
+                //Once they are found the remaining events are dispatched normally.
+                dynamic_cast<const GraphEventBatch&>(event).visitEvents([this](const GraphEvent& e)
+                {
+                    notifyGraphEvent(e);
+                });
+                break;
             default: break;
         }
 
@@ -163,6 +175,13 @@ void GraphEventDispatcher::itemRemoved(const envire::core::ItemRemovedEvent& e)
     }
 }
 
+void GraphEventDispatcher::eventBatch(const GraphEventBatch& batch) {
+    batch.visitEvents([this](const GraphEvent& e)
+    {
+        notifyGraphEvent(e);
+    });
+}
+
 bool GraphEventDispatcher::checkWaitingForFrames(const FrameAddedEvent& frameAddedEvent)
 {
     // check if all frames are available, delete entires if they are
@@ -42,6 +42,7 @@ namespace envire { namespace core
     class FrameAddedEvent;
     class FrameRemovedEvent;
     class ItemAddedEvent;
+    class GraphEventBatch;
     class GraphEventPublisher;
 
     /**
@@ -100,6 +101,10 @@ namespace envire { namespace core
         virtual void frameRemoved(const FrameRemovedEvent& e);
         virtual void itemAdded(const ItemAddedEvent& e);
         virtual void itemRemoved(const ItemRemovedEvent& e);
+        /**Is called for each batch of events, e.g. when a transaction is
+         * committed. The default implementation dispatches each contained event
+         * individually. Override it to handle the whole batch at once.*/
+        virtual void eventBatch(const GraphEventBatch& batch);
 
     private:
         bool enabled;
@@ -41,4 +41,13 @@ public:
     const std::string msg;
 };
 
+class UnknownSubscriberException : public std::exception
+{
+public:
+    explicit UnknownSubscriberException() :
+        msg("The subscriber is not subscribed to this publisher") {}
+    virtual char const * what() const throw() { return msg.c_str(); }
+    const std::string msg;
+};
+
 }}
\ No newline at end of file
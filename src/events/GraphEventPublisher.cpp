@@ -33,17 +33,51 @@
 #include <algorithm>
 #include <envire_core/events/GraphEventPublisher.hpp>
 #include <envire_core/events/GraphEventSubscriber.hpp>
+#include <envire_core/events/FrameEvents.hpp>
+#include <envire_core/events/EdgeEvents.hpp>
+#include <envire_core/events/ItemAddedEvent.hpp>
+#include <envire_core/events/ItemRemovedEvent.hpp>
+#include <envire_core/events/GraphEventExceptions.hpp>
 #include <cassert>
+#include <ostream>
 
 using namespace envire::core;
 using namespace std;
 
 
-GraphEventPublisher::GraphEventPublisher() : insideNotify(false), enabled(true)
+GraphEventPublisher::GraphEventPublisher() :
+    insideNotify(false), deliveredBatchScopes(nullptr), enabled(true)
 {
     subscribers.reserve(10000);
 }
 
+GraphEventPublisher::GraphEventPublisher(const GraphEventPublisher& other) : GraphEventPublisher()
+{}
+
+GraphEventPublisher& GraphEventPublisher::operator=(const GraphEventPublisher& other)
+{
+    return *this;
+}
+
+void GraphEventPublisher::publishCurrentStateToAll()
+{
+    //handlers might (un)subscribe
+    const std::vector<GraphEventSubscriber*> current(subscribers);
+    for(GraphEventSubscriber* pSubscriber : current)
+    {
+        publishCurrentState(pSubscriber);
+    }
+}
+
+void GraphEventPublisher::unpublishCurrentStateToAll()
+{
+    const std::vector<GraphEventSubscriber*> current(subscribers);
+    for(GraphEventSubscriber* pSubscriber : current)
+    {
+        unpublishCurrentState(pSubscriber);
+    }
+}
+
 void GraphEventPublisher::subscribe(GraphEventSubscriber* pSubscriber, bool publish_current_state)
 {
     assert(nullptr != pSubscriber);
@@ -51,7 +85,18 @@ void GraphEventPublisher::subscribe(GraphEventSubscriber* pSubscriber, bool publ
         publishCurrentState(pSubscriber);
 
     if(insideNotify)
-      toBeSubscribed.push_back(pSubscriber);
+    {
+      auto pending = std::find(toBeUnsubscribed.begin(), toBeUnsubscribed.end(), pSubscriber);
+      //re-subscribing before the unsubscription took effect cancels it
+      if(pending != toBeUnsubscribed.end())
+      {
+        toBeUnsubscribed.erase(pending);
+        //unsubscribe() has emptied the scope
+        clearSubscriptionScope(pSubscriber);
+      }
+      else
+        toBeSubscribed.push_back(pSubscriber);
+    }
     else
       subscribers.push_back(pSubscriber);
 }
@@ -66,6 +111,14 @@ void GraphEventPublisher::unsubscribe(GraphEventSubscriber* pSubscriber, bool un
     if(insideNotify)
     {
       toBeUnsubscribed.push_back(pSubscriber);
+      //the subscriber stays in the list until the notification finishes.
+      //An empty scope keeps it from receiving the remaining scoped events
+      //while the routes are removed right away.
+      if(hasSubscriptionScope(pSubscriber))
+      {
+        replaceSubscriptionScope(pSubscriber, {});
+        subscriptionScopeCleared(pSubscriber);
+      }
     }
     else
     {
@@ -75,30 +128,337 @@ void GraphEventPublisher::unsubscribe(GraphEventSubscriber* pSubscriber, bool un
 
 void GraphEventPublisher::notify(const GraphEvent& e)
 {
-    if (enabled) {
+    if (enabled && pendingBatch) {
+        pendingBatch->add(e);
+    }
+    else if (enabled) {
         insideNotify = true;
-        
-        for(GraphEventSubscriber* pSubscriber : subscribers)
+        try
         {
-            pSubscriber->notifyGraphEvent(e);
+            //statistics might be enabled or disabled by the handlers
+            const bool timed = statistics != nullptr;
+            GraphEventStatistics::Clock::time_point eventStart;
+            if(timed)
+            {
+                eventStart = GraphEventStatistics::Clock::now();
+            }
+            if(scopes.empty())
+            {
+                for(GraphEventSubscriber* pSubscriber : subscribers)
+                {
+                    deliver(pSubscriber, e);
+                }
+            }
+            else
+            {
+                notifyScoped(e);
+            }
+            if(timed && statistics)
+            {
+                statistics->recordEvent(e.getType(),
+                    std::chrono::duration_cast<GraphEventStatistics::Duration>(
+                        GraphEventStatistics::Clock::now() - eventStart));
+            }
         }
-        
-        //update subscribers list (it might have been changed by event handlers)
-        //NOTE This is ***not*** meant to handle multithreading issues. It is only
-        //     meant to handle recursions in the same thread. This does ***not*** make
-        //     it thread-safe.
-        for(GraphEventSubscriber* pSubscriber : toBeSubscribed)
+        catch(...)
         {
-            subscribers.push_back(pSubscriber);
+            //the remaining subscribers miss the event, but the subscriber list stays valid
+            finishNotify();
+            throw;
         }
-        toBeSubscribed.clear();
-        
-        for(GraphEventSubscriber* pSubscriber : toBeUnsubscribed)
+        finishNotify();
+    }
+}
+
+void GraphEventPublisher::finishNotify()
+{
+    //update subscribers list (it might have been changed by event handlers)
+    //NOTE This is ***not*** meant to handle multithreading issues. It is only
+    //     meant to handle recursions in the same thread. This does ***not*** make
+    //     it thread-safe.
+    for(GraphEventSubscriber* pSubscriber : toBeSubscribed)
+    {
+        subscribers.push_back(pSubscriber);
+    }
+    toBeSubscribed.clear();
+    
+    for(GraphEventSubscriber* pSubscriber : toBeUnsubscribed)
+    {
+        unsubscribeInternal(pSubscriber);
+    }    
+    toBeUnsubscribed.clear();
+    
+    insideNotify = false;
+}
+
+void GraphEventPublisher::deliver(GraphEventSubscriber* pSubscriber, const GraphEvent& e)
+{
+    if(statistics)
+    {
+        const GraphEventStatistics::Clock::time_point start = GraphEventStatistics::Clock::now();
+        pSubscriber->notifyGraphEvent(e);
+        //a handler might have disabled the statistics
+        if(statistics)
         {
-            unsubscribeInternal(pSubscriber);
-        }    
-        
-        insideNotify = false;
+            statistics->recordDelivery(pSubscriber,
+                std::chrono::duration_cast<GraphEventStatistics::Duration>(
+                    GraphEventStatistics::Clock::now() - start));
+        }
+    }
+    else
+    {
+        pSubscriber->notifyGraphEvent(e);
+    }
+}
+
+namespace
+{
+    /**Collects the frames that @p e concerns.
+     * @return the number of frames written to @p first and @p second */
+    int getEventFrames(const GraphEvent& e, const FrameId*& first, const FrameId*& second)
+    {
+        switch(e.getType())
+        {
+            case GraphEvent::FRAME_ADDED:
+            case GraphEvent::FRAME_REMOVED:
+                first = &static_cast<const FrameEvent&>(e).frame;
+                return 1;
+            case GraphEvent::EDGE_ADDED:
+            case GraphEvent::EDGE_MODIFIED:
+            case GraphEvent::EDGE_REMOVED:
+                first = &static_cast<const EdgeEvent&>(e).origin;
+                second = &static_cast<const EdgeEvent&>(e).target;
+                return 2;
+            case GraphEvent::ITEM_ADDED_TO_FRAME:
+                first = &static_cast<const ItemAddedEvent&>(e).frame;
+                return 1;
+            case GraphEvent::ITEM_REMOVED_FROM_FRAME:
+                first = &static_cast<const ItemRemovedEvent&>(e).frame;
+                return 1;
+            default:
+                return 0;
+        }
+    }
+}
+
+void GraphEventPublisher::notifyScoped(const GraphEvent& e)
+{
+    for(GraphEventSubscriber* pSubscriber : subscribers)
+    {
+        if(scopes.find(pSubscriber) == scopes.end())
+        {
+            deliver(pSubscriber, e);
+        }
+    }
+
+    if(e.getType() == GraphEvent::EVENT_BATCH)
+    {
+        //every scoped subscriber gets the part of the batch that it is interested in.
+        //The handlers might modify the scopes, thus the subscribers are copied first
+        std::vector<GraphEventSubscriber*> scoped;
+        scoped.reserve(scopes.size());
+        for(const auto& scope : scopes)
+        {
+            scoped.push_back(scope.first);
+        }
+        const GraphEventBatch& batch = static_cast<const GraphEventBatch&>(e);
+        for(GraphEventSubscriber* pSubscriber : scoped)
+        {
+            GraphEventBatch filtered;
+            //the scope might have shrunk during the batch, removals are delivered for the frames
+            //that were in scope when the batch started
+            const std::unordered_set<FrameId>* startScope = nullptr;
+            if(deliveredBatchScopes)
+            {
+                auto scope = deliveredBatchScopes->find(pSubscriber);
+                if(scope != deliveredBatchScopes->end())
+                {
+                    startScope = &scope->second;
+                }
+            }
+            batch.visitEvents([&](const GraphEvent& event)
+            {
+                const FrameId* first = nullptr;
+                const FrameId* second = nullptr;
+                const int numFrames = getEventFrames(event, first, second);
+                bool inScope = (numFrames > 0 && isInSubscriptionScope(pSubscriber, *first)) ||
+                               (numFrames > 1 && isInSubscriptionScope(pSubscriber, *second));
+                if(!inScope && startScope != nullptr &&
+                   (event.getType() == GraphEvent::EDGE_REMOVED ||
+                    event.getType() == GraphEvent::ITEM_REMOVED_FROM_FRAME ||
+                    event.getType() == GraphEvent::FRAME_REMOVED))
+                {
+                    inScope = (numFrames > 0 && startScope->count(*first) > 0) ||
+                              (numFrames > 1 && startScope->count(*second) > 0);
+                }
+                if(inScope)
+                {
+                    filtered.add(event);
+                }
+            });
+            if(!filtered.empty())
+            {
+                deliver(pSubscriber, filtered);
+            }
+        }
+        return;
+    }
+
+    const FrameId* first = nullptr;
+    const FrameId* second = nullptr;
+    const int numFrames = getEventFrames(e, first, second);
+    std::vector<GraphEventSubscriber*> receivers;
+    if(numFrames > 0)
+    {
+        auto route = routes.find(*first);
+        if(route != routes.end())
+        {
+            receivers = route->second;
+        }
+    }
+    if(numFrames > 1)
+    {
+        auto route = routes.find(*second);
+        if(route != routes.end())
+        {
+            for(GraphEventSubscriber* pSubscriber : route->second)
+            {
+                //do not notify subscribers twice if both frames are in scope
+                if(std::find(receivers.begin(), receivers.end(), pSubscriber) == receivers.end())
+                {
+                    receivers.push_back(pSubscriber);
+                }
+            }
+        }
+    }
+    for(GraphEventSubscriber* pSubscriber : receivers)
+    {
+        deliver(pSubscriber, e);
+    }
+}
+
+void GraphEventPublisher::setSubscriptionScope(GraphEventSubscriber* pSubscriber,
+                                               const std::unordered_set<FrameId>& frames)
+{
+    assert(nullptr != pSubscriber);
+    if(!isSubscribed(pSubscriber))
+    {
+        //the scope would never be removed
+        throw UnknownSubscriberException();
+    }
+    const bool hadScope = hasSubscriptionScope(pSubscriber);
+    replaceSubscriptionScope(pSubscriber, frames);
+    if(hadScope)
+    {
+        //the old scope is gone, derived classes might need to clean up
+        subscriptionScopeCleared(pSubscriber);
+    }
+}
+
+void GraphEventPublisher::replaceSubscriptionScope(GraphEventSubscriber* pSubscriber,
+                                                   const std::unordered_set<FrameId>& frames)
+{
+    auto scope = scopes.find(pSubscriber);
+    if(scope != scopes.end())
+    {
+        for(const FrameId& frame : scope->second)
+        {
+            removeRoute(frame, pSubscriber);
+        }
+    }
+    scopes[pSubscriber] = frames;
+    for(const FrameId& frame : frames)
+    {
+        routes[frame].push_back(pSubscriber);
+    }
+}
+
+void GraphEventPublisher::addToSubscriptionScope(GraphEventSubscriber* pSubscriber, const FrameId& frame)
+{
+    auto scope = scopes.find(pSubscriber);
+    if(scope != scopes.end() && scope->second.insert(frame).second)
+    {
+        routes[frame].push_back(pSubscriber);
+    }
+}
+
+void GraphEventPublisher::removeFromSubscriptionScope(GraphEventSubscriber* pSubscriber, const FrameId& frame)
+{
+    auto scope = scopes.find(pSubscriber);
+    if(scope != scopes.end() && scope->second.erase(frame) > 0)
+    {
+        removeRoute(frame, pSubscriber);
+    }
+}
+
+void GraphEventPublisher::clearSubscriptionScope(GraphEventSubscriber* pSubscriber)
+{
+    auto scope = scopes.find(pSubscriber);
+    if(scope != scopes.end())
+    {
+        for(const FrameId& frame : scope->second)
+        {
+            removeRoute(frame, pSubscriber);
+        }
+        scopes.erase(scope);
+        subscriptionScopeCleared(pSubscriber);
+    }
+}
+
+bool GraphEventPublisher::hasSubscriptionScope(const GraphEventSubscriber* pSubscriber) const
+{
+    return scopes.find(const_cast<GraphEventSubscriber*>(pSubscriber)) != scopes.end();
+}
+
+bool GraphEventPublisher::isInSubscriptionScope(const GraphEventSubscriber* pSubscriber, const FrameId& frame) const
+{
+    auto scope = scopes.find(const_cast<GraphEventSubscriber*>(pSubscriber));
+    return scope == scopes.end() || scope->second.find(frame) != scope->second.end();
+}
+
+void GraphEventPublisher::removeRoute(const FrameId& frame, GraphEventSubscriber* pSubscriber)
+{
+    auto route = routes.find(frame);
+    if(route != routes.end())
+    {
+        std::vector<GraphEventSubscriber*>& receivers = route->second;
+        receivers.erase(std::remove(receivers.begin(), receivers.end(), pSubscriber), receivers.end());
+        if(receivers.empty())
+        {
+            routes.erase(route);
+        }
+    }
+}
+
+void GraphEventPublisher::enableStatistics(const bool &state)
+{
+    if(!state)
+    {
+        statistics.reset();
+    }
+    else if(!statistics)
+    {
+        statistics.reset(new GraphEventStatistics());
+    }
+}
+
+void GraphEventPublisher::resetStatistics()
+{
+    if(statistics)
+    {
+        statistics->reset();
+    }
+}
+
+void GraphEventPublisher::dumpStatistics(std::ostream& out) const
+{
+    if(statistics)
+    {
+        statistics->dump(out);
+    }
+    else
+    {
+        out << "Event statistics are disabled" << std::endl;
     }
 }
 
@@ -109,6 +469,39 @@ void GraphEventPublisher::notifySubscriber(GraphEventSubscriber* pSubscriber, co
     }
 }
 
+void GraphEventPublisher::beginEventBatch()
+{
+    if(!pendingBatch)
+    {
+        pendingBatch.reset(new GraphEventBatch());
+        batchScopes = scopes;
+    }
+}
+
+void GraphEventPublisher::endEventBatch()
+{
+    //release the batch first, otherwise notify() would add it to itself
+    std::unique_ptr<GraphEventBatch> batch(std::move(pendingBatch));
+    //handlers might start a new batch
+    ScopeMap startScopes;
+    startScopes.swap(batchScopes);
+    if(batch && !batch->empty())
+    {
+        const ScopeMap* outerScopes = deliveredBatchScopes;
+        deliveredBatchScopes = &startScopes;
+        try
+        {
+            notify(*batch);
+        }
+        catch(...)
+        {
+            deliveredBatchScopes = outerScopes;
+            throw;
+        }
+        deliveredBatchScopes = outerScopes;
+    }
+}
+
 GraphEventPublisher::~GraphEventPublisher()
 {
     //use while loop because unsubscribe() modifies the list
@@ -126,4 +519,19 @@ void GraphEventPublisher::unsubscribeInternal(GraphEventSubscriber* pSubscriber)
     {
       subscribers.erase(pos);
     }  
+    if(statistics)
+    {
+      statistics->removeSubscriber(pSubscriber);
+    }
+    clearSubscriptionScope(pSubscriber);
+}
+
+bool GraphEventPublisher::isSubscribed(const GraphEventSubscriber* pSubscriber) const
+{
+    if(std::find(toBeUnsubscribed.begin(), toBeUnsubscribed.end(), pSubscriber) != toBeUnsubscribed.end())
+    {
+        return false;
+    }
+    return std::find(subscribers.begin(), subscribers.end(), pSubscriber) != subscribers.end() ||
+           std::find(toBeSubscribed.begin(), toBeSubscribed.end(), pSubscriber) != toBeSubscribed.end();
 }
@@ -33,7 +33,13 @@
 
 #pragma once
 #include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <envire_core/items/ItemBase.hpp>
 #include <envire_core/events/GraphEvent.hpp>
+#include <envire_core/events/GraphEventBatch.hpp>
+#include <envire_core/events/GraphEventStatistics.hpp>
 
 namespace envire { namespace core
 {
@@ -57,6 +63,39 @@ namespace envire { namespace core
        * They will be moved to the subcribers list once notify() has finished*/
       std::vector<GraphEventSubscriber*> toBeSubscribed;
       std::vector<GraphEventSubscriber*> toBeUnsubscribed;
+      /**Collects all events while batching is active. Is null otherwise. */
+      std::unique_ptr<GraphEventBatch> pendingBatch;
+      /**Delivery statistics. Is null if statistics are disabled. */
+      std::unique_ptr<GraphEventStatistics> statistics;
+
+      using ScopeMap = std::unordered_map<GraphEventSubscriber*, std::unordered_set<FrameId>>;
+      /**Frames that a scoped subscriber is interested in.
+       * Subscribers that are not part of this map receive all events. */
+      ScopeMap scopes;
+      /**The scopes when the pending batch has been started. Scopes might
+       * shrink before the batch is delivered, removal events of frames that
+       * have left a scope are still delivered to the subscriber. */
+      ScopeMap batchScopes;
+      /**Points to the scopes at the start of the batch that is delivered
+       * by endEventBatch(). Is null otherwise. */
+      const ScopeMap* deliveredBatchScopes;
+      /**Routing table of the scoped subscribers. Maps each frame to the
+       * subscribers whose scope contains it. */
+      std::unordered_map<FrameId, std::vector<GraphEventSubscriber*>> routes;
+
+      /**Delivers @p e to @p pSubscriber and records the time of the call
+       * if statistics are enabled */
+      void deliver(GraphEventSubscriber* pSubscriber, const GraphEvent& e);
+
+      /**Delivers @p e to all unscoped subscribers and uses the routing
+       * table to find the scoped subscribers that are interested in @p e */
+      void notifyScoped(const GraphEvent& e);
+
+      /**Applies the subscriptions that have been changed inside notify().
+       * Is also called if an event handler throws. */
+      void finishNotify();
+
+      void removeRoute(const FrameId& frame, GraphEventSubscriber* pSubscriber);
 
     public:
         /**Subscribes the @param handler to all events by this event source */
@@ -67,6 +106,53 @@ namespace envire { namespace core
             enabled = state;
         }
 
+        /**Enables or disables the collection of delivery statistics.
+         * While enabled, every subscriber call in notify() is timed.
+         * Disabling discards all statistics collected so far. */
+        void enableStatistics(const bool &state = true);
+
+        /**@return the collected delivery statistics or nullptr if
+         *         statistics are disabled */
+        const GraphEventStatistics* getStatistics() const { return statistics.get(); }
+
+        /**Discards all statistics collected so far.
+         * Does nothing if statistics are disabled. */
+        void resetStatistics();
+
+        /**Writes a report of the collected statistics to @p out */
+        void dumpStatistics(std::ostream& out) const;
+
+        /**Restricts the events that @p pSubscriber receives to events that
+         * concern at least one of the given @p frames.
+         * Frame and item events concern their frame, edge events concern
+         * both origin and target. A GraphEventBatch is filtered and only the
+         * matching events are delivered (as a batch). Removal events of a batch
+         * are also delivered if their frame was in the scope when the batch
+         * started, even if it left the scope during the batch.
+         * Replaces a previously set scope.
+         * The scope is removed when the subscriber unsubscribes.
+         * @throw UnknownSubscriberException if @p pSubscriber is not subscribed */
+        void setSubscriptionScope(GraphEventSubscriber* pSubscriber,
+                                  const std::unordered_set<FrameId>& frames);
+
+        /**Adds @p frame to the scope of @p pSubscriber.
+         * Does nothing if the subscriber has no scope. */
+        void addToSubscriptionScope(GraphEventSubscriber* pSubscriber, const FrameId& frame);
+
+        /**Removes @p frame from the scope of @p pSubscriber.
+         * The subscriber remains scoped, even if the scope becomes empty. */
+        void removeFromSubscriptionScope(GraphEventSubscriber* pSubscriber, const FrameId& frame);
+
+        /**Removes the scope of @p pSubscriber. Afterwards it receives all events again */
+        void clearSubscriptionScope(GraphEventSubscriber* pSubscriber);
+
+        /**@return true if the events of @p pSubscriber are restricted to a scope */
+        bool hasSubscriptionScope(const GraphEventSubscriber* pSubscriber) const;
+
+        /**@return true if @p frame is part of the scope of @p pSubscriber.
+         *         Always true if the subscriber has no scope. */
+        bool isInSubscriptionScope(const GraphEventSubscriber* pSubscriber, const FrameId& frame) const;
+
     protected:
         /**Notify all subscribers about a certain graph event */
         void notify(const GraphEvent& e);
@@ -74,6 +160,28 @@ namespace envire { namespace core
         /**Notify the given subscriber about a certain graph event */
         void notifySubscriber(GraphEventSubscriber* pSubscriber, const GraphEvent& e);
 
+        /**Starts collecting events instead of notifying the subscribers.
+         * All events passed to notify() are merged into a single GraphEventBatch
+         * until endEventBatch() is called.
+         * Does nothing if batching is already active. */
+        void beginEventBatch();
+
+        /**Stops collecting events and notifies all subscribers about the
+         * collected GraphEventBatch. Subscribers are not notified if the batch
+         * is empty. Does nothing if batching is not active. */
+        void endEventBatch();
+
+        /**@return true if notify() would reach at least one subscriber.
+         * Mutators use this to skip the construction of events that
+         * nobody would receive. */
+        bool hasActiveSubscribers() const
+        {
+            return enabled && (!subscribers.empty() || !toBeSubscribed.empty());
+        }
+
+        /** @return true if events are currently collected in a batch */
+        bool isBatchingEvents() const { return pendingBatch != nullptr; }
+
         /**
          * @brief Publishes the current state of the graph.
          */
@@ -84,13 +192,41 @@ namespace envire { namespace core
          *        Basically the reverse process of publishCurrentState
          */
         virtual void unpublishCurrentState(GraphEventSubscriber* pSubscriber) = 0;
+
+        /**Calls publishCurrentState() for all subscribers */
+        void publishCurrentStateToAll();
+
+        /**Calls unpublishCurrentState() for all subscribers */
+        void unpublishCurrentStateToAll();
         
         void unsubscribeInternal(GraphEventSubscriber* pSubscriber);
 
+        /**@return true if @p pSubscriber is subscribed or will be subscribed
+         *         once the current notification finishes */
+        bool isSubscribed(const GraphEventSubscriber* pSubscriber) const;
+
+        /**Is called after the scope of @p pSubscriber has been removed or
+         * replaced by setSubscriptionScope().
+         * Derived classes that maintain scopes can use this to clean up. */
+        virtual void subscriptionScopeCleared(GraphEventSubscriber* pSubscriber) {}
+
+        /**Replaces the scope of @p pSubscriber without calling
+         * subscriptionScopeCleared() */
+        void replaceSubscriptionScope(GraphEventSubscriber* pSubscriber,
+                                      const std::unordered_set<FrameId>& frames);
+
         //there is no use in creating an instance of the publisher
         //on its own.
         GraphEventPublisher();
         
+        /**Does not copy anything. Subscribers, scopes, statistics and pending
+         * batches belong to the publisher that they have been set up at */
+        GraphEventPublisher(const GraphEventPublisher& other);
+        
+        /**Keeps the subscribers, scopes, statistics and the pending batch of
+         * this publisher. Only the graph data is assigned by derived classes */
+        GraphEventPublisher& operator=(const GraphEventPublisher& other);
+        
         virtual ~GraphEventPublisher();
 
 
@@ -43,46 +43,45 @@ envire::core::GraphEventQueue::~GraphEventQueue()
 
 void envire::core::GraphEventQueue::notifyGraphEvent(const envire::core::GraphEvent& event)
 {
-    std::list<GraphEvent*>::iterator it = event_queue.begin();
-    bool skip_event = false;
-    while(it != event_queue.end())
+    if(event.getType() == GraphEvent::EVENT_BATCH)
     {
-        // check if the new event supersedes one of the existing events
-        if((*it)->mergeable(event))
-        {
-            // in this case the remove event deosn't need to be published
-            if(((*it)->getType() == GraphEvent::EDGE_ADDED && event.getType() == GraphEvent::EDGE_REMOVED) ||
-                ((*it)->getType() == GraphEvent::FRAME_ADDED && event.getType() == GraphEvent::FRAME_REMOVED) ||
-                ((*it)->getType() == GraphEvent::ITEM_ADDED_TO_FRAME && event.getType() == GraphEvent::ITEM_REMOVED_FROM_FRAME)
-            )
-            {
-                skip_event = true;
-            }
-
-            it = event_queue.erase(it);
-        }
-        else
-        {
-            it++;
-        }
+        statistics.receivedEvents += static_cast<const GraphEventBatch&>(event).size();
     }
-
-    if(!skip_event)
+    else
+    {
+        ++statistics.receivedEvents;
+    }
+    statistics.mergedEvents += event_queue.add(event);
+    if(event_queue.size() > statistics.maxDepth)
     {
-        event_queue.push_back(event.clone());
+        statistics.maxDepth = event_queue.size();
     }
 }
 
 void envire::core::GraphEventQueue::flush()
 {
-    std::list<GraphEvent*>::iterator it = event_queue.begin();
-    while(it != event_queue.end())
+    // process() might cause new events, thus the queue is consumed one by one
+    std::unique_ptr<GraphEvent> event = event_queue.popFront();
+    while(event)
     {
-        envire::core::GraphEvent* event = *it;
+        ++statistics.processedEvents;
         process(*event);
-
-        // delete event
-        it = event_queue.erase(it);
-        delete event;
+        event = event_queue.popFront();
     }
-}
\ No newline at end of file
+}
+
+void envire::core::GraphEventQueue::resetStatistics()
+{
+    statistics = Statistics();
+}
+
+void envire::core::GraphEventQueue::dumpStatistics(std::ostream& out) const
+{
+    out << "Event queue statistics" << std::endl
+        << "  received events:  " << statistics.receivedEvents << std::endl
+        << "  merged events:    " << statistics.mergedEvents
+        << " (" << statistics.getMergeRate() * 100.0 << " %)" << std::endl
+        << "  processed events: " << statistics.processedEvents << std::endl
+        << "  current depth:    " << getQueueDepth() << std::endl
+        << "  max depth:        " << statistics.maxDepth << std::endl;
+}
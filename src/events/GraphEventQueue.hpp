@@ -28,7 +28,8 @@
 
 #include <envire_core/events/GraphEventSubscriber.hpp>
 #include <envire_core/events/GraphEvent.hpp>
-#include <list>
+#include <envire_core/events/GraphEventBatch.hpp>
+#include <ostream>
 
 namespace envire { namespace core
 {
@@ -36,11 +37,28 @@ namespace envire { namespace core
 class GraphEventQueue : public GraphEventSubscriber
 {
 public:
+    /**Counters describing the queue load since construction or the last
+     * call to resetStatistics() */
+    struct Statistics
+    {
+        std::size_t receivedEvents = 0; /**<Events received from the publisher (batches are counted per contained event) */
+        std::size_t mergedEvents = 0; /**<Events that have been merged away before they were processed */
+        std::size_t processedEvents = 0; /**<Events passed to process() */
+        std::size_t maxDepth = 0; /**<Largest number of events that were queued at once */
+
+        /**@return the fraction of received events that have been merged away */
+        double getMergeRate() const
+        {
+            return receivedEvents > 0 ? double(mergedEvents) / receivedEvents : 0.0;
+        }
+    };
+
     GraphEventQueue();
     GraphEventQueue(GraphEventPublisher* pPublisher);
     virtual ~GraphEventQueue();
 
-    /**This method is called by the publisher whenever a new event occurs */
+    /**This method is called by the publisher whenever a new event occurs.
+     * GraphEventBatches are unpacked and their events are queued individually. */
     virtual void notifyGraphEvent(const GraphEvent& event);
 
     /** Send all events currently stored in the queue to process */
@@ -49,8 +67,20 @@ public:
     /** This callback is called with each queued event when flush() is called */
     virtual void process( const GraphEvent& event ) = 0;
 
+    /**@return the number of events that are currently queued */
+    std::size_t getQueueDepth() const { return event_queue.size(); }
+
+    const Statistics& getStatistics() const { return statistics; }
+
+    void resetStatistics();
+
+    /**Writes a report of the queue statistics to @p out */
+    void dumpStatistics(std::ostream& out) const;
+
 private:
-    std::list<GraphEvent*> event_queue;
+    /**Queued events. The batch takes care of merging superseded events */
+    GraphEventBatch event_queue;
+    Statistics statistics;
 };
 
 }}
\ No newline at end of file
@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <envire_core/events/GraphEventStatistics.hpp>
+#include <envire_core/events/GraphEventSubscriber.hpp>
+#include <envire_core/util/Demangle.hpp>
+#include <iomanip>
+#include <sstream>
+#include <typeindex>
+
+namespace envire { namespace core
+{
+
+GraphEventStatistics::GraphEventStatistics() :
+    start(Clock::now()), eventTypes(GraphEvent::EVENT_BATCH + 1)
+{
+}
+
+void GraphEventStatistics::recordDelivery(const GraphEventSubscriber* subscriber,
+                                          const Duration& time)
+{
+    SubscriberStatistics& stats = subscribers[subscriber];
+    if(stats.calls == 0)
+    {
+        stats.typeName = demangleTypeName(std::type_index(typeid(*subscriber)));
+    }
+    ++stats.calls;
+    stats.totalTime += time;
+    if(time > stats.maxTime)
+    {
+        stats.maxTime = time;
+    }
+}
+
+void GraphEventStatistics::recordEvent(const GraphEvent::Type type, const Duration& time)
+{
+    EventTypeStatistics& stats = eventTypes[type];
+    ++stats.count;
+    stats.totalTime += time;
+}
+
+void GraphEventStatistics::removeSubscriber(const GraphEventSubscriber* subscriber)
+{
+    subscribers.erase(subscriber);
+}
+
+void GraphEventStatistics::reset()
+{
+    subscribers.clear();
+    eventTypes.assign(eventTypes.size(), EventTypeStatistics());
+    start = Clock::now();
+}
+
+GraphEventStatistics::SubscriberStatistics
+GraphEventStatistics::getSubscriberStatistics(const GraphEventSubscriber* subscriber) const
+{
+    auto it = subscribers.find(subscriber);
+    if(it == subscribers.end())
+    {
+        return SubscriberStatistics();
+    }
+    return it->second;
+}
+
+const GraphEventStatistics::EventTypeStatistics&
+GraphEventStatistics::getEventTypeStatistics(const GraphEvent::Type type) const
+{
+    return eventTypes[type];
+}
+
+double GraphEventStatistics::getEventRate(const GraphEvent::Type type) const
+{
+    const double seconds = std::chrono::duration<double>(getMeasurementDuration()).count();
+    if(seconds <= 0.0)
+    {
+        return 0.0;
+    }
+    return eventTypes[type].count / seconds;
+}
+
+GraphEventStatistics::Duration GraphEventStatistics::getMeasurementDuration() const
+{
+    return std::chrono::duration_cast<Duration>(Clock::now() - start);
+}
+
+void GraphEventStatistics::dump(std::ostream& out) const
+{
+    typedef std::chrono::duration<double, std::micro> Micros;
+
+    out << "Event statistics over " << std::chrono::duration<double>(getMeasurementDuration()).count()
+        << " s" << std::endl;
+    out << "  event type                    count      rate [1/s]   total [us]" << std::endl;
+    for(std::size_t i = 0; i < eventTypes.size(); ++i)
+    {
+        const GraphEvent::Type type = static_cast<GraphEvent::Type>(i);
+        const EventTypeStatistics& stats = eventTypes[i];
+        std::stringstream name;
+        name << type;
+        out << "  " << std::left << std::setw(26) << name.str() << std::right
+            << std::setw(9) << stats.count
+            << std::setw(16) << std::fixed << std::setprecision(2) << getEventRate(type)
+            << std::setw(13) << Micros(stats.totalTime).count() << std::endl;
+    }
+    out << "  subscriber                    calls      total [us]   max [us]" << std::endl;
+    for(const auto& entry : subscribers)
+    {
+        const SubscriberStatistics& stats = entry.second;
+        out << "  " << std::left << std::setw(26) << stats.typeName << std::right
+            << std::setw(9) << stats.calls
+            << std::setw(16) << std::fixed << std::setprecision(2) << Micros(stats.totalTime).count()
+            << std::setw(13) << Micros(stats.maxTime).count()
+            << "  (" << entry.first << ")" << std::endl;
+    }
+}
+
+}}
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/events/GraphEvent.hpp>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace envire { namespace core
+{
+    class GraphEventSubscriber;
+
+    /**
+     * Collects delivery statistics of a GraphEventPublisher.
+     * Statistics are only gathered if they have been enabled using
+     * GraphEventPublisher::enableStatistics().
+     */
+    class GraphEventStatistics
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+        typedef std::chrono::nanoseconds Duration;
+
+        /**Cost of a single subscriber */
+        struct SubscriberStatistics
+        {
+            std::string typeName; /**<Demangled dynamic type of the subscriber */
+            std::size_t calls = 0; /**<Number of delivered events */
+            Duration totalTime = Duration::zero(); /**<Cumulative time spent in notifyGraphEvent() */
+            Duration maxTime = Duration::zero(); /**<Longest single notifyGraphEvent() call */
+        };
+
+        /**Delivery statistics of one event type */
+        struct EventTypeStatistics
+        {
+            std::size_t count = 0; /**<Number of events published */
+            Duration totalTime = Duration::zero(); /**<Time spent delivering them to all subscribers */
+        };
+
+        GraphEventStatistics();
+
+        /**Records that @p subscriber needed @p time to handle an event */
+        void recordDelivery(const GraphEventSubscriber* subscriber, const Duration& time);
+
+        /**Records that an event of type @p type has been delivered to all
+         * subscribers within @p time */
+        void recordEvent(const GraphEvent::Type type, const Duration& time);
+
+        /**Forgets everything that has been recorded about @p subscriber */
+        void removeSubscriber(const GraphEventSubscriber* subscriber);
+
+        /**Discards all recorded data and restarts the measurement period */
+        void reset();
+
+        /**@return the statistics of @p subscriber.
+         *         Zeroed statistics if nothing has been recorded for it. */
+        SubscriberStatistics getSubscriberStatistics(const GraphEventSubscriber* subscriber) const;
+
+        /**@return the statistics of all subscribers that received at least one event */
+        const std::unordered_map<const GraphEventSubscriber*, SubscriberStatistics>& getSubscriberStatistics() const
+        {
+            return subscribers;
+        }
+
+        /**@return the statistics of all events of type @p type */
+        const EventTypeStatistics& getEventTypeStatistics(const GraphEvent::Type type) const;
+
+        /**@return the number of events of type @p type per second since the
+         *         last reset() */
+        double getEventRate(const GraphEvent::Type type) const;
+
+        /**@return the time since the last reset() */
+        Duration getMeasurementDuration() const;
+
+        /**Writes a human readable report to @p out */
+        void dump(std::ostream& out) const;
+
+    private:
+        Clock::time_point start;
+        std::unordered_map<const GraphEventSubscriber*, SubscriberStatistics> subscribers;
+        std::vector<EventTypeStatistics> eventTypes;
+    };
+
+}}
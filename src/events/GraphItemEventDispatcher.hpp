@@ -27,6 +27,7 @@
 #pragma once
 #include <envire_core/events/GraphEventSubscriber.hpp>
 #include <envire_core/events/GraphEventPublisher.hpp>
+#include <envire_core/events/GraphEventBatch.hpp>
 #include <envire_core/events/ItemAddedEvent.hpp>
 #include <envire_core/events/ItemRemovedEvent.hpp>
 #include <typeindex>
@@ -79,6 +80,15 @@ namespace envire { namespace core
                     }
                 }
                     break;
+                case GraphEvent::EVENT_BATCH:
+                {
+                    const GraphEventBatch& batch = dynamic_cast<const GraphEventBatch&>(event);
+                    batch.visitEvents([this](const GraphEvent& e)
+                    {
+                        notifyGraphEvent(e);
+                    });
+                }
+                    break;
                 default:
                   //don't care about anything else
                   break;
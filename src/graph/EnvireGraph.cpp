@@ -26,12 +26,28 @@
 
 
 #include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/items/ItemDataSize.hpp>
 #include <fstream>
+#include <limits>
+#include <cstdlib>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 
 namespace envire { namespace core {
 
+namespace
+{
+    /**Sets a flag for the lifetime of the guard, also if an exception is thrown */
+    class FlagGuard
+    {
+    public:
+        explicit FlagGuard(bool& flag) : flag(flag) { flag = true; }
+        ~FlagGuard() { flag = false; }
+    private:
+        bool& flag;
+    };
+}
+
 EnvireGraph::EnvireGraph()
     : TransformGraph<Frame>()
 {}
@@ -51,6 +67,22 @@ EnvireGraph::EnvireGraph(const EnvireGraph &other) : TransformGraph<Frame>()
     boost::copy_graph(other, graph());
     //copy the labels
     regenerateLabelMap();
+    rebuildItemIndex();
+    copyTimeIndices(other);
+}
+
+EnvireGraph& EnvireGraph::operator=(const EnvireGraph &other)
+{
+    if(this != &other)
+    {
+        //the indices have to be up to date before the new state is published
+        unpublishCurrentStateToAll();
+        copyGraph(other);
+        rebuildItemIndex();
+        copyTimeIndices(other);
+        publishCurrentStateToAll();
+    }
+    return *this;
 }
 
 
@@ -107,38 +139,90 @@ EnvireGraph::EnvireGraph(const EnvireGraph &other, std::unordered_set<std::type_
             }
         }
     }
+    rebuildItemIndex();
+    copyTimeIndices(other);
 }
 
 
-void EnvireGraph::addItem(ItemBase::Ptr item)
+void EnvireGraph::addItem(const ItemBase::Ptr& item)
 {
     addItemToFrame(item->getFrame(), item);
 }
 
-void EnvireGraph::addItemToFrame(const FrameId& frame, ItemBase::Ptr item)
+void EnvireGraph::addItemToFrame(const FrameId& frame, const ItemBase::Ptr& item)
 {
-    checkFrameValid(frame);
-    const std::type_index i(item->getTypeIndex());
-    (*this)[frame].items[i].push_back(item);
+    const vertex_descriptor vertex = getVertex(frame); //may throw UnknownFrameException
+    addItemToVertex(vertex, frame, item);
+}
+
+void EnvireGraph::addItemToVertex(const vertex_descriptor vertex, const FrameId& frame,
+                                  const ItemBase::Ptr& item)
+{
+    const ItemTypeId typeId = item->getTypeId();
+    Frame::ItemList& items = graph()[vertex].items.getOrCreate(item->getTypeIndex(), typeId);
+    items.push_back(item);
+    indexItem(item, vertex, typeId, items.size() - 1);
     item->setFrame(frame);
-    notify(ItemAddedEvent(frame, item));
+    if(hasActiveSubscribers())
+        notify(ItemAddedEvent(frame, item));
+    retainItems(vertex, typeId);
+}
+
+std::shared_future<void> EnvireGraph::waitForFrame(const FrameId& frame)
+{
+    if(!waiter)
+    {
+        waiter.reset(new GraphWaiter(*this));
+    }
+    return waiter->waitForFrame(frame);
+}
+
+std::shared_future<Transform> EnvireGraph::waitForTransform(const FrameId& origin, const FrameId& target)
+{
+    if(!waiter)
+    {
+        waiter.reset(new GraphWaiter(*this));
+    }
+    return waiter->waitForTransform(origin, target);
+}
+
+void EnvireGraph::cancelWaitForFrame(const FrameId& frame)
+{
+    if(waiter)
+    {
+        waiter->cancel(frame);
+    }
+}
+
+void EnvireGraph::cancelWaitForTransform(const FrameId& origin, const FrameId& target)
+{
+    if(waiter)
+    {
+        waiter->cancel(origin, target);
+    }
 }
 
 void EnvireGraph::clearFrame(const FrameId& frame)
 {
-    checkFrameValid(frame);
-    auto& items = (*this)[frame].items;
+    const vertex_descriptor vertex = getVertex(frame); //may throw UnknownFrameException
+    auto& items = graph()[vertex].items;
 
-    for(Frame::ItemMap::iterator it = items.begin(); it != items.end();)
+    //the most recently added type is removed first
+    while(!items.empty())
     {
-        Frame::ItemList& list = it->second;
-        for(auto it = list.begin(); it != list.end();)
+        Frame::ItemList list;
+        list.swap(items.back().second);
+        const ItemTypeId typeId = items.back().typeId;
+        items.pop_back();
+        for(std::size_t slot = 0; slot < list.size(); ++slot)
+        {
+            unindexItem(list[slot], vertex, typeId, slot);
+        }
+        for(const ItemBase::Ptr& removedItem : list)
         {
-            ItemBase::Ptr removedItem = *it;
-            it = list.erase(it);
-            notify(ItemRemovedEvent(frame, removedItem));
+            if(hasActiveSubscribers())
+                notify(ItemRemovedEvent(frame, removedItem));
         }
-        it = items.erase(it);
     }
 }
 
@@ -191,12 +275,12 @@ const Frame::ItemList& EnvireGraph::getItems(const vertex_descriptor frame,
                                              const std::type_index& type) const
 {
     const Frame::ItemMap& items = graph()[frame].items;
-
-    if(items.find(type) == items.end())
+    const Frame::ItemMap::const_iterator mapEntry = items.find(type);
+    if(mapEntry == items.end())
     {
         throw NoItemsOfTypeInFrameException(getFrameId(frame), demangleTypeName(type));
     }
-    return items.at(type);
+    return mapEntry->second;
 }
 
 const Frame::ItemList& EnvireGraph::getItems(const FrameId& frame,
@@ -210,7 +294,13 @@ void EnvireGraph::removeFrame(const FrameId& frame)
 {
     //explicitly remove all items from the frame to cause ItemRemovedEvents
     clearFrame(frame);
+    const vertex_descriptor vertex = getVertex(frame);
     Base::removeFrame(frame);
+    //the vertex descriptor may be reused by a new frame
+    timeIndices.erase(timeIndices.lower_bound(TimeIndexKey(vertex, 0)),
+                      timeIndices.upper_bound(TimeIndexKey(vertex, std::numeric_limits<ItemTypeId>::max())));
+    retentionPolicies.erase(retentionPolicies.lower_bound(TimeIndexKey(vertex, 0)),
+                            retentionPolicies.upper_bound(TimeIndexKey(vertex, std::numeric_limits<ItemTypeId>::max())));
 }
 
 void EnvireGraph::clear()
@@ -245,29 +335,546 @@ void EnvireGraph::removeItemFromFrame(const ItemBase::Ptr item)
 {
     const FrameId frameId = item->getFrame();
     const vertex_descriptor vertex = getVertex(frameId); //may throw UnknownFrameException
-    //the const_cast is fine because we are inside the EnvireGraph and know what
-    //we are doing. The method returns const because the user should not be
-    //able to manipulate the ItemLists directly.
-    Frame::ItemList& items = const_cast<Frame::ItemList&>(getItems(vertex, item->getTypeIndex()));
+    Frame::ItemMap& items = graph()[vertex].items;
+    Frame::ItemMap::iterator mapEntry = items.find(item->getTypeId());
+    if(mapEntry == items.end())
+    {
+        throw NoItemsOfTypeInFrameException(frameId, demangleTypeName(item->getTypeIndex()));
+    }
+    const Frame::ItemList& list = mapEntry->second;
 
-    Frame::ItemList::iterator itemIt = std::find(items.begin(), items.end(), item);
-    if(itemIt == items.end())
+    //use the index if it knows the item, otherwise fall back to a linear search
+    std::size_t slot = list.size();
+    ItemIndex::const_iterator location = itemIndex.find(item.get());
+    if(location != itemIndex.end() && location->second.vertex == vertex &&
+       location->second.slot < list.size() && list[location->second.slot] == item)
+    {
+        slot = location->second.slot;
+    }
+    else
+    {
+        slot = std::find(list.begin(), list.end(), item) - list.begin();
+    }
+    if(slot == list.size())
     {
         throw UnknownItemException(frameId, item->getID());
     }
-    items.erase(itemIt);
 
+    removeItemAt(vertex, mapEntry, slot);
+    item->setFrame("");
+
+    if(hasActiveSubscribers())
+        notify(ItemRemovedEvent(frameId, item));
+}
+
+ItemBase::Ptr EnvireGraph::getItemById(const boost::uuids::uuid& id) const
+{
+    const ItemLocation* loc = findItemLocation(id);
+    if(loc == nullptr)
+    {
+        throw UnknownItemIdException(id);
+    }
+    return graph()[loc->vertex].items.find(loc->typeId)->second[loc->slot];
+}
+
+bool EnvireGraph::containsItem(const boost::uuids::uuid& id) const
+{
+    return findItemLocation(id) != nullptr;
+}
+
+void EnvireGraph::removeItemById(const boost::uuids::uuid& id)
+{
+    const ItemLocation* location = findItemLocation(id);
+    if(location == nullptr)
+    {
+        throw UnknownItemIdException(id);
+    }
+    const ItemLocation loc = *location;
+    Frame::ItemMap& items = graph()[loc.vertex].items;
+    ItemBase::Ptr item = removeItemAt(loc.vertex, items.find(loc.typeId), loc.slot);
+    const FrameId frameId = item->getFrame();
     item->setFrame("");
 
-    // if there is no more elements in item list
-    // than delete the whole entry of the item type from item map
-    if (items.size() == 0)
+    if(hasActiveSubscribers())
+        notify(ItemRemovedEvent(frameId, item));
+}
+
+ItemBase::Ptr EnvireGraph::removeItemAt(const vertex_descriptor vertex,
+                                        Frame::ItemMap::iterator entry,
+                                        const std::size_t slot)
+{
+    Frame::ItemList& list = entry->second;
+    assert(slot < list.size());
+    ItemBase::Ptr item = list[slot];
+    unindexItem(item, vertex, entry->typeId, slot);
+
+    //swap-remove: the last item takes the place of the removed one
+    const std::size_t last = list.size() - 1;
+    if(slot != last)
     {
-        Frame& frame = (*this)[frameId];
-        frame.items.erase(item->getTypeIndex());
+        list[slot] = std::move(list[last]);
+        ItemIndex::iterator moved = itemIndex.find(list[slot].get());
+        if(moved != itemIndex.end() && moved->second.vertex == vertex &&
+           moved->second.typeId == entry->typeId && moved->second.slot == last)
+        {
+            moved->second.slot = slot;
+        }
     }
+    list.pop_back();
 
-    notify(ItemRemovedEvent(frameId, item));
+    //if everything is implemented correctly empty lists can never exist in the map
+    if(list.empty())
+    {
+        graph()[vertex].items.erase(entry);
+    }
+    return item;
+}
+
+void EnvireGraph::indexItem(const ItemBase::Ptr& item, const vertex_descriptor vertex,
+                            const ItemTypeId typeId, const std::size_t slot)
+{
+    if(typeId >= itemsByType.size())
+    {
+        itemsByType.resize(typeId + 1);
+    }
+    Frame::ItemList& typeList = itemsByType[typeId];
+    typeList.push_back(item);
+    itemIndex[item.get()] = ItemLocation{vertex, typeId, slot, typeList.size() - 1};
+    if(itemIdIndexBuilt.load(std::memory_order_relaxed))
+    {
+        itemIdIndex[item->getID()] = item.get();
+    }
+
+    if(!timeIndices.empty())
+    {
+        auto timeIndex = timeIndices.find(TimeIndexKey(vertex, typeId));
+        if(timeIndex != timeIndices.end())
+        {
+            //hint: items usually arrive in time order
+            timeIndex->second.emplace_hint(timeIndex->second.end(), item->getTime(), item);
+        }
+    }
+    if(!retentionPolicies.empty())
+    {
+        auto retention = retentionPolicies.find(TimeIndexKey(vertex, typeId));
+        if(retention != retentionPolicies.end())
+        {
+            const std::size_t bytes = item->getDataSize();
+            retention->second.itemBytes[item.get()] = bytes;
+            retention->second.bytes += bytes;
+        }
+    }
+}
+
+void EnvireGraph::unindexItem(const ItemBase::Ptr& item, const vertex_descriptor vertex,
+                              const ItemTypeId typeId, const std::size_t slot)
+{
+    assert(typeId < itemsByType.size());
+    Frame::ItemList& typeList = itemsByType[typeId];
+    std::size_t typeSlot = typeList.size();
+    ItemIndex::iterator location = itemIndex.find(item.get());
+    if(location != itemIndex.end() && location->second.vertex == vertex &&
+       location->second.typeId == typeId && location->second.slot == slot)
+    {
+        typeSlot = location->second.typeSlot;
+        itemIndex.erase(location);
+        if(itemIdIndexBuilt.load(std::memory_order_relaxed))
+        {
+            ItemIdIndex::iterator id = itemIdIndex.find(item->getID());
+            if(id != itemIdIndex.end() && id->second == item.get())
+            {
+                itemIdIndex.erase(id);
+            }
+        }
+    }
+    //an item that has been added several times is only indexed at its latest location
+    if(typeSlot >= typeList.size() || typeList[typeSlot] != item)
+    {
+        typeSlot = std::find(typeList.begin(), typeList.end(), item) - typeList.begin();
+    }
+    assert(typeSlot < typeList.size());
+
+    //swap-remove, same as for the frame lists
+    const std::size_t last = typeList.size() - 1;
+    if(typeSlot != last)
+    {
+        typeList[typeSlot] = std::move(typeList[last]);
+        ItemIndex::iterator moved = itemIndex.find(typeList[typeSlot].get());
+        if(moved != itemIndex.end() && moved->second.typeId == typeId &&
+           moved->second.typeSlot == last)
+        {
+            moved->second.typeSlot = typeSlot;
+        }
+    }
+    typeList.pop_back();
+
+    if(!timeIndices.empty())
+    {
+        auto timeIndex = timeIndices.find(TimeIndexKey(vertex, typeId));
+        if(timeIndex != timeIndices.end())
+        {
+            TimeIndex& index = timeIndex->second;
+            auto range = index.equal_range(item->getTime());
+            auto entry = std::find_if(range.first, range.second,
+                                      [&item](const TimeIndex::value_type& e) { return e.second == item; });
+            if(entry == range.second)
+            {
+                //the time has been changed while the item was part of the graph
+                entry = std::find_if(index.begin(), index.end(),
+                                     [&item](const TimeIndex::value_type& e) { return e.second == item; });
+            }
+            assert(entry != index.end());
+            index.erase(entry);
+        }
+    }
+    if(!retentionPolicies.empty())
+    {
+        auto retention = retentionPolicies.find(TimeIndexKey(vertex, typeId));
+        if(retention != retentionPolicies.end())
+        {
+            RetentionState& state = retention->second;
+            auto recorded = state.itemBytes.find(item.get());
+            if(recorded != state.itemBytes.end())
+            {
+                state.bytes -= std::min(state.bytes, recorded->second);
+                state.itemBytes.erase(recorded);
+            }
+        }
+    }
+}
+
+void EnvireGraph::rebuildItemIndex()
+{
+    itemIndex.clear();
+    itemIdIndex.clear();
+    itemIdIndexBuilt.store(false, std::memory_order_relaxed);
+    itemsByType.clear();
+    timeIndices.clear();
+    retentionPolicies.clear();
+    vertex_iterator vertex_it, vertex_end;
+    std::tie(vertex_it, vertex_end) = getVertices();
+    for(; vertex_it != vertex_end; ++vertex_it)
+    {
+        const Frame::ItemMap& items = graph()[*vertex_it].items;
+        for(const Frame::ItemMap::value_type& entry : items)
+        {
+            for(std::size_t slot = 0; slot < entry.second.size(); ++slot)
+            {
+                indexItem(entry.second[slot], *vertex_it, entry.typeId, slot);
+            }
+        }
+    }
+}
+
+const EnvireGraph::ItemLocation* EnvireGraph::findItemLocation(const boost::uuids::uuid& id) const
+{
+    ensureItemIdIndex();
+    ItemIdIndex::const_iterator item = itemIdIndex.find(id);
+    if(item == itemIdIndex.end())
+    {
+        return nullptr;
+    }
+    //the uuid of the item might have been changed while it was part of the graph
+    ItemIndex::const_iterator location = itemIndex.find(item->second);
+    return location != itemIndex.end() ? &location->second : nullptr;
+}
+
+void EnvireGraph::ensureItemIdIndex() const
+{
+    if(itemIdIndexBuilt.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    //const lookups of several threads might build the index at the same time
+    std::lock_guard<std::mutex> lock(itemIdIndexMutex);
+    if(itemIdIndexBuilt.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    itemIdIndex.reserve(itemIndex.size());
+    for(const ItemIndex::value_type& entry : itemIndex)
+    {
+        itemIdIndex[entry.first->getID()] = entry.first;
+    }
+    itemIdIndexBuilt.store(true, std::memory_order_release);
+}
+
+void EnvireGraph::enableTimeIndex(const vertex_descriptor vertex, const ItemTypeId typeId)
+{
+    std::pair<std::map<TimeIndexKey, TimeIndex>::iterator, bool> inserted =
+        timeIndices.emplace(TimeIndexKey(vertex, typeId), TimeIndex());
+    if(!inserted.second)
+    {
+        return; //already enabled
+    }
+    const Frame::ItemMap& items = graph()[vertex].items;
+    Frame::ItemMap::const_iterator entry = items.find(typeId);
+    if(entry != items.end())
+    {
+        for(const ItemBase::Ptr& item : entry->second)
+        {
+            inserted.first->second.emplace(item->getTime(), item);
+        }
+    }
+}
+
+const EnvireGraph::TimeIndex* EnvireGraph::findTimeIndex(const vertex_descriptor vertex, const ItemTypeId typeId) const
+{
+    if(timeIndices.empty())
+    {
+        return nullptr;
+    }
+    auto timeIndex = timeIndices.find(TimeIndexKey(vertex, typeId));
+    return timeIndex != timeIndices.end() ? &timeIndex->second : nullptr;
+}
+
+std::vector<ItemBase::Ptr> EnvireGraph::getItemsInRange(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                                        const base::Time& start, const base::Time& end) const
+{
+    std::vector<ItemBase::Ptr> result;
+    const TimeIndex* index = findTimeIndex(vertex, typeId);
+    if(index)
+    {
+        TimeIndex::const_iterator it = index->lower_bound(start);
+        const TimeIndex::const_iterator last = index->upper_bound(end);
+        for(; it != last; ++it)
+        {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    const Frame::ItemMap& items = graph()[vertex].items;
+    Frame::ItemMap::const_iterator entry = items.find(typeId);
+    if(entry == items.end())
+    {
+        return result;
+    }
+    for(const ItemBase::Ptr& item : entry->second)
+    {
+        if(item->getTime() >= start && item->getTime() <= end)
+        {
+            result.push_back(item);
+        }
+    }
+    std::stable_sort(result.begin(), result.end(), [](const ItemBase::Ptr& a, const ItemBase::Ptr& b)
+    {
+        return a->getTime() < b->getTime();
+    });
+    return result;
+}
+
+ItemBase::Ptr EnvireGraph::getNearestItem(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                          const base::Time& time) const
+{
+    const TimeIndex* index = findTimeIndex(vertex, typeId);
+    if(index)
+    {
+        if(index->empty())
+        {
+            return ItemBase::Ptr();
+        }
+        TimeIndex::const_iterator after = index->lower_bound(time);
+        if(after == index->end())
+        {
+            return std::prev(after)->second;
+        }
+        if(after == index->begin())
+        {
+            return after->second;
+        }
+        TimeIndex::const_iterator before = std::prev(after);
+        return (time - before->first) <= (after->first - time) ? before->second : after->second;
+    }
+
+    const Frame::ItemMap& items = graph()[vertex].items;
+    Frame::ItemMap::const_iterator entry = items.find(typeId);
+    if(entry == items.end())
+    {
+        return ItemBase::Ptr();
+    }
+    ItemBase::Ptr nearest;
+    int64_t nearestDistance = std::numeric_limits<int64_t>::max();
+    for(const ItemBase::Ptr& item : entry->second)
+    {
+        const int64_t distance = std::abs((item->getTime() - time).toMicroseconds());
+        if(distance < nearestDistance)
+        {
+            nearest = item;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
+
+void EnvireGraph::copyTimeIndices(const EnvireGraph& other)
+{
+    for(const std::map<TimeIndexKey, TimeIndex>::value_type& timeIndex : other.timeIndices)
+    {
+        enableTimeIndex(getVertex(other.getFrameId(timeIndex.first.first)), timeIndex.first.second);
+    }
+    for(const std::map<TimeIndexKey, RetentionState>::value_type& retention : other.retentionPolicies)
+    {
+        const TimeIndexKey key(getVertex(other.getFrameId(retention.first.first)), retention.first.second);
+        //the items of this graph might be clones, thus the sizes are recorded again
+        RetentionState& state = retentionPolicies[key];
+        state.policy = retention.second.policy;
+        state.insertions = 0;
+        recordDataSizes(key.first, key.second, state);
+    }
+}
+
+void EnvireGraph::setRetentionPolicy(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                     const RetentionPolicy& policy)
+{
+    enableTimeIndex(vertex, typeId);
+    RetentionState& state = retentionPolicies[TimeIndexKey(vertex, typeId)];
+    state.policy = policy;
+    state.insertions = 0;
+    recordDataSizes(vertex, typeId, state);
+    FlagGuard enforcing(enforcingRetention);
+    enforceRetentionPolicy(vertex, typeId, policy);
+}
+
+std::size_t EnvireGraph::enforceRetentionPolicies()
+{
+    //subscribers may change the policies while items are removed
+    std::vector<std::pair<TimeIndexKey, RetentionPolicy>> policies;
+    for(std::map<TimeIndexKey, RetentionState>::value_type& retention : retentionPolicies)
+    {
+        retention.second.insertions = 0;
+        //the size of items may change while they are in the graph
+        recordDataSizes(retention.first.first, retention.first.second, retention.second);
+        policies.emplace_back(retention.first, retention.second.policy);
+    }
+    std::size_t removed = 0;
+    FlagGuard enforcing(enforcingRetention);
+    //the removals of all policies are delivered as a single batch
+    Transaction transaction(*this);
+    for(const std::pair<TimeIndexKey, RetentionPolicy>& policy : policies)
+    {
+        removed += enforceRetentionPolicy(policy.first.first, policy.first.second, policy.second);
+    }
+    return removed;
+}
+
+void EnvireGraph::retainItems(const vertex_descriptor vertex, const ItemTypeId typeId)
+{
+    if(retentionPolicies.empty() || enforcingRetention)
+    {
+        return;
+    }
+    auto retention = retentionPolicies.find(TimeIndexKey(vertex, typeId));
+    if(retention == retentionPolicies.end())
+    {
+        return;
+    }
+    RetentionState& state = retention->second;
+    if(++state.insertions < std::max<std::size_t>(1, state.policy.checkInterval))
+    {
+        return;
+    }
+    state.insertions = 0;
+    const RetentionPolicy policy = state.policy;
+    FlagGuard enforcing(enforcingRetention);
+    enforceRetentionPolicy(vertex, typeId, policy);
+}
+
+void EnvireGraph::recordDataSizes(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                  RetentionState& state) const
+{
+    const Frame::ItemMap& items = graph()[vertex].items;
+    Frame::ItemMap::const_iterator entry = items.find(typeId);
+    std::unordered_map<const ItemBase*, std::size_t> itemBytes;
+    std::size_t bytes = 0;
+    if(entry != items.end())
+    {
+        itemBytes.reserve(entry->second.size());
+        for(const ItemBase::Ptr& item : entry->second)
+        {
+            std::size_t size = 0;
+            if(item->isDataResident())
+            {
+                size = item->getDataSize();
+            }
+            else
+            {
+                auto recorded = state.itemBytes.find(item.get());
+                if(recorded != state.itemBytes.end())
+                    size = recorded->second;
+            }
+            itemBytes[item.get()] = size;
+            bytes += size;
+        }
+    }
+    state.itemBytes.swap(itemBytes);
+    state.bytes = bytes;
+}
+
+std::size_t EnvireGraph::enforceRetentionPolicy(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                                const RetentionPolicy& policy)
+{
+    auto retention = retentionPolicies.find(TimeIndexKey(vertex, typeId));
+    const Frame::ItemMap& items = graph()[vertex].items;
+    Frame::ItemMap::const_iterator entry = items.find(typeId);
+    if(retention == retentionPolicies.end() || entry == items.end())
+    {
+        return 0; //the policy has been removed by a subscriber meanwhile
+    }
+    std::size_t count = entry->second.size();
+    std::size_t bytes = retention->second.bytes;
+
+    //the time index is only missing if it has been disabled after the policy was set
+    enableTimeIndex(vertex, typeId);
+    const TimeIndex& index = *findTimeIndex(vertex, typeId);
+    if(index.empty())
+    {
+        return 0;
+    }
+    const base::Time oldestRetained = index.rbegin()->first - policy.maxAge;
+
+    //visit the items oldest first until the policy is met
+    std::vector<ItemBase::Ptr> evicted;
+    for(TimeIndex::const_iterator it = index.begin(); it != index.end(); ++it)
+    {
+        const ItemBase::Ptr& item = it->second;
+        if((policy.maxCount == 0 || count <= policy.maxCount) &&
+           (policy.maxBytes == 0 || bytes <= policy.maxBytes) &&
+           (policy.maxAge.isNull() || item->getTime() >= oldestRetained))
+        {
+            break;
+        }
+        evicted.push_back(item);
+        --count;
+        auto recorded = retention->second.itemBytes.find(item.get());
+        if(recorded != retention->second.itemBytes.end())
+            bytes -= std::min(bytes, recorded->second);
+    }
+
+    if(evicted.empty())
+    {
+        return 0;
+    }
+    //subscribers receive a single batch instead of one event per item
+    Transaction transaction(*this);
+    //removing invalidates the list and the time index
+    for(const ItemBase::Ptr& item : evicted)
+    {
+        removeItemFromFrame(item);
+    }
+    return evicted.size();
+}
+
+const Frame::ItemList& EnvireGraph::getAllItems(const std::type_index& type) const
+{
+    static const Frame::ItemList empty;
+    const ItemTypeId typeId = getItemTypeId(type);
+    return typeId < itemsByType.size() ? itemsByType[typeId] : empty;
+}
+
+size_t EnvireGraph::getAllItemCount(const std::type_index& type) const
+{
+    return getAllItems(type).size();
 }
 
 void EnvireGraph::publishCurrentState(GraphEventSubscriber* pSubscriber)
@@ -331,6 +938,36 @@ void EnvireGraph::loadFromFile(const std::string& file)
     myfile.close();
 }
 
+void EnvireGraph::loadFromFile(const std::string& file, const GraphLoadOptions& options)
+{
+    GraphLoadOptions::Scope scope(options);
+    loadFromFile(file);
+}
+
+void EnvireGraph::removeUnselectedFrames(const GraphLoadOptions& options)
+{
+    //the frames are part of the archive, only their items have been skipped
+    std::vector<vertex_descriptor> unselected;
+    vertex_iterator it, end;
+    for(std::tie(it, end) = getVertices(); it != end; ++it)
+    {
+        if(!options.isFrameSelected(getFrameId(*it)))
+            unselected.push_back(*it);
+    }
+    if(unselected.empty())
+    {
+        return;
+    }
+    //the loaded graph has not been published yet, thus it is modified directly
+    for(const vertex_descriptor vertex : unselected)
+    {
+        boost::clear_vertex(vertex, graph());
+        boost::remove_vertex(vertex, graph());
+    }
+    _map.clear();
+    regenerateLabelMap();
+}
+
 void EnvireGraph::createStructuralCopy(EnvireGraph& destination) const
 {
     //note: this is not very efficient but until someone complains there is
@@ -364,4 +1001,112 @@ void EnvireGraph::createStructuralCopy(EnvireGraph& destination) const
     }
 }
 
+void EnvireGraph::createIsolatedCopy(EnvireGraph& destination) const
+{
+    createStructuralCopy(destination);
+    vertex_iterator it, end;
+    std::tie(it, end) = getVertices();
+    for(; it != end; ++it)
+    {
+        const Frame& frame = graph()[*it];
+        const vertex_descriptor target = destination.getVertex(frame.getId());
+        for(const Frame::ItemMap::value_type& entry : frame.items)
+        {
+            for(const ItemBase::Ptr& item : entry.second)
+            {
+                destination.addItemToVertex(target, frame.getId(), item->clone());
+            }
+        }
+    }
+}
+
+namespace
+{
+    /**Approximate size of a node of a std::map or std::set */
+    template <class Value>
+    std::size_t treeNodeSize() { return sizeof(Value) + 4 * sizeof(void*); }
+    
+    /**Approximate size of a node of a std::unordered_map or std::unordered_set */
+    template <class Value>
+    std::size_t hashNodeSize() { return sizeof(Value) + 2 * sizeof(void*); }
+    
+    template <class HashContainer>
+    std::size_t hashContainerSize(const HashContainer& container)
+    {
+        return container.size() * hashNodeSize<typename HashContainer::value_type>() +
+               container.bucket_count() * sizeof(void*);
+    }
+    
+    std::size_t stringHeapSize(const std::string& s)
+    {
+        return ItemDataSize<std::string>::get(s) - sizeof(std::string);
+    }
+}
+
+EnvireGraph::MemoryReport EnvireGraph::getMemoryReport() const
+{
+    MemoryReport report;
+    
+    vertex_iterator vertex_it, vertex_end;
+    std::tie(vertex_it, vertex_end) = getVertices();
+    for(; vertex_it != vertex_end; ++vertex_it)
+    {
+        const Frame& frame = graph()[*vertex_it];
+        //vertex node of the list and its in and out edge lists
+        report.vertexBytes += sizeof(frame) + stringHeapSize(frame.id) + 4 * sizeof(void*) + 2 * sizeof(std::vector<void*>);
+        MemoryUsage& frameUsage = report.itemsByFrame[frame.id];
+        for(const Frame::ItemMap::value_type& entry : frame.items)
+        {
+            report.vertexBytes += sizeof(entry) + entry.second.capacity() * sizeof(ItemBase::Ptr);
+            MemoryUsage& typeUsage = report.itemsByType[demangleTypeName(entry.first)];
+            for(const ItemBase::Ptr& item : entry.second)
+            {
+                const std::size_t bytes = item->getMemoryUsage();
+                frameUsage.bytes += bytes;
+                typeUsage.bytes += bytes;
+            }
+            frameUsage.count += entry.second.size();
+            typeUsage.count += entry.second.size();
+        }
+        report.items.count += frameUsage.count;
+        report.items.bytes += frameUsage.bytes;
+    }
+    
+    //edge node plus the entries in the out and in edge lists of its vertices
+    report.edgeBytes = num_edges() * (sizeof(Transform) + 4 * sizeof(void*));
+    
+    report.labelMapBytes = _map.size() * treeNodeSize<map_type::value_type>();
+    for(const map_type::value_type& label : _map)
+    {
+        report.labelMapBytes += stringHeapSize(label.first);
+    }
+    
+    report.indexBytes = hashContainerSize(itemIndex) + hashContainerSize(itemIdIndex) + itemsByType.capacity() * sizeof(Frame::ItemList);
+    for(const Frame::ItemList& list : itemsByType)
+    {
+        report.indexBytes += list.capacity() * sizeof(ItemBase::Ptr);
+    }
+    for(const std::map<TimeIndexKey, TimeIndex>::value_type& timeIndex : timeIndices)
+    {
+        report.indexBytes += treeNodeSize<std::map<TimeIndexKey, TimeIndex>::value_type>() +
+                             timeIndex.second.size() * treeNodeSize<TimeIndex::value_type>();
+    }
+    for(const std::map<TimeIndexKey, RetentionState>::value_type& retention : retentionPolicies)
+    {
+        report.indexBytes += treeNodeSize<std::map<TimeIndexKey, RetentionState>::value_type>() +
+                             hashContainerSize(retention.second.itemBytes);
+    }
+    
+    for(const TreeView* view : subscribedTreeViews)
+    {
+        report.treeViewBytes += sizeof(TreeView) + hashContainerSize(view->tree) +
+                                view->crossEdges.capacity() * sizeof(TreeView::CrossEdge);
+        for(const VertexRelationMap::value_type& relation : view->tree)
+        {
+            report.treeViewBytes += hashContainerSize(relation.second.children);
+        }
+    }
+    return report;
+}
+
 }}
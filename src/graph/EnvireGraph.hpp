@@ -31,16 +31,24 @@
 #include <envire_core/events/ItemAddedEvent.hpp>
 #include <envire_core/events/ItemRemovedEvent.hpp>
 #include <envire_core/util/Demangle.hpp>
+#include <envire_core/graph/GraphWaiter.hpp>
 
 #include <typeindex>
 #include <typeinfo>
 #include <type_traits>
 #include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <atomic>
+#include <mutex>
 
 #define BOOST_RESULT_OF_USE_DECLTYPE //this is important for the transform_iterator
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost_serialization/BoostTypes.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/functional/hash.hpp>
 
 
 namespace envire { namespace core {
@@ -67,6 +75,28 @@ public:
     using ItemIterator = boost::transform_iterator<ItemBaseCaster<T>, std::vector<ItemBase::Ptr>::const_iterator, T&>;
     template <class T>
     using ItemIteratorPair =  std::pair<ItemIterator<T>, ItemIterator<T>>;
+    
+    /**A contiguous, typed view of the items of one type in a frame.
+    * Indexing and iteration do not copy the item pointers.
+    * Is invalidated by adding or removing items of type @p T to the frame. */
+    template <class T>
+    class ItemSpan
+    {
+    public:
+        ItemSpan() : first(), count(0) {}
+        ItemSpan(Frame::ItemList::const_iterator first, const std::size_t count) :
+            first(first), count(count) {}
+        
+        T& operator[](const std::size_t i) const { return ItemBaseCaster<T>()(first[i]); }
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        ItemIterator<T> begin() const { return ItemIterator<T>(first, ItemBaseCaster<T>()); }
+        ItemIterator<T> end() const { return ItemIterator<T>(first + count, ItemBaseCaster<T>()); }
+        
+    private:
+        Frame::ItemList::const_iterator first;
+        std::size_t count;
+    };
 
     EnvireGraph();
 
@@ -81,12 +111,44 @@ public:
 
     EnvireGraph(const EnvireGraph &other);
     
+    /**Replaces the data of this graph by a copy of @p other.
+     * Has the semantics of the copy constructor, see Graph::operator=().
+     * The item and time indices are rebuilt, the event statistics and the
+     * waiters of this graph are kept. */
+    EnvireGraph& operator=(const EnvireGraph &other);
+    
 
     /** Adds @p item to the item list in the frame of item
     *  Causes ItemAddedEvent.
     *  @throw UnknownFrameException if the frame id is invalid
     *  @param item that should be added. The item provides the frame to which it will be added */
-    void addItem(ItemBase::Ptr item);
+    void addItem(const ItemBase::Ptr& item);
+    
+    /** Adds all items in [@p begin, @p end) to the frames stored in the items.
+    *  Causes one ItemAddedEvent per item.
+    *  @throw UnknownFrameException if the frame of an item is invalid. The
+    *         items before that item have been added already. */
+    template <class Iterator>
+    void addItems(Iterator begin, Iterator end);
+    
+    /** Adds all items in [@p begin, @p end) to @p frame.
+    *  The frame is looked up only once.
+    *  Causes one ItemAddedEvent per item.
+    *  @throw UnknownFrameException if the frame id is invalid */
+    template <class Iterator>
+    void addItemsToFrame(const FrameId& frame, Iterator begin, Iterator end);
+    
+    /** Constructs an item of type @p T in place and adds it to @p frame.
+    *  @p args are forwarded to the constructor of @p T, thus a payload that
+    *  is passed as rvalue is moved into the item without copying it.
+    *  The item and its reference count share one allocation.
+    *  Causes ItemAddedEvent.
+    *  @param T should derive from ItemBase, e.g. Item<PointCloud>
+    *  @throw UnknownFrameException if the frame id is invalid. Nothing is
+    *         constructed in that case.
+    *  @return the new item */
+    template <class T, class... Args>
+    ItemBase::PtrType<T> emplaceItem(const FrameId& frame, Args&&... args);
 
     /**Removes @p item from @p frame.
       *  Causes ItemRemovedEvent.
@@ -96,9 +158,12 @@ public:
       *                             item list.
       * @param T should derive from ItemBase.
       * @note Invalidates all iterators of type ItemIterator<T> for the specified @p frame.
+      * @note The last item of the list is moved into the place of @p item,
+      *       i.e. the order of the items is not retained.
       * @return A pair of iterators. The first one points to the element that
-      *         comes after @p item and the second one points to the end of the
-      *         list.*/ 
+      *         took the place of @p item (which has not been visited yet when
+      *         iterating) and the second one points to the end of the
+      *         list. Both are invalid iterators if the list is empty now.*/ 
     template <class T>
     ItemIteratorPair<T>
     removeItemFromFrame(const FrameId& frameId, ItemIterator<T> item);
@@ -108,8 +173,29 @@ public:
      * Sets @p item->frame_name to "" before causing the event.
      * @throw UnknownFrameException if @p item.frame is not part of this graph.
      * @throw UnknownItemException if @p item is not part of @p item.frame
-     * @note Invalidates all iterators of type ItemIterator<item.getTypeIndex()>*/
+     * @note Invalidates all iterators of type ItemIterator<item.getTypeIndex()>
+     * @note The item is located in O(1) using the item index */
     void removeItemFromFrame(const ItemBase::Ptr item);
+    
+    /**@return the item with the uuid @p id. O(1).
+     * The graph keeps an index of the uuids of all items that have been added
+     * using addItem() or addItemToFrame(). Item uuids are expected to be unique.
+     * If several items share a uuid, only one of them is indexed.
+     * The uuid index is built by the first lookup by uuid and is kept up to
+     * date afterwards. Until then the uuids of lazy items
+     * (see ItemBase::setLazyIDs()) are not generated by the graph.
+     * @note Items that are added by manipulating a Frame directly and items
+     *       whose uuid is changed after they have been added are not indexed
+     * @throw UnknownItemIdException if there is no such item */
+    ItemBase::Ptr getItemById(const boost::uuids::uuid& id) const;
+    
+    /**@return true if an item with the uuid @p id is part of the graph */
+    bool containsItem(const boost::uuids::uuid& id) const;
+    
+    /**Removes the item with the uuid @p id from its frame. O(1).
+     * Causes ItemRemovedEvent.
+     * @throw UnknownItemIdException if there is no such item */
+    void removeItemById(const boost::uuids::uuid& id);
           
     /**Removes all items from @p frame.
     * Causes ItemRemovedEvent for each item that is removd.
@@ -133,7 +219,7 @@ public:
     *  @note item.frame_name will be set to @p frame.
     *        This means that it is not possible to use the same item
     *        in multiple Graphs. */
-    void addItemToFrame(const FrameId& frame, ItemBase::Ptr item);
+    void addItemToFrame(const FrameId& frame, const ItemBase::Ptr& item);
 
     /**Returns all items of type @p T that are stored in @p frame.
     * @throw UnknownFrameException if the @p frame id is invalid.
@@ -144,7 +230,127 @@ public:
     const std::pair<ItemIterator<T>, ItemIterator<T>> getItems(const FrameId& frame) const;
     template<class T>
     const std::pair<ItemIterator<T>, ItemIterator<T>> getItems(const vertex_descriptor frame) const;
+    
+    /** @return a span of all items of type @p T in @p frame.
+     *  The span is empty if there are no such items.
+     *  @param T should derive from ItemBase
+     *  @throw UnknownFrameException if the @p frame id is invalid.*/
+    template <class T>
+    ItemSpan<T> getItemSpan(const FrameId& frame) const;
+    template <class T>
+    ItemSpan<T> getItemSpan(const vertex_descriptor frame) const;
+    
+    /** Creates a time index for the items of type @p T in @p frame.
+     *  The index keeps the items sorted by ItemBase::getTime() and is kept
+     *  up to date when items are added or removed, regardless of the order
+     *  of their timestamps. It makes getItemsInRange() and getNearestItem()
+     *  logarithmic. Can be enabled before any item of type @p T exists.
+     *  @note The timestamp of an item must not be changed while it is part
+     *        of an indexed frame.
+     *  @note Time indices are not serialized.
+     *  @throw UnknownFrameException if the @p frame id is invalid.*/
+    template <class T>
+    void enableTimeIndex(const FrameId& frame);
+    /** Removes the time index of the items of type @p T in @p frame.
+     *  If a retention policy is set the index is rebuilt by its next check. */
+    template <class T>
+    void disableTimeIndex(const FrameId& frame);
+    template <class T>
+    bool hasTimeIndex(const FrameId& frame) const;
+    
+    /** @return all items of type @p T in @p frame whose time is within
+     *  [@p start, @p end], sorted by time.
+     *  O(log n + k) if the time index is enabled (see enableTimeIndex()),
+     *  O(n + k log k) otherwise.
+     *  @throw UnknownFrameException if the @p frame id is invalid.*/
+    template <class T>
+    std::vector<ItemBase::PtrType<T>> getItemsInRange(const FrameId& frame, const base::Time& start,
+                                                      const base::Time& end) const;
+    
+    /** @return the item of type @p T in @p frame whose time is closest to @p time.
+     *  O(log n) if the time index is enabled (see enableTimeIndex()), O(n) otherwise.
+     *  @throw UnknownFrameException if the @p frame id is invalid.
+     *  @throw NoItemsOfTypeInFrameException if there are no items of type @p T */
+    template <class T>
+    ItemBase::PtrType<T> getNearestItem(const FrameId& frame, const base::Time& time) const;
 
+    /** Limits for the items of one type in one frame. A limit of zero is unlimited.
+     *  Items are evicted oldest first according to ItemBase::getTime(). */
+    struct RetentionPolicy
+    {
+        /** Maximum number of items */
+        std::size_t maxCount = 0;
+        /** Items that are older than the newest item minus maxAge are evicted.
+         *  The age is relative to the newest item rather than to the wall
+         *  clock, therefore replayed logs behave like live data. */
+        base::Time maxAge;
+        /** Maximum sum of ItemBase::getDataSize(). The size of an item is
+         *  recorded when it is added and refreshed by
+         *  enforceRetentionPolicies() while its data is resident. Thus items
+         *  keep their size while their data is released (see
+         *  ItemSpillStore), and items that are added without resident data
+         *  (e.g. lazy items of a MappedGraphFile) count as 0 bytes until
+         *  the next refresh. */
+        std::size_t maxBytes = 0;
+        /** The limits are checked every checkInterval insertions, i.e. up
+         *  to checkInterval - 1 items may exceed them for a short time. */
+        std::size_t checkInterval = 16;
+    };
+    
+    /** Sets the retention policy of the items of type @p T in @p frame and
+     *  applies it immediately. Items that violate the policy are removed
+     *  using removeItemFromFrame(). Their ItemRemovedEvents are delivered
+     *  as a single GraphEventBatch per check (see Transaction).
+     *  Enables the time index of @p T in @p frame (see enableTimeIndex()).
+     *  @note Retention policies are not serialized.
+     *  @throw UnknownFrameException if the @p frame id is invalid.*/
+    template <class T>
+    void setRetentionPolicy(const FrameId& frame, const RetentionPolicy& policy);
+    /** Removes the retention policy. Keeps the time index. */
+    template <class T>
+    void removeRetentionPolicy(const FrameId& frame);
+    template <class T>
+    bool hasRetentionPolicy(const FrameId& frame) const;
+    
+    /** Applies all retention policies regardless of their checkInterval.
+     *  The removals of all policies are delivered as a single GraphEventBatch.
+     *  @return the number of removed items */
+    std::size_t enforceRetentionPolicies();
+    
+    /** Number and estimated size of a group of items */
+    struct MemoryUsage
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0; /**<Sum of ItemBase::getMemoryUsage() */
+    };
+    
+    /** Estimated memory use of the graph, see getMemoryReport() */
+    struct MemoryReport
+    {
+        MemoryUsage items; /**<All items */
+        std::map<FrameId, MemoryUsage> itemsByFrame;
+        std::map<std::string, MemoryUsage> itemsByType; /**<Key is the demangled item type */
+        
+        std::size_t vertexBytes = 0; /**<Frames including their item lists */
+        std::size_t edgeBytes = 0; /**<Edges including their transforms */
+        std::size_t labelMapBytes = 0; /**<Mapping from FrameId to vertex */
+        std::size_t indexBytes = 0; /**<Uuid, type and time indices of the items */
+        std::size_t treeViewBytes = 0; /**<TreeViews that are kept up to date by the graph */
+        
+        /** @return the memory used by the graph itself, excluding the items */
+        std::size_t getGraphOverhead() const
+        {
+            return vertexBytes + edgeBytes + labelMapBytes + indexBytes + treeViewBytes;
+        }
+        std::size_t getTotal() const { return items.bytes + getGraphOverhead(); }
+    };
+    
+    /** @return an estimate of the memory used by the items, aggregated by
+     *  frame and by type, and of the overhead of the graph structures.
+     *  The item sizes are based on ItemDataSize, node sizes of the standard
+     *  containers are approximated. O(number of items). */
+    MemoryReport getMemoryReport() const;
+    
     /** @return a list of all items of @p type in @p frame
      *  @throw NoItemsOfTypeInFrameException if no items of the type are in the frame*/
     const envire::core::Frame::ItemList& getItems(const vertex_descriptor frame,
@@ -188,6 +394,24 @@ public:
     size_t getItemCount(const FrameId& frame) const;
     template <class T>
     size_t getItemCount(const vertex_descriptor vd) const;        
+    
+    /** @return all items of type @p T in the whole graph. O(1).
+     *  The frame of each item is available via ItemBase::getFrame().
+     *  The graph keeps a per-type registry that is updated whenever an item
+     *  is added or removed, thus iterating the range takes time proportional
+     *  to the number of matching items, not to the size of the graph.
+     *  The order of the items is unspecified.
+     *  @param T should derive from ItemBase
+     *  @note Adding or removing items of type @p T invalidates the iterators */
+    template <class T>
+    const ItemIteratorPair<T> getAllItems() const;
+    /** @return all items of @p type in the whole graph. See getAllItems<T>() */
+    const Frame::ItemList& getAllItems(const std::type_index& type) const;
+    /** @return the number of items of type @p T in the whole graph. O(1)
+      *  @param T should derive from ItemBase */
+    template <class T>
+    size_t getAllItemCount() const;
+    size_t getAllItemCount(const std::type_index& type) const;
 
     /** @return the number of all items independent of their type in @p frame.
       *  @throw UnknownFrameException if the @p frame id is invalid.*/
@@ -228,11 +452,55 @@ public:
      * FIXME I have no idea what happens when the graph already contains data*/
     void loadFromFile(const std::string& file);
     
+    /**Loads the parts of the graph in @p file that are selected by @p options.
+     * Items that are skipped are not decoded (see GraphLoadOptions).
+     * Frames that are not selected and their transforms are read from the
+     * archive, but dropped before the graph is published. Subscribers never
+     * see them, neither as added nor as removed.
+     * @throw boost::archive::archive_exception if the serialization failed
+     * @throw std::ios_base::failure if the file operation failed*/
+    void loadFromFile(const std::string& file, const GraphLoadOptions& options);
+    
     /** Copies all frames and edges from this graph to @p target.
      *  Excludes all items. 
      */
     void createStructuralCopy(EnvireGraph& target) const;
     
+    /** Copies all frames, edges and clones of all items from this graph to
+     *  @p target. In contrast to the copy constructor, which shares the
+     *  items, the items of @p target can be modified without affecting this
+     *  graph. The item data is shared copy-on-write, thus the copy costs
+     *  O(metadata) and an item is only copied when its data is modified.
+     */
+    void createIsolatedCopy(EnvireGraph& target) const;
+    
+    /**@return a future that becomes ready as soon as @p frame exists.
+     * The future is fulfilled by the thread that adds the frame, while the
+     * FrameAddedEvent is published. It is ready immediately if the frame
+     * exists already.
+     * @note If events are disabled (see enableEvents()) the future is not
+     *       fulfilled. If the graph is destroyed before the frame is added,
+     *       the future throws std::future_error (broken_promise). */
+    std::shared_future<void> waitForFrame(const FrameId& frame);
+    
+    /**@return a future that receives the transform from @p origin to @p target
+     * as soon as it can be resolved, i.e. once both frames exist and are
+     * connected. It is woken by FrameAddedEvent and EdgeAddedEvent.
+     * The transform is the one at the time of resolving, later updates are
+     * not reflected.
+     * @note See waitForFrame() */
+    std::shared_future<Transform> waitForTransform(const FrameId& origin, const FrameId& target);
+    
+    /**Gives up a wait started by waitForFrame(), e.g. after it timed out.
+     * Once every caller waiting for @p frame has given up, the wait is removed
+     * and the graph has no waiting subscriber left. The futures of the wait
+     * throw std::future_error (broken_promise) afterwards. */
+    void cancelWaitForFrame(const FrameId& frame);
+    
+    /**Gives up a wait started by waitForTransform().
+     * @note See cancelWaitForFrame() */
+    void cancelWaitForTransform(const FrameId& origin, const FrameId& target);
+    
 protected:
 
     /** @return A range that contains all items of type @p T in frame @p frame
@@ -246,6 +514,86 @@ protected:
     /**Throws UnknownFrameException if @p frame is not part of this graph */
     void checkFrameValid(const FrameId& frame) const;
     
+    /**Adds @p item to @p vertex whose id is @p frame.
+     * Causes ItemAddedEvent */
+    void addItemToVertex(const vertex_descriptor vertex, const FrameId& frame,
+                         const ItemBase::Ptr& item);
+    
+    /**Position of an item inside the graph */
+    struct ItemLocation
+    {
+        vertex_descriptor vertex;
+        ItemTypeId typeId;
+        std::size_t slot; /**<Index inside the ItemList of the type */
+        std::size_t typeSlot; /**<Index inside itemsByType[typeId] */
+    };
+    using ItemIndex = std::unordered_map<const ItemBase*, ItemLocation>;
+    using ItemIdIndex = std::unordered_map<boost::uuids::uuid, const ItemBase*, boost::hash<boost::uuids::uuid>>;
+    
+    /**Removes the item at @p slot of @p entry from @p vertex.
+     * Moves the last item of the list into @p slot, updates the index
+     * and erases @p entry if the list becomes empty.
+     * Does not notify anyone.
+     * @return the removed item */
+    ItemBase::Ptr removeItemAt(const vertex_descriptor vertex, Frame::ItemMap::iterator entry,
+                               const std::size_t slot);
+    
+    /**Adds @p item, which is stored at @p slot, to the item and type index
+     * and to the uuid index if it has been built */
+    void indexItem(const ItemBase::Ptr& item, const vertex_descriptor vertex,
+                   const ItemTypeId typeId, const std::size_t slot);
+    
+    /**Removes @p item from the type index and from the item and uuid index
+     * if it is indexed at the given location */
+    void unindexItem(const ItemBase::Ptr& item, const vertex_descriptor vertex,
+                     const ItemTypeId typeId, const std::size_t slot);
+    
+    /**Re-creates the item and type index from the content of all frames
+     * and drops the uuid index.
+     * Is needed after the frames have been copied or loaded. */
+    void rebuildItemIndex();
+    
+    /**Builds the uuid index if it does not exist yet */
+    void ensureItemIdIndex() const;
+    
+    /**@return the location of the item with the uuid @p id or nullptr */
+    const ItemLocation* findItemLocation(const boost::uuids::uuid& id) const;
+    
+    /**Items of one type in one frame sorted by time */
+    using TimeIndex = std::multimap<base::Time, ItemBase::Ptr>;
+    using TimeIndexKey = std::pair<vertex_descriptor, ItemTypeId>;
+    
+    void enableTimeIndex(const vertex_descriptor vertex, const ItemTypeId typeId);
+    
+    /**@return the time index of @p typeId in @p vertex or nullptr if it is not enabled */
+    const TimeIndex* findTimeIndex(const vertex_descriptor vertex, const ItemTypeId typeId) const;
+    
+    /**@return the items of @p typeId in @p vertex within [start, end] sorted by time */
+    std::vector<ItemBase::Ptr> getItemsInRange(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                               const base::Time& start, const base::Time& end) const;
+    
+    /**@return the item of @p typeId in @p vertex closest to @p time or nullptr
+     *         if there are no such items */
+    ItemBase::Ptr getNearestItem(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                 const base::Time& time) const;
+    
+    /**Enables the time indices of @p other in this graph */
+    void copyTimeIndices(const EnvireGraph& other);
+    
+    void setRetentionPolicy(const vertex_descriptor vertex, const ItemTypeId typeId,
+                            const RetentionPolicy& policy);
+    
+    /**Removes the oldest items of @p typeId in @p vertex until @p policy is met.
+     * Costs O(k log n) for k evicted items, the time index is rebuilt if it
+     * has been disabled.
+     * @return the number of removed items */
+    std::size_t enforceRetentionPolicy(const vertex_descriptor vertex, const ItemTypeId typeId,
+                                       const RetentionPolicy& policy);
+    
+    /**Counts an insertion into the list of @p typeId in @p vertex and
+     * enforces its retention policy every RetentionPolicy::checkInterval insertions */
+    void retainItems(const vertex_descriptor vertex, const ItemTypeId typeId);
+    
     /**Assert that @p T derives from ItemBase */
     template <class T>
     void assertDerivesFromItemBase() const;
@@ -262,12 +610,57 @@ protected:
     virtual void unpublishCurrentState(GraphEventSubscriber* pSubscriber);
     
 private:
+    /**Maps each item to its position */
+    ItemIndex itemIndex;
+    
+    /**Maps the uuids to the items. Is built by the first lookup by uuid,
+     * thus graphs that are never searched by uuid do not generate the
+     * uuids of lazy items. */
+    mutable ItemIdIndex itemIdIndex;
+    mutable std::atomic<bool> itemIdIndexBuilt{false};
+    /**Serializes concurrent const lookups that build the uuid index */
+    mutable std::mutex itemIdIndexMutex;
+    
+    /**All items of the graph grouped by ItemTypeId */
+    std::vector<Frame::ItemList> itemsByType;
+    
+    /**Time indices that have been enabled using enableTimeIndex() */
+    std::map<TimeIndexKey, TimeIndex> timeIndices;
+    
+    struct RetentionState
+    {
+        RetentionPolicy policy;
+        std::size_t insertions = 0; /**<Since the policy has been checked last */
+        /**Sum of itemBytes, is updated by indexItem() and unindexItem() */
+        std::size_t bytes = 0;
+        /**Recorded ItemBase::getDataSize() of each item. Released data reports
+         * 0 bytes, thus removals subtract the recorded size instead */
+        std::unordered_map<const ItemBase*, std::size_t> itemBytes;
+    };
+    /**Retention policies that have been set using setRetentionPolicy() */
+    std::map<TimeIndexKey, RetentionState> retentionPolicies;
+    /**True while items are evicted, prevents recursive enforcement */
+    bool enforcingRetention = false;
+    
+    /**Records ItemBase::getDataSize() of the resident items of @p typeId in
+     * @p vertex in @p state. Items whose data has been released keep their
+     * recorded size. */
+    void recordDataSizes(const vertex_descriptor vertex, const ItemTypeId typeId,
+                         RetentionState& state) const;
+    
+    /**Serves waitForFrame() and waitForTransform(). Is created on first use */
+    std::unique_ptr<GraphWaiter> waiter;
+    
     /**Grants access to boost serialization */
     friend class boost::serialization::access;
     
     /**boost serialization method*/
     template <typename Archive>
     void serialize(Archive &ar, const unsigned int version);
+    
+    /**Drops the frames that are not selected by @p options and their edges
+     * from the freshly loaded graph without notifying the subscribers */
+    void removeUnselectedFrames(const GraphLoadOptions& options);
                                                             
 };
 
@@ -310,6 +703,25 @@ EnvireGraph::getItems(const vertex_descriptor frame) const
     return getItemsInternal<T>(frame, getFrameId(frame));
 }  
 
+template <class T>
+EnvireGraph::ItemSpan<T> EnvireGraph::getItemSpan(const FrameId& frame) const
+{
+    return getItemSpan<T>(getVertex(frame)); //may throw
+}
+
+template <class T>
+EnvireGraph::ItemSpan<T> EnvireGraph::getItemSpan(const vertex_descriptor frame) const
+{
+    assertDerivesFromItemBase<T>();
+    const Frame::ItemMap& items = graph()[frame].items;
+    const Frame::ItemMap::const_iterator mapEntry = items.find(getItemTypeId<T>());
+    if(mapEntry == items.end())
+    {
+        return ItemSpan<T>();
+    }
+    return ItemSpan<T>(mapEntry->second.cbegin(), mapEntry->second.size());
+}
+
 template<class T>
 const EnvireGraph::ItemIteratorPair<T>
 EnvireGraph::getItemsInternal(const vertex_descriptor frame, const FrameId& frameId) const
@@ -317,16 +729,16 @@ EnvireGraph::getItemsInternal(const vertex_descriptor frame, const FrameId& fram
     assertDerivesFromItemBase<T>();
     
     const Frame::ItemMap& items = graph()[frame].items;
-    const std::type_index key(typeid(T));
+    const Frame::ItemMap::const_iterator mapEntry = items.find(getItemTypeId<T>());
     
-    if(items.find(key) == items.end())
+    if(mapEntry == items.end())
     {
         ItemIterator<T> invalid;
         return std::make_pair(invalid, invalid);
     }
     
-    auto begin = items.at(key).begin();
-    auto end = items.at(key).end();
+    auto begin = mapEntry->second.begin();
+    auto end = mapEntry->second.end();
     assert(begin != end); //if a list exists it should not be empty
     
     ItemIterator<T> beginIt(begin, ItemBaseCaster<T>()); 
@@ -353,12 +765,12 @@ const EnvireGraph::ItemIterator<T> EnvireGraph::getItem(const vertex_descriptor
        throw std::out_of_range("Out of range: " + boost::lexical_cast<std::string>(i)); 
     }
     const Frame::ItemMap& items = graph()[frame].items;
-    const std::type_index key(typeid(T));
-    if(items.find(key) == items.end())
+    const Frame::ItemMap::const_iterator mapEntry = items.find(getItemTypeId<T>());
+    if(mapEntry == items.end())
     {
-        throw NoItemsOfTypeInFrameException(getFrameId(frame), demangleTypeName(key));
+        throw NoItemsOfTypeInFrameException(getFrameId(frame), demangleTypeName(std::type_index(typeid(T))));
     }
-    const Frame::ItemList& list = items.at(key);
+    const Frame::ItemList& list = mapEntry->second;
     assert(list.size() > 0); //if everything is implemented correctly empty lists can never exist in the map
     if((size_t)i >= list.size()) //i is always >= 0 thus cast to size_t is always safe
     {
@@ -376,36 +788,30 @@ EnvireGraph::removeItemFromFrame(const FrameId& frameId, ItemIterator<T> item)
     assert(frameId.compare(item->getFrame()) == 0);
     
     Frame& frame = (*this)[frameId];
-    const std::type_index key(typeid(T));
-    auto mapEntry = frame.items.find(key);
+    auto mapEntry = frame.items.find(getItemTypeId<T>());
     if(mapEntry == frame.items.end())
     {
-        throw NoItemsOfTypeInFrameException(frameId, demangleTypeName(key));
+        throw NoItemsOfTypeInFrameException(frameId, demangleTypeName(std::type_index(typeid(T))));
     }
-    std::vector<ItemBase::Ptr>& items = mapEntry->second;
-    std::vector<ItemBase::Ptr>::const_iterator baseIterator = item.base();
-    //HACK This is a workaround for gcc bug 57158.
-    //     In C++11 the parameter type of vector::erase changed from iterator
-    //     to const_iterator (which is exactly what we need), but  gcc has not
-    //     yet implemented that change. 
-    std::vector<ItemBase::Ptr>::iterator nonConstBaseIterator = items.begin() + (baseIterator - items.cbegin()); //vector iterator const cast hack
-    ItemBase::Ptr deletedItem = *nonConstBaseIterator;//backup item so we can notify the user
-    std::vector<ItemBase::Ptr>::const_iterator next = items.erase(nonConstBaseIterator);
+    const std::size_t slot = item.base() - mapEntry->second.cbegin();
+    const vertex_descriptor vertex = getVertex(frameId);
+    ItemBase::Ptr deletedItem = removeItemAt(vertex, mapEntry, slot);
     deletedItem->setFrame("");
-    notify(ItemRemovedEvent(frameId, deletedItem));
-    
-    ItemIterator<T> nextIt(next, ItemBaseCaster<T>()); 
-    ItemIterator<T> endIt(items.cend(), ItemBaseCaster<T>()); 
     
-    //remove the map entry if there are no more values in the vector
-    if(nextIt == endIt)
+    ItemIterator<T> nextIt;
+    ItemIterator<T> endIt;
+    auto remaining = frame.items.find(getItemTypeId<T>());
+    if(remaining != frame.items.end())
     {
-      //erase invalidates the iterators that we are about to return, but
-      //that doesnt matter because it only happens when they both point
-      //to end() anyway.
-      frame.items.erase(key);
+        const Frame::ItemList& items = remaining->second;
+        nextIt = ItemIterator<T>(items.cbegin() + slot, ItemBaseCaster<T>());
+        endIt = ItemIterator<T>(items.cend(), ItemBaseCaster<T>());
     }
     
+    //notify last, event handlers might modify the item map
+    if(hasActiveSubscribers())
+        notify(ItemRemovedEvent(frameId, deletedItem));
+    
     return std::make_pair(nextIt, endIt);
 }
     
@@ -425,6 +831,123 @@ bool EnvireGraph::containsItems(const vertex_descriptor vertex) const
     return containsItems(vertex, type);
 }
 
+template <class Iterator>
+void EnvireGraph::addItems(Iterator begin, Iterator end)
+{
+    for(; begin != end; ++begin)
+    {
+        addItem(*begin);
+    }
+}
+
+template <class Iterator>
+void EnvireGraph::addItemsToFrame(const FrameId& frame, Iterator begin, Iterator end)
+{
+    const vertex_descriptor vertex = getVertex(frame); //may throw UnknownFrameException
+    for(; begin != end; ++begin)
+    {
+        addItemToVertex(vertex, frame, *begin);
+    }
+}
+
+template <class T, class... Args>
+ItemBase::PtrType<T> EnvireGraph::emplaceItem(const FrameId& frame, Args&&... args)
+{
+    assertDerivesFromItemBase<T>();
+    const vertex_descriptor vertex = getVertex(frame); //may throw UnknownFrameException
+    ItemBase::PtrType<T> item = boost::make_shared<T>(std::forward<Args>(args)...);
+    addItemToVertex(vertex, frame, item);
+    return item;
+}
+
+template <class T>
+void EnvireGraph::enableTimeIndex(const FrameId& frame)
+{
+    assertDerivesFromItemBase<T>();
+    enableTimeIndex(getVertex(frame), getItemTypeId<T>());
+}
+
+template <class T>
+void EnvireGraph::disableTimeIndex(const FrameId& frame)
+{
+    assertDerivesFromItemBase<T>();
+    timeIndices.erase(TimeIndexKey(getVertex(frame), getItemTypeId<T>()));
+}
+
+template <class T>
+bool EnvireGraph::hasTimeIndex(const FrameId& frame) const
+{
+    assertDerivesFromItemBase<T>();
+    return findTimeIndex(getVertex(frame), getItemTypeId<T>()) != nullptr;
+}
+
+template <class T>
+void EnvireGraph::setRetentionPolicy(const FrameId& frame, const RetentionPolicy& policy)
+{
+    assertDerivesFromItemBase<T>();
+    setRetentionPolicy(getVertex(frame), getItemTypeId<T>(), policy);
+}
+
+template <class T>
+void EnvireGraph::removeRetentionPolicy(const FrameId& frame)
+{
+    assertDerivesFromItemBase<T>();
+    retentionPolicies.erase(TimeIndexKey(getVertex(frame), getItemTypeId<T>()));
+}
+
+template <class T>
+bool EnvireGraph::hasRetentionPolicy(const FrameId& frame) const
+{
+    assertDerivesFromItemBase<T>();
+    return retentionPolicies.count(TimeIndexKey(getVertex(frame), getItemTypeId<T>())) > 0;
+}
+
+template <class T>
+std::vector<ItemBase::PtrType<T>> EnvireGraph::getItemsInRange(const FrameId& frame, const base::Time& start,
+                                                               const base::Time& end) const
+{
+    assertDerivesFromItemBase<T>();
+    const std::vector<ItemBase::Ptr> items = getItemsInRange(getVertex(frame), getItemTypeId<T>(), start, end);
+    std::vector<ItemBase::PtrType<T>> result;
+    result.reserve(items.size());
+    for(const ItemBase::Ptr& item : items)
+    {
+        result.push_back(boost::static_pointer_cast<T>(item));
+    }
+    return result;
+}
+
+template <class T>
+ItemBase::PtrType<T> EnvireGraph::getNearestItem(const FrameId& frame, const base::Time& time) const
+{
+    assertDerivesFromItemBase<T>();
+    ItemBase::Ptr item = getNearestItem(getVertex(frame), getItemTypeId<T>(), time);
+    if(!item)
+    {
+        throw NoItemsOfTypeInFrameException(frame, demangleTypeName(std::type_index(typeid(T))));
+    }
+    return boost::static_pointer_cast<T>(item);
+}
+
+template <class T>
+const EnvireGraph::ItemIteratorPair<T> EnvireGraph::getAllItems() const
+{
+    assertDerivesFromItemBase<T>();
+    static const Frame::ItemList empty;
+    const ItemTypeId typeId = getItemTypeId<T>();
+    const Frame::ItemList& items = typeId < itemsByType.size() ? itemsByType[typeId] : empty;
+    return std::make_pair(ItemIterator<T>(items.cbegin(), ItemBaseCaster<T>()),
+                          ItemIterator<T>(items.cend(), ItemBaseCaster<T>()));
+}
+
+template <class T>
+size_t EnvireGraph::getAllItemCount() const
+{
+    assertDerivesFromItemBase<T>();
+    const ItemTypeId typeId = getItemTypeId<T>();
+    return typeId < itemsByType.size() ? itemsByType[typeId].size() : 0;
+}
+
 template <class T>
 size_t EnvireGraph::getItemCount(const FrameId& frameId) const
 {
@@ -438,8 +961,7 @@ size_t EnvireGraph::getItemCount(const vertex_descriptor vd) const
 {
     assertDerivesFromItemBase<T>();
     const Frame& frame = graph()[vd];
-    const std::type_index key(typeid(T));
-    auto mapEntry = frame.items.find(key);
+    auto mapEntry = frame.items.find(getItemTypeId<T>());
     if(mapEntry == frame.items.end())
     {
         return 0;
@@ -454,6 +976,15 @@ template <typename Archive>
 void EnvireGraph::serialize(Archive &ar, const unsigned int version)
 {
     ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(Base);
+    if(Archive::is_loading::value)
+    {
+        const GraphLoadOptions* options = GraphLoadOptions::getCurrent();
+        if(options && options->frameFilter)
+        {
+            removeUnselectedFrames(*options);
+        }
+        rebuildItemIndex();
+    }
 }
 
 }}
@@ -27,6 +27,9 @@
 #pragma once
 
 #include <type_traits>
+#include <exception>
+#include <set>
+#include <unordered_map>
 
 #include <envire_core/events/GraphEventPublisher.hpp>
 #include <envire_core/events/FrameEvents.hpp>
@@ -35,6 +38,7 @@
 #include <boost/graph/filtered_graph.hpp>
 #include <boost/graph/copy.hpp>
 #include <boost/concept_check.hpp>
+#include <glog/logging.h>
 
 #include <envire_core/graph/GraphTypes.hpp>
 #include <envire_core/graph/TreeView.hpp>
@@ -84,6 +88,18 @@ public:
      *       Only the graph data is copied*/
     explicit Graph(const Graph& other);
     
+    /**Replaces the data of this graph by a ***deep*** copy of @p other.
+     * Has the semantics of the copy constructor, the event subscribers and
+     * TreeViews of this graph are kept and the ones of @p other are not copied.
+     * The subscribers are notified about the removal of the old state and the
+     * addition of the new state (see unpublishCurrentState()).
+     * Subscribed TreeViews and subtree scopes are rebuilt from their roots
+     * if the root frame exists in @p other, otherwise they are cleared.
+     * @note Must not be called while a transaction is active. */
+    Graph& operator=(const Graph& other);
+    
+    virtual ~Graph();
+    
     /**Adds an unconnected frame to the graph.
     *  The frame property is default constructed and the id is set to @p frame.
     * 
@@ -256,6 +272,20 @@ public:
       *       subscribing*/
     virtual void subscribeTreeView(TreeView* view);
     
+    /**Restricts the events that @p subscriber receives to the frames in the
+     * subtree of @p view below @p subtreeRoot (including @p subtreeRoot).
+     * The scope follows the view: frames that are added to or removed from
+     * the subtree are added to or removed from the scope.
+     * @p view should be an updating TreeView of this graph
+     * (see getTree(root, true, view)).
+     * @note Frames are added to the scope when they are connected to the
+     *       subtree. Thus the FrameAddedEvent of a new frame is not received.
+     * The scope is removed by clearSubscriptionScope(), by setting a different
+     * scope or when the subscriber unsubscribes.
+     * @throw UnknownFrameException if @p subtreeRoot does not exist */
+    void setSubtreeSubscriptionScope(GraphEventSubscriber* subscriber,
+                                     TreeView& view, const FrameId& subtreeRoot);
+    
     /**Returns all frames on the shortest path from @p origin to @p target.
      * Returns an empty vector if no path exists.
      * @throw UnknownFrameException if @p origin or @p target don't exist */
@@ -308,6 +338,101 @@ public:
     template <class VISITOR>
     void visitVertices(VISITOR visitor);
     
+    /**Starts a transaction.
+     * While a transaction is active, no events are delivered and subscribed
+     * TreeViews are not updated. Instead all events are collected and merged
+     * into a single GraphEventBatch that is delivered when the transaction
+     * is committed.
+     * Transactions can be nested. Only the commit of the outermost transaction
+     * takes effect.
+     * @note There is no rollback. All modifications are applied to the graph
+     *       immediately, only the notifications are deferred. */
+    void beginTransaction();
+    
+    /**Commits the current transaction.
+     * If this is the outermost transaction, all subscribed TreeViews are
+     * rebuilt (if the structure of the graph changed) and the GraphEventBatch
+     * containing the net changes is delivered to all subscribers.
+     * @throw NoActiveTransactionException if no transaction is active */
+    void commitTransaction();
+    
+    /** @return true if a transaction is active */
+    bool isInTransaction() const;
+    
+    /**RAII helper that begins a transaction on construction and commits it
+     * on destruction.
+     * Example:
+     * @code
+     *    {
+     *        EnvireGraph::Transaction transaction(graph);
+     *        graph.removeTransform("a", "b");
+     *        graph.addTransform("c", "b", tf);
+     *    } //subscribers are notified here
+     * @endcode
+     *
+     * If the scope is left by an exception, the transaction is committed as
+     * well. There is no rollback, the modifications that have been applied
+     * before the exception are in the graph and the subscribers are notified
+     * about them to keep them consistent with the graph. Exceptions thrown by
+     * event handlers during this commit are logged and dropped, otherwise
+     * they would terminate the program.
+     * On a regular scope exit exceptions of event handlers are propagated
+     * like in commit(). */
+    class Transaction
+    {
+    public:
+        explicit Transaction(Graph& graph) :
+            graph(&graph), uncaughtExceptions(std::uncaught_exceptions())
+        {
+            graph.beginTransaction();
+        }
+        
+        ~Transaction() noexcept(false)
+        {
+            if(graph == nullptr)
+            {
+                return;
+            }
+            if(std::uncaught_exceptions() <= uncaughtExceptions)
+            {
+                commit();
+                return;
+            }
+            //the stack is unwound, throwing would call std::terminate
+            try
+            {
+                commit();
+            }
+            catch(const std::exception& e)
+            {
+                LOG(ERROR) << "Event handler failed while committing a transaction during stack unwinding: " << e.what();
+            }
+            catch(...)
+            {
+                LOG(ERROR) << "Event handler failed while committing a transaction during stack unwinding";
+            }
+        }
+        
+        /**Commits the transaction before the end of the scope */
+        void commit()
+        {
+            if(graph != nullptr)
+            {
+                Graph* g = graph;
+                graph = nullptr;
+                g->commitTransaction();
+            }
+        }
+        
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+        
+    private:
+        Graph* graph;
+        /**std::uncaught_exceptions() when the transaction has been started */
+        int uncaughtExceptions;
+    };
+    
     
 protected:
     using map_type = typename GraphBase<FRAME_PROP, EDGE_PROP>::map_type;
@@ -330,8 +455,49 @@ protected:
     
     void removeEdgeFromTreeViews(vertex_descriptor origin, vertex_descriptor target) const;
     
-    /**Rebuild all subscribed TreeViews */
-    void rebuildTreeViews() const;
+    /**Rebuilds all subscribed TreeViews after a transaction.
+     * The new trees are compared to the snapshots taken by
+     * markTreeViewsOutdated() and only the net changes are emitted:
+     * edgeRemoved for tree edges that no longer exist (deepest first),
+     * edgeAdded for new tree edges (parents first) and crossEdgeAdded for
+     * new cross edges.
+     * @note The signals are emitted after the view has reached its final
+     *       state. The vertex_descriptors of removed edges are the ones the
+     *       view used, their frames might have been removed from the graph. */
+    void rebuildTreeViews();
+    
+    /**The edges of a TreeView identified by frame ids. Unlike vertex
+     * descriptors the ids stay valid if frames are removed and re-added. */
+    struct TreeViewSnapshot
+    {
+        struct TreeEdge
+        {
+            FrameId parent;
+            FrameId child;
+            vertex_descriptor parentVertex;
+            vertex_descriptor childVertex;
+            std::size_t depth;
+        };
+        FrameId root;
+        /**In dfs order, i.e. parents before children */
+        std::vector<TreeEdge> edges;
+        std::set<std::pair<FrameId, FrameId>> crossEdges;
+    };
+    TreeViewSnapshot snapshotTreeView(const TreeView& view) const;
+    
+    /**Takes snapshots of all subscribed TreeViews before the first structural
+     * change of a transaction. Is called before the graph is modified. */
+    void markTreeViewsOutdated();
+    
+    /**Re-calculates the subtree scopes from their TreeViews.
+     * Is needed after the views have been rebuilt */
+    void refreshSubtreeScopes();
+    
+    /**@return the ids of all frames in the subtree of @p view below @p root */
+    std::unordered_set<FrameId> getSubtreeFrames(const TreeView& view,
+                                                 const vertex_descriptor root) const;
+    
+    virtual void subscriptionScopeCleared(GraphEventSubscriber* subscriber);
     
     /**Removes the specified edge.*/
     void remove_edge(const FrameId& origin, const FrameId& target, 
@@ -353,10 +519,36 @@ protected:
      * This method is used when de-serializing or copying the graph.*/
     void regenerateLabelMap();
     
+    /**Replaces the structure and the properties of this graph by a deep
+     * copy of @p other without notifying the subscribers.
+     * The subscribed TreeViews and subtree scopes are rebuilt. */
+    void copyGraph(const Graph& other);
+    
     
     /**TreeViews that need to be updated when the graph is modified */
     std::vector<TreeView*> subscribedTreeViews;
     
+    /**A subscription scope that follows a subtree of a TreeView */
+    struct SubtreeScope
+    {
+        const TreeView* view;
+        vertex_descriptor root;
+        boost::signals2::connection edgeAddedConnection;
+        boost::signals2::connection edgeRemovedConnection;
+    };
+    std::unordered_map<GraphEventSubscriber*, SubtreeScope> subtreeScopes;
+    
+    /**Nesting depth of the active transactions. 0 if no transaction is active */
+    unsigned transactionDepth = 0;
+    /**Is true if the structure of the graph has been modified during the
+     * current transaction and the TreeViews need to be rebuilt on commit */
+    bool treeViewsOutdated = false;
+    /**The state of the subscribed TreeViews before the transaction modified them */
+    std::unordered_map<const TreeView*, TreeViewSnapshot> treeViewSnapshots;
+    /**Is true while rebuildTreeViews() emits the net changes. The subtree
+     * scopes are refreshed afterwards and ignore these signals. */
+    bool rebuildingTreeViews = false;
+    
 private:
     /**Grants access to boost serialization */
     friend class boost::serialization::access;
@@ -417,6 +609,72 @@ Graph<F,E>::Graph(const Graph<F, E>& other) : Base()
   regenerateLabelMap();
 }
 
+template <class F, class E>
+Graph<F,E>& Graph<F,E>::operator=(const Graph<F, E>& other)
+{
+    if(this != &other)
+    {
+        unpublishCurrentStateToAll();
+        copyGraph(other);
+        publishCurrentStateToAll();
+    }
+    return *this;
+}
+
+template <class F, class E>
+void Graph<F,E>::copyGraph(const Graph<F, E>& other)
+{
+    //the views and scopes store vertex descriptors, they are restored by id
+    for(const TreeView* view : subscribedTreeViews)
+    {
+        if(treeViewSnapshots.find(view) == treeViewSnapshots.end())
+            treeViewSnapshots[view] = snapshotTreeView(*view);
+    }
+    std::unordered_map<vertex_descriptor, FrameId> ids;
+    vertex_iterator it, end;
+    for(boost::tie(it, end) = getVertices(); it != end; ++it)
+    {
+        ids[*it] = getFrameId(*it);
+    }
+    std::vector<FrameId> scopeRoots;
+    for(const auto& entry : subtreeScopes)
+    {
+        auto id = ids.find(entry.second.root);
+        scopeRoots.push_back(id != ids.end() ? id->second : FrameId());
+    }
+    
+    graph().clear();
+    _map.clear();
+    boost::copy_graph(other, graph());
+    regenerateLabelMap();
+    
+    //only the differences between the old and the new trees are emitted
+    rebuildTreeViews();
+    treeViewsOutdated = false;
+    auto findRoot = [this](const FrameId& id)
+    {
+        return !id.empty() && containsFrame(id) ? getVertex(id) : null_vertex();
+    };
+    std::size_t scope = 0;
+    for(auto& entry : subtreeScopes)
+    {
+        entry.second.root = findRoot(scopeRoots[scope++]);
+    }
+    refreshSubtreeScopes();
+}
+
+template <class F, class E>
+Graph<F,E>::~Graph()
+{
+    //the views might outlive the graph
+    for(auto& entry : subtreeScopes)
+    {
+        entry.second.edgeAddedConnection.disconnect();
+        entry.second.edgeRemovedConnection.disconnect();
+    }
+    subtreeScopes.clear();
+}
+
 template <class F, class E>
 typename Graph<F,E>::vertex_descriptor Graph<F,E>::addFrame(const FrameId& frame)
 {
@@ -439,7 +697,8 @@ typename Graph<F,E>::vertex_descriptor Graph<F,E>::add_vertex(const FrameId& fra
                                                               const F& frame)
 {
     vertex_descriptor v = GraphBase<F, E>::add_vertex(frameId, frame);
-    notify(FrameAddedEvent(frameId));
+    if(hasActiveSubscribers())
+        notify(FrameAddedEvent(frameId));
     return v;
 }
 
@@ -520,7 +779,8 @@ void Graph<F,E>::removeFrame(const FrameId& frame)
     {
         _map.erase(it);
     }
-    notify(envire::core::FrameRemovedEvent(frame));
+    if(hasActiveSubscribers())
+        notify(envire::core::FrameRemovedEvent(frame));
 }
 
 template <class F, class E>
@@ -576,6 +836,7 @@ void Graph<F,E>::unsubscribeTreeView(TreeView* view)
     subscribedTreeViews.erase(std::remove(subscribedTreeViews.begin(),
                                           subscribedTreeViews.end(), view),
                               subscribedTreeViews.end());
+    treeViewSnapshots.erase(view);
 }
 
 template <class F, class E>
@@ -584,6 +845,87 @@ void Graph<F,E>::subscribeTreeView(TreeView* view)
     assert(view != nullptr);
     subscribedTreeViews.push_back(view);
     view->setPublisher(this); //now the TreeView will automatically unsubscribe on destruction
+    if(treeViewsOutdated)
+    {
+        //the view has been created from the modified graph
+        treeViewSnapshots[view] = snapshotTreeView(*view);
+    }
+}
+
+template <class F, class E>
+void Graph<F,E>::setSubtreeSubscriptionScope(GraphEventSubscriber* subscriber,
+                                             TreeView& view, const FrameId& subtreeRoot)
+{
+    const vertex_descriptor root = getVertex(subtreeRoot); //will throw
+    //removes a previous subtree scope of the subscriber
+    setSubscriptionScope(subscriber, getSubtreeFrames(view, root));
+    
+    SubtreeScope& scope = subtreeScopes[subscriber];
+    scope.view = &view;
+    scope.root = root;
+    scope.edgeAddedConnection = view.edgeAdded.connect(
+        [this, subscriber](vertex_descriptor origin, vertex_descriptor target)
+        {
+            //refreshSubtreeScopes() recalculates the scope after a rebuild
+            if(rebuildingTreeViews)
+                return;
+            //the root might be re-attached after it has been removed from the view
+            //and it might have changed when the graph has been assigned
+            const vertex_descriptor root = subtreeScopes.at(subscriber).root;
+            if(target == root || isInSubscriptionScope(subscriber, getFrameId(origin)))
+            {
+                addToSubscriptionScope(subscriber, getFrameId(target));
+            }
+        });
+    scope.edgeRemovedConnection = view.edgeRemoved.connect(
+        [this, subscriber](vertex_descriptor origin, vertex_descriptor target)
+        {
+            if(rebuildingTreeViews)
+                return;
+            removeFromSubscriptionScope(subscriber, getFrameId(target));
+        });
+}
+
+template <class F, class E>
+void Graph<F,E>::refreshSubtreeScopes()
+{
+    for(auto& entry : subtreeScopes)
+    {
+        //views that have been destroyed unsubscribed themselves
+        const bool viewAlive = std::find(subscribedTreeViews.begin(), subscribedTreeViews.end(),
+                                         entry.second.view) != subscribedTreeViews.end();
+        if(viewAlive)
+        {
+            replaceSubscriptionScope(entry.first, getSubtreeFrames(*entry.second.view, entry.second.root));
+        }
+    }
+}
+
+template <class F, class E>
+std::unordered_set<FrameId> Graph<F,E>::getSubtreeFrames(const TreeView& view,
+                                                         const vertex_descriptor root) const
+{
+    std::unordered_set<FrameId> frames;
+    if(view.vertexExists(root))
+    {
+        view.visitDfs(root, [&](const vertex_descriptor node, const vertex_descriptor parent)
+        {
+            frames.insert(getFrameId(node));
+        });
+    }
+    return frames;
+}
+
+template <class F, class E>
+void Graph<F,E>::subscriptionScopeCleared(GraphEventSubscriber* subscriber)
+{
+    auto it = subtreeScopes.find(subscriber);
+    if(it != subtreeScopes.end())
+    {
+        it->second.edgeAddedConnection.disconnect();
+        it->second.edgeRemovedConnection.disconnect();
+        subtreeScopes.erase(it);
+    }
 }
 
 template <class F, class E>
@@ -639,6 +981,8 @@ void Graph<F,E>::add_edge(const vertex_descriptor origin,
     {
         throw EdgeAlreadyExistsException(getFrameId(origin), getFrameId(target));
     }
+    if(isInTransaction())
+        markTreeViewsOutdated();
   
     EdgePair edge_pair =  boost::add_edge(origin, target, edgeProperty, *this);
     #if DEBUG
@@ -652,8 +996,10 @@ void Graph<F,E>::add_edge(const vertex_descriptor origin,
     //      does not care about the edge direction.
     //      In fact: if we add both, both will end up in the cross edges list
     //      which might lead to infinite recursion when updating edges
-    addEdgeToTreeViews(edge_pair.first);
-    notify(envire::core::EdgeAddedEvent(getFrameId(origin), getFrameId(target), edge_pair.first));
+    if(!isInTransaction())
+        addEdgeToTreeViews(edge_pair.first);
+    if(hasActiveSubscribers())
+        notify(envire::core::EdgeAddedEvent(getFrameId(origin), getFrameId(target), edge_pair.first));
 }
 
 template <class F, class E>
@@ -694,13 +1040,17 @@ void Graph<F,E>::remove_edge(const FrameId& origin, const FrameId& target,
     {
         throw UnknownEdgeException(origin, target);
     }
+    if(isInTransaction())
+        markTreeViewsOutdated();
     
     boost::remove_edge(originToTarget.first, *this);
-    notify(envire::core::EdgeRemovedEvent(origin, target));
+    if(hasActiveSubscribers())
+        notify(envire::core::EdgeRemovedEvent(origin, target));
     
     boost::remove_edge(targetToOrigin.first, *this);
     
-    removeEdgeFromTreeViews(originDesc, targetDesc);
+    if(!isInTransaction())
+        removeEdgeFromTreeViews(originDesc, targetDesc);
     
 }
 
@@ -828,13 +1178,146 @@ void Graph<F,E>::addEdgeToTreeView(edge_descriptor newEdge, TreeView* view) cons
 }
 
 template <class F, class E>
-void Graph<F,E>::rebuildTreeViews() const
+typename Graph<F,E>::TreeViewSnapshot Graph<F,E>::snapshotTreeView(const TreeView& view) const
 {
-    for(TreeView* view : subscribedTreeViews)
+    TreeViewSnapshot snapshot;
+    if(view.root == null_vertex() || !view.vertexExists(view.root))
+        return snapshot;
+    snapshot.root = getFrameId(view.root);
+    std::unordered_map<vertex_descriptor, std::size_t> depths;
+    view.visitDfs(view.root, [&](const vertex_descriptor node, const vertex_descriptor parent)
+    {
+        if(parent == null_vertex())
+        {
+            depths[node] = 0;
+            return;
+        }
+        depths[node] = depths[parent] + 1;
+        snapshot.edges.push_back({getFrameId(parent), getFrameId(node), parent, node, depths[node]});
+    });
+    for(const TreeView::CrossEdge& edge : view.crossEdges)
     {
-        view->clear();
-        getTree(view->root, view);
+        snapshot.crossEdges.emplace(getFrameId(edge.origin), getFrameId(edge.target));
     }
+    return snapshot;
+}
+
+template <class F, class E>
+void Graph<F,E>::markTreeViewsOutdated()
+{
+    if(treeViewsOutdated)
+        return;
+    treeViewsOutdated = true;
+    for(const TreeView* view : subscribedTreeViews)
+    {
+        treeViewSnapshots[view] = snapshotTreeView(*view);
+    }
+}
+
+template <class F, class E>
+void Graph<F,E>::rebuildTreeViews()
+{
+    rebuildingTreeViews = true;
+    try
+    {
+        for(TreeView* view : subscribedTreeViews)
+        {
+            auto snapshot = treeViewSnapshots.find(view);
+            if(snapshot == treeViewSnapshots.end())
+                continue; //not modified
+            const TreeViewSnapshot& old = snapshot->second;
+            
+            TreeView fresh;
+            if(!old.root.empty() && containsFrame(old.root))
+            {
+                getTree(getVertex(old.root), &fresh);
+            }
+            const TreeViewSnapshot current = snapshotTreeView(fresh);
+            view->tree = std::move(fresh.tree);
+            view->crossEdges = std::move(fresh.crossEdges);
+            view->root = fresh.root;
+            
+            std::set<std::pair<FrameId, FrameId>> oldEdges;
+            for(const typename TreeViewSnapshot::TreeEdge& edge : old.edges)
+                oldEdges.emplace(edge.parent, edge.child);
+            std::set<std::pair<FrameId, FrameId>> newEdges;
+            for(const typename TreeViewSnapshot::TreeEdge& edge : current.edges)
+                newEdges.emplace(edge.parent, edge.child);
+            
+            //removed edges are emitted bottom up, like TreeView::removeEdge() does
+            std::vector<const typename TreeViewSnapshot::TreeEdge*> removed;
+            for(const typename TreeViewSnapshot::TreeEdge& edge : old.edges)
+            {
+                if(newEdges.find(std::make_pair(edge.parent, edge.child)) == newEdges.end())
+                    removed.push_back(&edge);
+            }
+            std::stable_sort(removed.begin(), removed.end(),
+                [](const typename TreeViewSnapshot::TreeEdge* a, const typename TreeViewSnapshot::TreeEdge* b)
+                {
+                    return a->depth > b->depth;
+                });
+            for(const typename TreeViewSnapshot::TreeEdge* edge : removed)
+            {
+                view->edgeRemoved(edge->parentVertex, edge->childVertex);
+            }
+            for(const typename TreeViewSnapshot::TreeEdge& edge : current.edges)
+            {
+                if(oldEdges.find(std::make_pair(edge.parent, edge.child)) == oldEdges.end())
+                    view->edgeAdded(edge.parentVertex, edge.childVertex);
+            }
+            for(const TreeView::CrossEdge& edge : view->crossEdges)
+            {
+                if(old.crossEdges.find(std::make_pair(getFrameId(edge.origin), getFrameId(edge.target))) == old.crossEdges.end())
+                    view->crossEdgeAdded(edge);
+            }
+        }
+    }
+    catch(...)
+    {
+        rebuildingTreeViews = false;
+        treeViewSnapshots.clear();
+        throw;
+    }
+    rebuildingTreeViews = false;
+    treeViewSnapshots.clear();
+}
+
+template <class F, class E>
+void Graph<F,E>::beginTransaction()
+{
+    if(transactionDepth == 0)
+    {
+        treeViewsOutdated = false;
+        beginEventBatch();
+    }
+    ++transactionDepth;
+}
+
+template <class F, class E>
+void Graph<F,E>::commitTransaction()
+{
+    if(transactionDepth == 0)
+    {
+        throw NoActiveTransactionException();
+    }
+    --transactionDepth;
+    if(transactionDepth == 0)
+    {
+        //update the views first to ensure that subscribers see a consistent state
+        if(treeViewsOutdated)
+        {
+            treeViewsOutdated = false;
+            rebuildTreeViews();
+            refreshSubtreeScopes();
+        }
+        endEventBatch();
+    }
+}
+
+template <class F, class E>
+bool Graph<F,E>::isInTransaction() const
+{
+    return transactionDepth > 0;
 }
 
 template <class F, class E>
@@ -897,7 +1380,8 @@ void Graph<F,E>::setEdgeProperty(const vertex_descriptor origin,
     assert(targetToOrigin.second); //there should always be an inverse edge
     (*this)[targetToOrigin.first] = prop.inverse();
     
-    notify(EdgeModifiedEvent(getFrameId(origin), getFrameId(target), originToTarget.first, targetToOrigin.first));
+    if(hasActiveSubscribers())
+        notify(EdgeModifiedEvent(getFrameId(origin), getFrameId(target), originToTarget.first, targetToOrigin.first));
 }
 
 template <class F, class E>
@@ -110,6 +110,16 @@ namespace envire { namespace core
         const std::string msg;
     };
 
+    class UnknownItemIdException : public std::exception
+    {
+    public:
+        explicit UnknownItemIdException(const boost::uuids::uuid& uuid) :
+          msg("There is no item with uuid '" + boost::uuids::to_string(uuid) +
+              "' in the graph") {}
+        virtual char const * what() const throw() { return msg.c_str(); }
+        const std::string msg;
+    };
+
     class FrameStillConnectedException : public std::exception
     {
     public:
@@ -139,6 +149,33 @@ namespace envire { namespace core
         const std::string msg;
     };
     
+    class NoActiveTransactionException : public std::exception
+    {
+    public:
+        explicit NoActiveTransactionException() :
+          msg("There is no active transaction that could be committed.") {}
+        virtual char const * what() const throw() { return msg.c_str(); }
+        const std::string msg;
+    };
+    
+    class ItemRestoreException : public std::exception
+    {
+    public:
+        explicit ItemRestoreException(const std::string& path) :
+          msg("Failed to restore the data of an item from '" + path + "'") {}
+        virtual char const * what() const throw() { return msg.c_str(); }
+        const std::string msg;
+    };
+    
+    class InvalidGraphFileException : public std::exception
+    {
+    public:
+        explicit InvalidGraphFileException(const std::string& path, const std::string& reason) :
+          msg("Invalid graph file '" + path + "': " + reason) {}
+        virtual char const * what() const throw() { return msg.c_str(); }
+        const std::string msg;
+    };
+    
     
 }}
 
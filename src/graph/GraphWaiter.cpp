@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <envire_core/graph/GraphWaiter.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+
+namespace envire { namespace core
+{
+
+GraphWaiter::GraphWaiter(EnvireGraph& graph) : GraphEventSubscriber(),
+    graph(graph), subscribed(false)
+{
+}
+
+std::shared_future<void> GraphWaiter::waitForFrame(const FrameId& frame)
+{
+    auto it = frameWaits.find(frame);
+    if(it != frameWaits.end())
+    {
+        ++it->second.waiters;
+        return it->second.future;
+    }
+
+    Wait<void> wait;
+    wait.future = wait.promise.get_future().share();
+    std::shared_future<void> future = wait.future;
+    if(graph.containsFrame(frame))
+    {
+        wait.promise.set_value();
+    }
+    else
+    {
+        frameWaits.emplace(frame, std::move(wait));
+        updateSubscription();
+    }
+    return future;
+}
+
+std::shared_future<Transform> GraphWaiter::waitForTransform(const FrameId& origin, const FrameId& target)
+{
+    const std::pair<FrameId, FrameId> key(origin, target);
+    auto it = transformWaits.find(key);
+    if(it != transformWaits.end())
+    {
+        ++it->second.waiters;
+        return it->second.future;
+    }
+
+    Wait<Transform> wait;
+    wait.future = wait.promise.get_future().share();
+    std::shared_future<Transform> future = wait.future;
+    Transform tf;
+    if(tryGetTransform(origin, target, tf))
+    {
+        wait.promise.set_value(tf);
+    }
+    else
+    {
+        transformWaits.emplace(key, std::move(wait));
+        updateSubscription();
+    }
+    return future;
+}
+
+void GraphWaiter::cancel(const FrameId& frame)
+{
+    cancel(frameWaits, frameWaits.find(frame));
+}
+
+void GraphWaiter::cancel(const FrameId& origin, const FrameId& target)
+{
+    cancel(transformWaits, transformWaits.find(std::make_pair(origin, target)));
+}
+
+template <class Waits>
+void GraphWaiter::cancel(Waits& waits, typename Waits::iterator it)
+{
+    if(it == waits.end())
+    {
+        return; //fulfilled already
+    }
+    if(--it->second.waiters == 0)
+    {
+        waits.erase(it);
+        updateSubscription();
+    }
+}
+
+std::size_t GraphWaiter::getNumberOfPendingWaits() const
+{
+    return frameWaits.size() + transformWaits.size();
+}
+
+void GraphWaiter::notifyGraphEvent(const GraphEvent& event)
+{
+    switch(event.getType())
+    {
+        case GraphEvent::FRAME_ADDED:
+        case GraphEvent::EDGE_ADDED:
+        case GraphEvent::EVENT_BATCH:
+            checkWaits();
+            break;
+        default:
+            break;
+    }
+}
+
+void GraphWaiter::checkWaits()
+{
+    for(auto it = frameWaits.begin(); it != frameWaits.end();)
+    {
+        if(graph.containsFrame(it->first))
+        {
+            it->second.promise.set_value();
+            it = frameWaits.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for(auto it = transformWaits.begin(); it != transformWaits.end();)
+    {
+        Transform tf;
+        if(tryGetTransform(it->first.first, it->first.second, tf))
+        {
+            it->second.promise.set_value(tf);
+            it = transformWaits.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    updateSubscription();
+}
+
+bool GraphWaiter::tryGetTransform(const FrameId& origin, const FrameId& target, Transform& tf) const
+{
+    if(!graph.containsFrame(origin) || !graph.containsFrame(target))
+    {
+        return false;
+    }
+    if(origin == target)
+    {
+        tf = Transform(base::Position::Zero(), base::Orientation::Identity());
+        return true;
+    }
+    try
+    {
+        tf = graph.getTransform(origin, target);
+        return true;
+    }
+    catch(const UnknownTransformException& e)
+    {
+        return false;
+    }
+}
+
+void GraphWaiter::updateSubscription()
+{
+    const bool waiting = getNumberOfPendingWaits() > 0;
+    if(waiting && !subscribed)
+    {
+        subscribe(&graph);
+        subscribed = true;
+    }
+    else if(!waiting && subscribed)
+    {
+        unsubscribe();
+        subscribed = false;
+    }
+}
+
+}}
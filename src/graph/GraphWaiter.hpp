@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/events/GraphEventSubscriber.hpp>
+#include <envire_core/items/ItemBase.hpp>
+#include <envire_core/items/Transform.hpp>
+#include <future>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace envire { namespace core
+{
+    class EnvireGraph;
+
+    /**
+     * Fulfills promises as soon as frames exist or transforms become
+     * resolvable in an EnvireGraph.
+     * The waiter is woken by FrameAdded and EdgeAdded events (including the
+     * ones contained in a GraphEventBatch). It is only subscribed to the graph
+     * while waits are pending. All waits for the same frame or transform share
+     * the same future.
+     *
+     * Is used by EnvireGraph::waitForFrame() and EnvireGraph::waitForTransform().
+     */
+    class GraphWaiter : public GraphEventSubscriber
+    {
+    public:
+        explicit GraphWaiter(EnvireGraph& graph);
+        virtual ~GraphWaiter() {}
+
+        /**@return a future that becomes ready once @p frame exists.
+         *         The future is ready immediately if the frame exists already. */
+        std::shared_future<void> waitForFrame(const FrameId& frame);
+
+        /**@return a future that receives the transform from @p origin to
+         *         @p target once a path between the two frames exists.
+         *         The future is ready immediately if the transform can be
+         *         resolved already. */
+        std::shared_future<Transform> waitForTransform(const FrameId& origin, const FrameId& target);
+
+        /**Gives up one wait for @p frame, e.g. after it timed out.
+         * The wait is removed once all callers that received its future have
+         * given it up. Their futures throw std::future_error (broken_promise)
+         * afterwards. Does nothing if the wait has been fulfilled already. */
+        void cancel(const FrameId& frame);
+
+        /**Gives up one wait for the transform from @p origin to @p target.
+         * @note See cancel(const FrameId&) */
+        void cancel(const FrameId& origin, const FrameId& target);
+
+        /**@return the number of frames and transforms that are waited for */
+        std::size_t getNumberOfPendingWaits() const;
+
+        virtual void notifyGraphEvent(const GraphEvent& event);
+
+    private:
+        template <class T>
+        struct Wait
+        {
+            std::promise<T> promise;
+            std::shared_future<T> future;
+            /**The number of callers that received the future and did not cancel */
+            std::size_t waiters = 1;
+        };
+
+        /**Removes the wait at @p it if it is not used by anyone anymore */
+        template <class Waits>
+        void cancel(Waits& waits, typename Waits::iterator it);
+
+        /**Fulfills all waits that can be fulfilled */
+        void checkWaits();
+
+        /**Tries to resolve the transform from @p origin to @p target.
+         * @return true if @p tf has been set */
+        bool tryGetTransform(const FrameId& origin, const FrameId& target, Transform& tf) const;
+
+        /**Subscribes to the graph while waits are pending and unsubscribes otherwise */
+        void updateSubscription();
+
+        EnvireGraph& graph;
+        bool subscribed;
+        std::unordered_map<FrameId, Wait<void>> frameWaits;
+        std::map<std::pair<FrameId, FrameId>, Wait<Transform>> transformWaits;
+    };
+
+}}
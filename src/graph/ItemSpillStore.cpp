@@ -0,0 +1,357 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <envire_core/graph/ItemSpillStore.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/graph/GraphExceptions.hpp>
+#include <envire_core/events/GraphEventBatch.hpp>
+#include <envire_core/events/ItemAddedEvent.hpp>
+#include <envire_core/events/ItemRemovedEvent.hpp>
+#include <envire_core/serialization/Serialization.hpp>
+#include <boost/filesystem.hpp>
+#include <glog/logging.h>
+#include <fstream>
+#include <iterator>
+
+namespace envire { namespace core
+{
+
+ItemSpillStore::ItemSpillStore(EnvireGraph& graph, const std::string& directory,
+                               const std::size_t memoryBudget) :
+    GraphEventSubscriber(), graph(graph), directory(directory), memoryBudget(memoryBudget),
+    residentBytes(0), spilledCount(0), nextFileId(0), detachedCount(0)
+{
+    boost::filesystem::create_directories(directory);
+    ItemBase::enableAccessTracking();
+    //publishes ItemAddedEvents for all existing items
+    subscribe(&graph, true);
+    enforceBudget();
+}
+
+ItemSpillStore::~ItemSpillStore()
+{
+    unsubscribe();
+    ItemBase::disableAccessTracking();
+    //restoring locks the mutex and modifies the entries
+    std::vector<ItemBase::Ptr> spilled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(EntryMap::value_type& entry : entries)
+        {
+            ItemBase::Ptr item = entry.second.weakItem.lock();
+            if(item && !entry.second.resident)
+            {
+                spilled.push_back(item);
+            }
+        }
+    }
+    for(const ItemBase::Ptr& item : spilled)
+    {
+        try
+        {
+            item->restoreData();
+        }
+        catch(const std::exception& e)
+        {
+            LOG(ERROR) << "Failed to restore spilled item " << item->getIDString() << ": " << e.what();
+            //the item must not refer to this store anymore
+            item->discardReleasedData();
+        }
+    }
+    //files of items that have been destroyed
+    std::lock_guard<std::mutex> lock(mutex);
+    for(EntryMap::value_type& entry : entries)
+    {
+        if(!entry.second.path.empty())
+        {
+            boost::system::error_code error;
+            boost::filesystem::remove(entry.second.path, error);
+            if(error)
+            {
+                LOG(ERROR) << "Failed to remove spill file " << entry.second.path << ": " << error.message();
+            }
+        }
+    }
+}
+
+void ItemSpillStore::setMemoryBudget(const std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryBudget = bytes;
+    spillColdItems();
+}
+
+std::size_t ItemSpillStore::getMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryBudget;
+}
+
+std::size_t ItemSpillStore::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return residentBytes;
+}
+
+std::size_t ItemSpillStore::getSpilledItemCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return spilledCount;
+}
+
+void ItemSpillStore::notifyGraphEvent(const GraphEvent& event)
+{
+    switch(event.getType())
+    {
+        case GraphEvent::ITEM_ADDED_TO_FRAME:
+        {
+            //does not spill, references to the data of other items stay valid
+            std::lock_guard<std::mutex> lock(mutex);
+            itemAdded(static_cast<const ItemAddedEvent&>(event).item);
+            break;
+        }
+        case GraphEvent::ITEM_REMOVED_FROM_FRAME:
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            itemRemoved(static_cast<const ItemRemovedEvent&>(event).item);
+            break;
+        }
+        case GraphEvent::EVENT_BATCH:
+            static_cast<const GraphEventBatch&>(event).visitEvents([this](const GraphEvent& e)
+            {
+                notifyGraphEvent(e);
+            });
+            break;
+        default:
+            break;
+    }
+}
+
+void ItemSpillStore::itemAdded(const ItemBase::Ptr& item)
+{
+    EntryMap::iterator existing = entries.find(item.get());
+    if(existing != entries.end())
+    {
+        if(existing->second.item)
+        {
+            return; //the same item has been added twice
+        }
+        if(!existing->second.weakItem.expired())
+        {
+            //a spilled item has been added again after it had been removed
+            existing->second.item = item;
+            --detachedCount;
+            return;
+        }
+        //the address of a destroyed item has been reused
+        purgeDestroyedItems();
+    }
+    if(!item->isDataResident() || !isSpillable(item))
+    {
+        return;
+    }
+    Entry& entry = entries[item.get()];
+    entry.item = item;
+    entry.weakItem = item;
+    entry.resident = true;
+    entry.bytes = item->getDataSize();
+    entry.position = clock.insert(clock.end(), item.get());
+    residentBytes += entry.bytes;
+}
+
+void ItemSpillStore::itemRemoved(const ItemBase::Ptr& item)
+{
+    EntryMap::iterator it = entries.find(item.get());
+    if(it == entries.end() || !it->second.item)
+    {
+        return;
+    }
+    Entry& entry = it->second;
+    if(entry.resident)
+    {
+        clock.erase(entry.position);
+        residentBytes -= entry.bytes;
+        entries.erase(it);
+        return;
+    }
+    //the item might still be used outside of the graph, keep its file until it is destroyed
+    entry.item.reset();
+    ++detachedCount;
+}
+
+bool ItemSpillStore::isSpillable(const ItemBase::Ptr& item)
+{
+    const ItemTypeId typeId = item->getTypeId();
+    if(typeId >= serializableTypes.size())
+    {
+        serializableTypes.resize(typeId + 1, -1);
+    }
+    if(serializableTypes[typeId] < 0)
+    {
+        //inline data stays in the item, spilling it would not free memory
+        serializableTypes[typeId] = item->hasReleasableData() && Serialization::isSerializable(item) ? 1 : 0;
+    }
+    return serializableTypes[typeId] == 1;
+}
+
+std::size_t ItemSpillStore::enforceBudget()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return spillColdItems();
+}
+
+std::size_t ItemSpillStore::spillColdItems()
+{
+    if(detachedCount > 0)
+    {
+        purgeDestroyedItems();
+    }
+    std::size_t spilled = 0;
+    //every item gets at most one second chance
+    std::size_t visits = 2 * clock.size();
+    while(residentBytes > memoryBudget && !clock.empty() && visits-- > 0)
+    {
+        Entry& entry = entries.at(clock.front());
+        if(entry.item->testAndClearAccessed() || !spill(entry))
+        {
+            clock.splice(clock.end(), clock, entry.position);
+            continue;
+        }
+        ++spilled;
+    }
+    return spilled;
+}
+
+bool ItemSpillStore::spill(const ItemBase::Ptr& item)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    EntryMap::iterator it = entries.find(item.get());
+    if(it == entries.end() || !it->second.item || !it->second.resident)
+    {
+        return false;
+    }
+    return spill(it->second);
+}
+
+bool ItemSpillStore::spill(Entry& entry)
+{
+    if(!entry.item->canReleaseData())
+    {
+        //the payload is shared with a copy of the item
+        return false;
+    }
+    std::vector<uint8_t> buffer;
+    if(!Serialization::saveToBinary(buffer, entry.item))
+    {
+        return false;
+    }
+    const std::string path = directory + "/" + std::to_string(nextFileId++) + ".item";
+    {
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        if(!file)
+        {
+            LOG(ERROR) << "Failed to spill an item to " << path;
+            boost::filesystem::remove(path);
+            return false;
+        }
+    }
+    if(!entry.item->releaseData(this))
+    {
+        boost::filesystem::remove(path);
+        return false;
+    }
+    clock.erase(entry.position);
+    residentBytes -= entry.bytes;
+    entry.resident = false;
+    entry.path = path;
+    ++spilledCount;
+    return true;
+}
+
+void ItemSpillStore::restoreData(ItemBase& item)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    EntryMap::iterator it = entries.find(&item);
+    if(it == entries.end() || it->second.resident)
+    {
+        throw ItemRestoreException("<unknown item>");
+    }
+    Entry& entry = it->second;
+
+    std::ifstream file(entry.path.c_str(), std::ios::binary);
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ItemBase::Ptr loaded;
+    if(!file.good() && !file.eof())
+    {
+        throw ItemRestoreException(entry.path);
+    }
+    if(!Serialization::loadFromBinary(buffer, loaded) || !loaded ||
+       loaded->getTypeId() != item.getTypeId())
+    {
+        throw ItemRestoreException(entry.path);
+    }
+    //the item only reports itself resident once this call returns
+    const std::size_t bytes = loaded->getDataSize();
+    item.adoptData(*loaded);
+    boost::filesystem::remove(entry.path);
+    entry.path.clear();
+    --spilledCount;
+
+    if(entry.item)
+    {
+        entry.resident = true;
+        entry.bytes = bytes;
+        entry.position = clock.insert(clock.end(), &item);
+        residentBytes += entry.bytes;
+    }
+    else
+    {
+        //the item is not part of the graph anymore
+        --detachedCount;
+        entries.erase(it);
+    }
+}
+
+void ItemSpillStore::purgeDestroyedItems()
+{
+    for(EntryMap::iterator it = entries.begin(); it != entries.end();)
+    {
+        if(!it->second.item && it->second.weakItem.expired())
+        {
+            boost::filesystem::remove(it->second.path);
+            --spilledCount;
+            --detachedCount;
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+}}
@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/events/GraphEventSubscriber.hpp>
+#include <envire_core/items/ItemBase.hpp>
+#include <boost/weak_ptr.hpp>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace envire { namespace core
+{
+    class EnvireGraph;
+
+    /**
+     * Keeps the data of the items in an EnvireGraph within a memory budget by
+     * writing the data of cold items to files and freeing it.
+     *
+     * The items themselves stay in their frames with their metadata (uuid,
+     * time, frame), only the payload is freed (see ItemBase::releaseData()).
+     * The payload is restored transparently on the next access, e.g. through
+     * Item::getData() while iterating getItems().
+     *
+     * The items are written using the Serialization handles, i.e. only items
+     * that are registered using ENVIRE_REGISTER_ITEM can be spilled. Items
+     * whose payload is stored inline (see ItemPayloadIsShared) or is shared
+     * with a copy are never spilled.
+     *
+     * The spilled items are chosen least recently used first. The usage is
+     * approximated using the CLOCK algorithm: while a store exists, every data
+     * access sets a flag on the item (see ItemBase::enableAccessTracking())
+     * and items whose flag is set get a second chance.
+     *
+     * Items are only spilled by the constructor, setMemoryBudget(),
+     * enforceBudget() and spill(). Adding items to the graph or restoring
+     * items never spills other items, thus the budget may be exceeded until
+     * the next enforcement. Call enforceBudget() at points where no
+     * references to the data of items are held, e.g. once per cycle.
+     *
+     * @warning References to the data of an item (e.g. from getData()) become
+     *          invalid when the item is spilled.
+     * @note Spilled items can be restored from several threads concurrently.
+     *       Spilling must not run concurrently with accesses to the data of
+     *       the spilled items.
+     */
+    class ItemSpillStore : public GraphEventSubscriber, public ItemDataSource
+    {
+    public:
+        /**Manages all items of @p graph, including the existing ones.
+         * @param directory the files of spilled items are stored here. Is created if needed.
+         * @param memoryBudget maximum sum of ItemBase::getDataSize() of the resident items */
+        ItemSpillStore(EnvireGraph& graph, const std::string& directory, const std::size_t memoryBudget);
+        /**Restores all spilled items that are still alive and removes their files */
+        virtual ~ItemSpillStore();
+
+        /**Sets the budget and enforces it */
+        void setMemoryBudget(const std::size_t bytes);
+        std::size_t getMemoryBudget() const;
+
+        /**@return the sum of ItemBase::getDataSize() of all resident items of the graph
+         *         that can be spilled. Items with inline data are not counted */
+        std::size_t getResidentBytes() const;
+        /**@return the number of items whose data is on disk */
+        std::size_t getSpilledItemCount() const;
+
+        /**Spills least recently used items until the resident items fit into the budget.
+         * @return the number of spilled items */
+        std::size_t enforceBudget();
+
+        /**Spills @p item regardless of the budget.
+         * @return false if the item is not part of the graph or cannot be spilled */
+        bool spill(const ItemBase::Ptr& item);
+
+        virtual void notifyGraphEvent(const GraphEvent& event);
+        virtual void restoreData(ItemBase& item);
+
+    private:
+        struct Entry
+        {
+            /**Is null after the item has been removed from the graph */
+            ItemBase::Ptr item;
+            /**Is used to restore removed items that are still alive */
+            boost::weak_ptr<ItemBase> weakItem;
+            /**Position in the clock, valid while the item is resident and in the graph */
+            std::list<const ItemBase*>::iterator position;
+            bool resident;
+            std::size_t bytes; /**<Resident size when the item was tracked or restored */
+            std::string path; /**<File of the spilled data, empty if resident */
+        };
+        using EntryMap = std::unordered_map<const ItemBase*, Entry>;
+
+        void itemAdded(const ItemBase::Ptr& item);
+        void itemRemoved(const ItemBase::Ptr& item);
+
+        /**@return false if items of this type can never be spilled, because
+         *         they are not registered or store their data inline */
+        bool isSpillable(const ItemBase::Ptr& item);
+
+        /**Writes the data of @p entry to disk and frees it */
+        bool spill(Entry& entry);
+
+        /**Removes the entries of spilled items that have been destroyed */
+        void purgeDestroyedItems();
+
+        /**enforceBudget() without locking */
+        std::size_t spillColdItems();
+
+        EnvireGraph& graph;
+        const std::string directory;
+        std::size_t memoryBudget;
+        std::size_t residentBytes;
+        std::size_t spilledCount;
+        std::size_t nextFileId;
+        EntryMap entries;
+        /**Resident items in the graph, the front is the oldest */
+        std::list<const ItemBase*> clock;
+        /**Caches Serialization::isSerializable() per ItemTypeId, -1 means unknown */
+        std::vector<signed char> serializableTypes;
+        /**Items that have been removed from the graph while they were spilled */
+        std::size_t detachedCount;
+        /**Guards all members, items are restored by the threads that access them */
+        mutable std::mutex mutex;
+    };
+
+}}
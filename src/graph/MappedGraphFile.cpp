@@ -0,0 +1,507 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <envire_core/graph/MappedGraphFile.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/graph/GraphExceptions.hpp>
+#include <envire_core/serialization/Serialization.hpp>
+#include <glog/logging.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace envire { namespace core
+{
+
+namespace
+{
+    const char fileMagic[8] = {'E', 'N', 'V', 'G', 'R', 'A', 'P', 'H'};
+    /**Version 1 stores Serialization::saveToBinary() of the items,
+     * version 2 stores Serialization::saveRecord() */
+    const std::uint32_t fileVersion = 2;
+    const std::uint32_t oldestFileVersion = 1;
+
+    /**All tables start at offsets that are a multiple of this */
+    const std::uint64_t tableAlignment = 8;
+
+    struct TableEntry
+    {
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        TableEntry strings; /**<count is the size in bytes */
+        TableEntry frames;
+        TableEntry edges;
+        TableEntry types;
+        TableEntry items;
+    };
+
+    /**Frame ids and item class names, refers to the string table */
+    struct NameRecord
+    {
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::uint32_t reserved;
+    };
+
+    struct EdgeRecord
+    {
+        std::uint32_t source; /**<index in the frame table */
+        std::uint32_t target;
+        std::int64_t time; /**<microseconds */
+        double translation[3];
+        double orientation[4]; /**<x, y, z, w */
+        double covariance[36]; /**<column major */
+    };
+
+    struct ItemRecord
+    {
+        std::uint32_t frame; /**<index in the frame table */
+        std::uint32_t type; /**<index in the type table */
+        std::int64_t time; /**<microseconds */
+        std::uint8_t uuid[16];
+        std::uint64_t dataOffset; /**<Serialization::saveRecord() of the item */
+        std::uint64_t dataSize;
+    };
+
+    template <class Record>
+    void writeTable(std::ofstream& out, const std::vector<Record>& records, TableEntry& entry)
+    {
+        const std::uint64_t padding = (tableAlignment - out.tellp() % tableAlignment) % tableAlignment;
+        const char zeros[tableAlignment] = {};
+        out.write(zeros, padding);
+        entry.offset = out.tellp();
+        entry.count = records.size();
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    }
+
+    /**Reads record @p index of a table. The tables have been checked by readHeader() */
+    template <class Record>
+    Record readRecord(const std::uint8_t* data, const std::uint64_t tableOffset, const std::uint64_t index)
+    {
+        Record record;
+        std::memcpy(&record, data + tableOffset + index * sizeof(Record), sizeof(Record));
+        return record;
+    }
+
+    NameRecord addString(std::vector<char>& strings, const std::string& s)
+    {
+        NameRecord record;
+        record.offset = strings.size();
+        record.length = s.size();
+        record.reserved = 0;
+        strings.insert(strings.end(), s.begin(), s.end());
+        return record;
+    }
+}
+
+void MappedGraphFile::save(const EnvireGraph& graph, const std::string& file)
+{
+    std::ofstream out;
+    //set exception bits to ensure that out throws in case of error
+    out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    out.open(file, std::ios::binary | std::ios::trunc); //may throw
+
+    //the header is written again when all offsets are known
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.headerSize = sizeof(FileHeader);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<char> strings;
+    std::vector<NameRecord> frames;
+    std::vector<EdgeRecord> edges;
+    std::vector<NameRecord> types;
+    std::vector<ItemRecord> items;
+    std::unordered_map<EnvireGraph::vertex_descriptor, std::uint32_t> frameIndices;
+    std::map<std::string, std::uint32_t> typeIndices;
+
+    EnvireGraph::vertex_iterator vertexIt, vertexEnd;
+    for(boost::tie(vertexIt, vertexEnd) = graph.getVertices(); vertexIt != vertexEnd; ++vertexIt)
+    {
+        frameIndices[*vertexIt] = frames.size();
+        frames.push_back(addString(strings, graph.getFrameId(*vertexIt)));
+    }
+
+    //every transform is stored in both directions, only one of them is saved
+    std::set<std::pair<std::uint32_t, std::uint32_t>> savedEdges;
+    EnvireGraph::edge_iterator edgeIt, edgeEnd;
+    for(boost::tie(edgeIt, edgeEnd) = graph.getEdges(); edgeIt != edgeEnd; ++edgeIt)
+    {
+        const std::uint32_t source = frameIndices[graph.getSourceVertex(*edgeIt)];
+        const std::uint32_t target = frameIndices[graph.getTargetVertex(*edgeIt)];
+        if(savedEdges.count(std::make_pair(target, source)))
+            continue;
+        savedEdges.insert(std::make_pair(source, target));
+
+        const Transform& tf = graph.getEdgeProperty(*edgeIt);
+        EdgeRecord record;
+        record.source = source;
+        record.target = target;
+        record.time = tf.time.microseconds;
+        Eigen::Map<Eigen::Vector3d>(record.translation) = tf.transform.translation;
+        Eigen::Map<Eigen::Vector4d>(record.orientation) = tf.transform.orientation.coeffs();
+        Eigen::Map<base::Matrix6d>(record.covariance) = tf.transform.cov;
+        edges.push_back(record);
+    }
+
+    //the items are written first, their offsets are stored in the item table
+    std::vector<uint8_t> buffer;
+    for(boost::tie(vertexIt, vertexEnd) = graph.getVertices(); vertexIt != vertexEnd; ++vertexIt)
+    {
+        const Frame& frame = graph.getFrameProperty(graph.getFrameId(*vertexIt));
+        for(const Frame::ItemMap::value_type& list : frame.items)
+        {
+            if(list.second.empty() || !Serialization::isSerializable(list.second.front()))
+                continue;
+
+            std::string className;
+            list.second.front()->getClassName(className);
+            std::map<std::string, std::uint32_t>::iterator type = typeIndices.find(className);
+            if(type == typeIndices.end())
+            {
+                type = typeIndices.insert(std::make_pair(className, types.size())).first;
+                types.push_back(addString(strings, className));
+            }
+
+            for(const ItemBase::Ptr& item : list.second)
+            {
+                if(!Serialization::saveRecord(buffer, item, className))
+                    throw std::runtime_error("Failed to serialize an item of type " + className);
+
+                ItemRecord record;
+                record.frame = frameIndices[*vertexIt];
+                record.type = type->second;
+                record.time = item->getTime().microseconds;
+                std::copy(item->getID().begin(), item->getID().end(), record.uuid);
+                record.dataOffset = out.tellp();
+                record.dataSize = buffer.size();
+                out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+                items.push_back(record);
+            }
+        }
+    }
+
+    writeTable(out, strings, header.strings);
+    writeTable(out, frames, header.frames);
+    writeTable(out, edges, header.edges);
+    writeTable(out, types, header.types);
+    writeTable(out, items, header.items);
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+}
+
+MappedGraphFile::MappedGraphFile(const std::string& file) : path(file), data(nullptr), size(0), version(0)
+{
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw InvalidGraphFileException(file, std::strerror(errno));
+
+    struct stat info;
+    if(::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+        ::close(fd);
+        throw InvalidGraphFileException(file, "file is too small");
+    }
+    size = info.st_size;
+
+    //the mapping stays valid after the descriptor has been closed
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED)
+        throw InvalidGraphFileException(file, std::strerror(errno));
+    data = static_cast<const std::uint8_t*>(mapping);
+
+    try
+    {
+        readHeader();
+    }
+    catch(...)
+    {
+        ::munmap(const_cast<std::uint8_t*>(data), size);
+        throw;
+    }
+}
+
+MappedGraphFile::~MappedGraphFile()
+{
+    try
+    {
+        decodeAll();
+    }
+    catch(const std::exception& e)
+    {
+        LOG(ERROR) << "Failed to decode lazy items of " << path << ": " << e.what();
+    }
+    ::munmap(const_cast<std::uint8_t*>(data), size);
+}
+
+void MappedGraphFile::readHeader()
+{
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if(std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0)
+        throw InvalidGraphFileException(path, "not a graph file");
+    if(header.version < oldestFileVersion || header.version > fileVersion)
+        throw InvalidGraphFileException(path, "unsupported version " + std::to_string(header.version));
+    version = header.version;
+
+    auto checkTable = [this](const TableEntry& entry, const std::size_t recordSize, const char* name)
+    {
+        if(entry.offset % tableAlignment != 0 || entry.offset > size ||
+           entry.count > (size - entry.offset) / recordSize)
+        {
+            throw InvalidGraphFileException(path, std::string("the ") + name + " table is truncated");
+        }
+        return Table{entry.offset, entry.count};
+    };
+    strings = checkTable(header.strings, 1, "string");
+    frames = checkTable(header.frames, sizeof(NameRecord), "frame");
+    edges = checkTable(header.edges, sizeof(EdgeRecord), "edge");
+    types = checkTable(header.types, sizeof(NameRecord), "type");
+    items = checkTable(header.items, sizeof(ItemRecord), "item");
+}
+
+std::string MappedGraphFile::readString(const std::uint64_t offset, const std::uint32_t length) const
+{
+    if(offset > strings.count || length > strings.count - offset)
+        throw InvalidGraphFileException(path, "a name is outside of the string table");
+    const char* begin = reinterpret_cast<const char*>(data + strings.offset + offset);
+    return std::string(begin, length);
+}
+
+std::size_t MappedGraphFile::load(EnvireGraph& graph, const GraphLoadOptions& options)
+{
+    std::vector<FrameId> frameIds;
+    std::vector<bool> selectedFrames;
+    frameIds.reserve(frames.count);
+    selectedFrames.reserve(frames.count);
+    for(std::uint64_t i = 0; i < frames.count; ++i)
+    {
+        const NameRecord record = readRecord<NameRecord>(data, frames.offset, i);
+        frameIds.push_back(readString(record.offset, record.length));
+        selectedFrames.push_back(options.isFrameSelected(frameIds.back()));
+        if(selectedFrames.back() && !graph.containsFrame(frameIds.back()))
+            graph.addFrame(frameIds.back());
+    }
+
+    for(std::uint64_t i = 0; i < edges.count; ++i)
+    {
+        const EdgeRecord record = readRecord<EdgeRecord>(data, edges.offset, i);
+        if(record.source >= frameIds.size() || record.target >= frameIds.size())
+            throw InvalidGraphFileException(path, "an edge refers to an unknown frame");
+        if(!selectedFrames[record.source] || !selectedFrames[record.target])
+            continue;
+
+        Transform tf;
+        tf.time.microseconds = record.time;
+        tf.transform.translation = Eigen::Map<const Eigen::Vector3d>(record.translation);
+        tf.transform.orientation.coeffs() = Eigen::Map<const Eigen::Vector4d>(record.orientation);
+        tf.transform.cov = Eigen::Map<const base::Matrix6d>(record.covariance);
+        const FrameId& source = frameIds[record.source];
+        const FrameId& target = frameIds[record.target];
+        if(graph.containsEdge(source, target))
+            graph.updateTransform(source, target, tf);
+        else
+            graph.addTransform(source, target, tf);
+    }
+
+    if(options.structureOnly)
+        return 0;
+
+    //types that are not selected or unknown are skipped without touching their records
+    std::vector<std::string> classNames;
+    std::vector<bool> loadableTypes;
+    classNames.reserve(types.count);
+    loadableTypes.reserve(types.count);
+    for(std::uint64_t i = 0; i < types.count; ++i)
+    {
+        const NameRecord record = readRecord<NameRecord>(data, types.offset, i);
+        classNames.push_back(readString(record.offset, record.length));
+        loadableTypes.push_back(options.isItemClassSelected(classNames.back()) &&
+                                Serialization::isLoadable(classNames.back()));
+    }
+
+    std::size_t added = 0;
+    for(std::uint64_t i = 0; i < items.count; ++i)
+    {
+        const ItemRecord record = readRecord<ItemRecord>(data, items.offset, i);
+        if(record.frame >= frameIds.size() || record.type >= classNames.size() ||
+           record.dataOffset > size || record.dataSize > size - record.dataOffset)
+        {
+            throw InvalidGraphFileException(path, "item record " + std::to_string(i) + " is invalid");
+        }
+        if(!selectedFrames[record.frame] || !loadableTypes[record.type])
+            continue;
+
+        ItemBase::Ptr item = Serialization::createItem(classNames[record.type]);
+        if(!item)
+        {
+            //the handle cannot create items
+            item = decode(i);
+        }
+        else
+        {
+            boost::uuids::uuid id;
+            std::copy(record.uuid, record.uuid + sizeof(record.uuid), id.begin());
+            item->setID(id);
+            item->setTime(base::Time::fromMicroseconds(record.time));
+
+            //the item is not shared yet, nobody can restore it before it is registered
+            if(item->releaseData(this))
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                LazyItem& lazy = lazyItems[item.get()];
+                lazy.record = i;
+                lazy.item = item;
+            }
+            else
+            {
+                //the payload is stored inline, decoding it is cheap
+                item = decode(i);
+            }
+        }
+        graph.addItemToFrame(frameIds[record.frame], item);
+        ++added;
+    }
+    return added;
+}
+
+ItemBase::Ptr MappedGraphFile::decode(const std::uint64_t index) const
+{
+    const ItemRecord record = readRecord<ItemRecord>(data, items.offset, index);
+    const NameRecord type = readRecord<NameRecord>(data, types.offset, record.type);
+    ItemBase::Ptr item;
+    try
+    {
+        const bool loaded = version >= 2 ?
+            Serialization::loadRecord(data + record.dataOffset, record.dataSize,
+                                      readString(type.offset, type.length), item) :
+            Serialization::loadFromBinary(data + record.dataOffset, record.dataSize, item);
+        if(!loaded)
+            item.reset();
+    }
+    catch(const std::exception& e)
+    {
+        LOG(ERROR) << "Failed to decode item record " << index << ": " << e.what();
+        item.reset();
+    }
+    if(!item)
+        throw ItemRestoreException(path);
+    return item;
+}
+
+void MappedGraphFile::restoreData(ItemBase& item)
+{
+    std::uint64_t record;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = lazyItems.find(&item);
+        if(it == lazyItems.end())
+            throw ItemRestoreException(path);
+        record = it->second.record;
+    }
+
+    //the mapping is read only, items are decoded without holding the lock
+    ItemBase::Ptr loaded = decode(record);
+    if(loaded->getTypeId() != item.getTypeId())
+        throw ItemRestoreException(path);
+    item.adoptData(*loaded);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lazyItems.erase(&item);
+}
+
+std::size_t MappedGraphFile::decodeAll()
+{
+    //restoring locks the mutex and modifies lazyItems
+    std::vector<ItemBase::Ptr> alive;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const auto& entry : lazyItems)
+        {
+            ItemBase::Ptr item = entry.second.item.lock();
+            if(item && !item->isDataResident())
+                alive.push_back(item);
+        }
+    }
+    std::size_t failed = 0;
+    for(const ItemBase::Ptr& item : alive)
+    {
+        try
+        {
+            item->restoreData();
+        }
+        catch(const std::exception& e)
+        {
+            LOG(ERROR) << "Failed to decode lazy item " << item->getIDString() << " of " << path << ": " << e.what();
+            //the item must not refer to this file anymore
+            item->discardReleasedData();
+            ++failed;
+        }
+    }
+    //the remaining entries belong to destroyed items or items that failed to decode
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto it = lazyItems.begin(); it != lazyItems.end();)
+    {
+        ItemBase::Ptr item = it->second.item.lock();
+        if(!item || item->isDataResident())
+            it = lazyItems.erase(it);
+        else
+            ++it;
+    }
+    return failed;
+}
+
+std::size_t MappedGraphFile::getLazyItemCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = 0;
+    for(const auto& entry : lazyItems)
+    {
+        if(!entry.second.item.expired())
+            ++count;
+    }
+    return count;
+}
+
+}}
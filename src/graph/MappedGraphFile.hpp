@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/items/ItemBase.hpp>
+#include <envire_core/serialization/GraphLoadOptions.hpp>
+#include <boost/weak_ptr.hpp>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace envire { namespace core
+{
+    class EnvireGraph;
+
+    /**
+     * A graph file that is opened using mmap and whose items are decoded lazily.
+     *
+     * EnvireGraph::loadFromFile() deserializes the whole graph including the
+     * data of all items before it returns. A MappedGraphFile stores the frames,
+     * the edges and one fixed size record per item (frame, type, uuid, time and
+     * the position of the serialized item in the file) in separate tables.
+     * load() creates the structure and empty items from these tables, the data
+     * of an item is decoded from the mapped file on its first access
+     * (see ItemBase::releaseData()). Thus opening a file only touches the
+     * tables and the pages of the items that are actually used.
+     *
+     * Only items that are registered using ENVIRE_REGISTER_ITEM are stored.
+     * Items whose payload is stored inline (see ItemPayloadIsShared) are
+     * decoded during load().
+     *
+     * The file has to stay open while items are lazy, thus the destructor
+     * decodes all lazy items that are still alive.
+     *
+     * The tables are stored in host byte order, files are not portable between
+     * architectures of different endianness.
+     *
+     * @note Lazy items of the same file can be accessed from several threads
+     *       concurrently, each item is decoded exactly once
+     *       (see ItemBase::restoreData()). load() and decodeAll() must not be
+     *       called concurrently with other calls that modify the graph.
+     */
+    class MappedGraphFile : public ItemDataSource
+    {
+    public:
+        /**Writes the frames, edges and serializable items of @p graph to @p file.
+         * @throw std::ios_base::failure if the file operation failed
+         * @throw std::runtime_error if a serializable item cannot be serialized */
+        static void save(const EnvireGraph& graph, const std::string& file);
+
+        /**Maps @p file into memory and checks its tables.
+         * @throw InvalidGraphFileException if the file cannot be mapped or is
+         *                                  not a valid graph file */
+        explicit MappedGraphFile(const std::string& file);
+        /**Decodes the data of all lazy items that are still alive */
+        virtual ~MappedGraphFile();
+
+        MappedGraphFile(const MappedGraphFile&) = delete;
+        MappedGraphFile& operator=(const MappedGraphFile&) = delete;
+
+        /**Adds the frames, edges and items of the file that are selected by
+         * @p options to @p graph. Skipped items are not read at all, thus a
+         * structure only load is independent of the size of the items.
+         * Existing frames are reused and existing edges are updated.
+         * Items of unknown types are dropped.
+         * @return the number of items added to the graph */
+        std::size_t load(EnvireGraph& graph, const GraphLoadOptions& options = GraphLoadOptions());
+
+        /**Decodes the data of all lazy items that are still alive.
+         * Items that fail to decode are logged and keep default constructed
+         * data, they are not lazy anymore afterwards.
+         * @return the number of items that failed to decode */
+        std::size_t decodeAll();
+
+        std::size_t getFrameCount() const { return frames.count; }
+        std::size_t getEdgeCount() const { return edges.count; }
+        std::size_t getItemCount() const { return items.count; }
+        /**@return the number of items that are alive and have not been decoded yet */
+        std::size_t getLazyItemCount() const;
+
+        virtual void restoreData(ItemBase& item);
+
+    private:
+        struct Table
+        {
+            std::uint64_t offset;
+            std::uint64_t count;
+        };
+
+        struct LazyItem
+        {
+            std::uint64_t record;
+            boost::weak_ptr<ItemBase> item;
+        };
+
+        /**Reads the header and checks that all tables are inside the file */
+        void readHeader();
+        /**Returns the string at @p offset of the string table */
+        std::string readString(const std::uint64_t offset, const std::uint32_t length) const;
+        /**Decodes the item of @p record */
+        ItemBase::Ptr decode(const std::uint64_t record) const;
+
+        const std::string path;
+        const std::uint8_t* data;
+        std::size_t size;
+        /**Format version of the file */
+        std::uint32_t version;
+        Table strings;
+        Table frames;
+        Table edges;
+        Table types;
+        Table items;
+        /**Guards lazyItems, items are decoded by the threads that access them */
+        mutable std::mutex mutex;
+        std::unordered_map<const ItemBase*, LazyItem> lazyItems;
+    };
+
+}}
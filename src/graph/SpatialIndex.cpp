@@ -0,0 +1,433 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <envire_core/graph/SpatialIndex.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/items/SpatialItem.hpp>
+#include <envire_core/events/GraphEventBatch.hpp>
+#include <envire_core/events/EdgeEvents.hpp>
+#include <envire_core/events/FrameEvents.hpp>
+#include <envire_core/events/ItemAddedEvent.hpp>
+#include <envire_core/events/ItemRemovedEvent.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
+#include <algorithm>
+#include <iterator>
+
+namespace bgi = boost::geometry::index;
+
+namespace envire { namespace core
+{
+
+SpatialIndex::SpatialIndex(EnvireGraph& graph, const FrameId& referenceFrame) :
+    GraphEventSubscriber(), graph(graph), referenceFrame(referenceFrame), transformsDirty(false)
+{
+    view.edgeAdded.connect(boost::bind(&SpatialIndex::treeEdgeAdded, this,
+                                       boost::placeholders::_1, boost::placeholders::_2));
+    //the removed subtree might be reachable through a different path
+    view.edgeRemoved.connect([this](GraphTraits::vertex_descriptor, GraphTraits::vertex_descriptor)
+    {
+        transformsDirty = true;
+    });
+    updateView();
+    dirtySubtrees.clear();
+    //publishes ItemAddedEvents for all existing items
+    subscribe(&graph, true);
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    unsubscribe();
+    for(auto& item : items)
+    {
+        item.second.item->disconnectContentsChangedCallback(
+            boost::bind(&SpatialIndex::itemChanged, this, boost::placeholders::_1));
+    }
+}
+
+void SpatialIndex::notifyGraphEvent(const GraphEvent& event)
+{
+    switch(event.getType())
+    {
+        case GraphEvent::ITEM_ADDED_TO_FRAME:
+        {
+            const ItemAddedEvent& itemEvent = static_cast<const ItemAddedEvent&>(event);
+            itemAdded(itemEvent.frame, itemEvent.item);
+        }
+            break;
+        case GraphEvent::ITEM_REMOVED_FROM_FRAME:
+            itemRemoved(static_cast<const ItemRemovedEvent&>(event).item);
+            break;
+        case GraphEvent::EDGE_MODIFIED:
+            edgeModified(static_cast<const EdgeModifiedEvent&>(event));
+            break;
+        case GraphEvent::FRAME_ADDED: //the reference frame might be added later
+            if(static_cast<const FrameEvent&>(event).frame == referenceFrame)
+            {
+                transformsDirty = true;
+            }
+            break;
+        case GraphEvent::FRAME_REMOVED:
+            if(static_cast<const FrameEvent&>(event).frame == referenceFrame)
+            {
+                //the root of the view does not exist anymore
+                view.unsubscribe();
+                view.clear();
+                transformsDirty = true;
+            }
+            break;
+        case GraphEvent::EVENT_BATCH:
+            static_cast<const GraphEventBatch&>(event).visitEvents([this](const GraphEvent& e)
+            {
+                notifyGraphEvent(e);
+            });
+            break;
+        default:
+            break;
+    }
+}
+
+void SpatialIndex::edgeModified(const EdgeModifiedEvent& event)
+{
+    if(!view.hasRoot() || !graph.containsFrame(event.origin) || !graph.containsFrame(event.target))
+    {
+        return;
+    }
+    const GraphTraits::vertex_descriptor origin = graph.getVertex(event.origin);
+    const GraphTraits::vertex_descriptor target = graph.getVertex(event.target);
+    if(!view.vertexExists(origin) || !view.vertexExists(target))
+    {
+        return;
+    }
+    //only the subtree below a tree edge moves, cross edges are not used by the index
+    if(view.isParent(origin, target))
+    {
+        dirtySubtrees.insert(event.target);
+    }
+    else if(view.isParent(target, origin))
+    {
+        dirtySubtrees.insert(event.origin);
+    }
+}
+
+void SpatialIndex::itemAdded(const FrameId& frame, const ItemBase::Ptr& item)
+{
+    if(dynamic_cast<const SpatialItemBase*>(item.get()) == nullptr)
+    {
+        return;
+    }
+    auto frameIt = frames.find(frame);
+    if(frameIt == frames.end())
+    {
+        frameIt = frames.emplace(frame, FrameEntry()).first;
+        updateTransform(frame, frameIt->second);
+    }
+    frameIt->second.items.insert(item.get());
+
+    ItemEntry& entry = items[item.get()];
+    entry.item = item;
+    entry.frame = frame;
+    entry.indexed = false;
+    refit(entry);
+    item->connectContentsChangedCallback(boost::bind(&SpatialIndex::itemChanged, this, boost::placeholders::_1));
+}
+
+void SpatialIndex::itemRemoved(const ItemBase::Ptr& item)
+{
+    auto it = items.find(item.get());
+    if(it == items.end())
+    {
+        return;
+    }
+    ItemEntry& entry = it->second;
+    if(entry.indexed)
+    {
+        tree.remove(Value(entry.box, item.get()));
+    }
+    auto frameIt = frames.find(entry.frame);
+    frameIt->second.items.erase(item.get());
+    if(frameIt->second.items.empty())
+    {
+        frames.erase(frameIt);
+    }
+    item->disconnectContentsChangedCallback(boost::bind(&SpatialIndex::itemChanged, this, boost::placeholders::_1));
+    items.erase(it);
+}
+
+void SpatialIndex::itemChanged(ItemBase& item)
+{
+    auto it = items.find(&item);
+    if(it != items.end())
+    {
+        refit(it->second);
+    }
+}
+
+void SpatialIndex::refit(ItemEntry& entry)
+{
+    if(entry.indexed)
+    {
+        tree.remove(Value(entry.box, entry.item.get()));
+        entry.indexed = false;
+    }
+    const FrameEntry& frame = frames.at(entry.frame);
+    const boost::shared_ptr<BoundingVolume>& boundary =
+        dynamic_cast<const SpatialItemBase&>(*entry.item).getBoundary();
+    if(!frame.reachable || !boundary)
+    {
+        return;
+    }
+    const Box local = boundary->getAlignedBox();
+    if(local.isEmpty())
+    {
+        return;
+    }
+    //transform all corners, the result encloses the rotated box
+    Box world;
+    for(int i = 0; i < 8; ++i)
+    {
+        world.extend(frame.toReference * local.corner(static_cast<Box::CornerType>(i)));
+    }
+    entry.box = toRBox(world);
+    tree.insert(Value(entry.box, entry.item.get()));
+    entry.indexed = true;
+}
+
+void SpatialIndex::updateTransform(const FrameId& frame, FrameEntry& entry) const
+{
+    entry.reachable = false;
+    if(view.root == GraphTraits::null_vertex() || !graph.containsFrame(frame))
+    {
+        return;
+    }
+    const GraphTraits::vertex_descriptor vertex = graph.getVertex(frame);
+    if(!view.vertexExists(vertex))
+    {
+        return;
+    }
+    if(view.isRoot(vertex))
+    {
+        entry.toReference.setIdentity();
+    }
+    else
+    {
+        entry.toReference = graph.getTransform(view.root, vertex, view).transform.getTransform();
+    }
+    entry.reachable = true;
+}
+
+void SpatialIndex::setTransform(FrameEntry& entry, const bool reachable, const Eigen::Affine3d& toReference)
+{
+    if(entry.reachable == reachable &&
+       (!reachable || entry.toReference.matrix() == toReference.matrix()))
+    {
+        return;
+    }
+    entry.reachable = reachable;
+    entry.toReference = toReference;
+    for(const ItemBase* item : entry.items)
+    {
+        refit(items.at(item));
+    }
+}
+
+void SpatialIndex::updateSubtree(const GraphTraits::vertex_descriptor root)
+{
+    std::unordered_map<GraphTraits::vertex_descriptor, Eigen::Affine3d> transforms;
+    transforms[root] = view.isRoot(root) ? Eigen::Affine3d::Identity() :
+                       graph.getTransform(view.root, root, view).transform.getTransform();
+    view.visitDfs(root, [&](const GraphTraits::vertex_descriptor node, const GraphTraits::vertex_descriptor parent)
+    {
+        if(node != root)
+        {
+            //tree edges are direct edges, no path search
+            transforms[node] = transforms.at(parent) * graph.getTransform(parent, node).transform.getTransform();
+        }
+        auto frame = frames.find(graph.getFrameId(node));
+        if(frame != frames.end())
+        {
+            setTransform(frame->second, true, transforms[node]);
+        }
+    });
+}
+
+bool SpatialIndex::updateView()
+{
+    if(!graph.containsFrame(referenceFrame))
+    {
+        view.unsubscribe();
+        view.clear();
+        return false;
+    }
+    if(view.hasRoot())
+    {
+        return false;
+    }
+    graph.getTree(referenceFrame, true, &view);
+    return true;
+}
+
+void SpatialIndex::treeEdgeAdded(const GraphTraits::vertex_descriptor origin,
+                                 const GraphTraits::vertex_descriptor target)
+{
+    dirtySubtrees.insert(graph.getFrameId(target));
+}
+
+void SpatialIndex::update()
+{
+    if(updateView())
+    {
+        transformsDirty = true;
+    }
+    if(transformsDirty)
+    {
+        transformsDirty = false;
+        dirtySubtrees.clear();
+        for(auto& frame : frames)
+        {
+            FrameEntry entry;
+            updateTransform(frame.first, entry);
+            setTransform(frame.second, entry.reachable, entry.toReference);
+        }
+        return;
+    }
+    if(dirtySubtrees.empty())
+    {
+        return;
+    }
+    //subtrees that are part of another dirty subtree are updated with it
+    std::unordered_set<GraphTraits::vertex_descriptor> dirty;
+    for(const FrameId& frame : dirtySubtrees)
+    {
+        if(graph.containsFrame(frame))
+        {
+            const GraphTraits::vertex_descriptor vertex = graph.getVertex(frame);
+            if(view.vertexExists(vertex))
+            {
+                dirty.insert(vertex);
+            }
+        }
+    }
+    dirtySubtrees.clear();
+    std::vector<GraphTraits::vertex_descriptor> roots;
+    for(const GraphTraits::vertex_descriptor vertex : dirty)
+    {
+        GraphTraits::vertex_descriptor ancestor = view.getParent(vertex);
+        while(ancestor != GraphTraits::null_vertex() && dirty.count(ancestor) == 0)
+        {
+            ancestor = view.getParent(ancestor);
+        }
+        if(ancestor == GraphTraits::null_vertex())
+        {
+            roots.push_back(vertex);
+        }
+    }
+    for(const GraphTraits::vertex_descriptor root : roots)
+    {
+        updateSubtree(root);
+    }
+}
+
+std::vector<ItemBase::Ptr> SpatialIndex::queryBox(const Box& box)
+{
+    update();
+    std::vector<ItemBase::Ptr> result;
+    tree.query(bgi::intersects(toRBox(box)), boost::make_function_output_iterator([&](const Value& v)
+    {
+        result.push_back(items.at(v.second).item);
+    }));
+    return result;
+}
+
+std::vector<ItemBase::Ptr> SpatialIndex::querySphere(const Eigen::Vector3d& center, const double radius)
+{
+    update();
+    const Eigen::Vector3d extent(radius, radius, radius);
+    const double squaredRadius = radius * radius;
+    std::vector<ItemBase::Ptr> result;
+    tree.query(bgi::intersects(toRBox(Box(center - extent, center + extent))),
+               boost::make_function_output_iterator([&](const Value& v)
+    {
+        if(toBox(v.first).squaredExteriorDistance(center) <= squaredRadius)
+        {
+            result.push_back(items.at(v.second).item);
+        }
+    }));
+    return result;
+}
+
+std::vector<ItemBase::Ptr> SpatialIndex::queryNearest(const Eigen::Vector3d& point, const std::size_t k)
+{
+    update();
+    std::vector<Value> values;
+    tree.query(bgi::nearest(Point(point.x(), point.y(), point.z()), k), std::back_inserter(values));
+    std::vector<std::pair<double, const ItemBase*>> sorted;
+    for(const Value& v : values)
+    {
+        sorted.emplace_back(toBox(v.first).squaredExteriorDistance(point), v.second);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<ItemBase::Ptr> result;
+    for(const auto& entry : sorted)
+    {
+        result.push_back(items.at(entry.second).item);
+    }
+    return result;
+}
+
+bool SpatialIndex::getBoundary(const ItemBase& item, Box& box)
+{
+    update();
+    auto it = items.find(&item);
+    if(it == items.end() || !it->second.indexed)
+    {
+        return false;
+    }
+    box = toBox(it->second.box);
+    return true;
+}
+
+std::size_t SpatialIndex::size()
+{
+    update();
+    return tree.size();
+}
+
+SpatialIndex::RBox SpatialIndex::toRBox(const Box& box)
+{
+    return RBox(Point(box.min().x(), box.min().y(), box.min().z()),
+                Point(box.max().x(), box.max().y(), box.max().z()));
+}
+
+SpatialIndex::Box SpatialIndex::toBox(const RBox& box)
+{
+    const Point& min = box.min_corner();
+    const Point& max = box.max_corner();
+    return Box(Eigen::Vector3d(min.get<0>(), min.get<1>(), min.get<2>()),
+               Eigen::Vector3d(max.get<0>(), max.get<1>(), max.get<2>()));
+}
+
+}}
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/events/GraphEventSubscriber.hpp>
+#include <envire_core/graph/TreeView.hpp>
+#include <envire_core/items/ItemBase.hpp>
+#include <Eigen/Geometry>
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace envire { namespace core
+{
+    class EnvireGraph;
+    class EdgeModifiedEvent;
+
+    /**
+     * An R-tree over the boundaries of all SpatialItems in an EnvireGraph.
+     *
+     * The boundaries are transformed into a reference frame and stored as
+     * axis aligned boxes. The index subscribes to the graph and is updated
+     * incrementally:
+     *  - items are inserted and removed on ItemAdded and ItemRemoved events,
+     *  - an item is refit when contentsChanged() is called on it,
+     *  - the index keeps a TreeView rooted at the reference frame. When an
+     *    edge of the tree is modified or added, the next query re-evaluates
+     *    the transforms of the subtree below that edge only, and refits the
+     *    items of frames whose transform changed. Modified cross edges do
+     *    not affect the index. Removing edges re-evaluates all frames.
+     *
+     * The transforms are evaluated along the TreeView. Items in frames that
+     * are not connected to the reference frame are not part of the index
+     * until a path exists.
+     *
+     * @note Not thread safe. Queries modify the index if edges have changed.
+     */
+    class SpatialIndex : public GraphEventSubscriber
+    {
+    public:
+        using Box = Eigen::AlignedBox<double, 3>;
+
+        /**Creates an index of all spatial items in @p graph, including the
+         * items that exist already. */
+        SpatialIndex(EnvireGraph& graph, const FrameId& referenceFrame);
+        virtual ~SpatialIndex();
+
+        const FrameId& getReferenceFrame() const { return referenceFrame; }
+
+        /**@return all items whose boundary intersects @p box.
+         *         @p box is expressed in the reference frame */
+        std::vector<ItemBase::Ptr> queryBox(const Box& box);
+
+        /**@return all items whose boundary intersects the sphere.
+         *         @p center is expressed in the reference frame */
+        std::vector<ItemBase::Ptr> querySphere(const Eigen::Vector3d& center, const double radius);
+
+        /**@return the @p k items whose boundaries are closest to @p point,
+         *         sorted by distance. Items that contain @p point have
+         *         distance zero. @p point is expressed in the reference frame */
+        std::vector<ItemBase::Ptr> queryNearest(const Eigen::Vector3d& point, const std::size_t k);
+
+        /**Sets @p box to the boundary of @p item in the reference frame.
+         * @return false if @p item is not part of the index */
+        bool getBoundary(const ItemBase& item, Box& box);
+
+        /**@return the number of indexed items */
+        std::size_t size();
+
+        /**Refits the items whose frame transform changed since the last call.
+         * Is called by all queries. Costs O(n) for n frames in the subtrees
+         * below the edges that have been modified since the last call. */
+        void update();
+
+        virtual void notifyGraphEvent(const GraphEvent& event);
+
+    private:
+        using Point = boost::geometry::model::point<double, 3, boost::geometry::cs::cartesian>;
+        using RBox = boost::geometry::model::box<Point>;
+        using Value = std::pair<RBox, const ItemBase*>;
+        using RTree = boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16>>;
+
+        struct FrameEntry
+        {
+            bool reachable; /**<True if a transform to the reference frame exists */
+            Eigen::Affine3d toReference;
+            std::unordered_set<const ItemBase*> items;
+        };
+
+        struct ItemEntry
+        {
+            ItemBase::Ptr item;
+            FrameId frame;
+            bool indexed; /**<True if the item is part of the tree */
+            RBox box; /**<Box in the tree, valid if indexed */
+        };
+
+        void itemAdded(const FrameId& frame, const ItemBase::Ptr& item);
+        /**Marks the subtree below the edge dirty if it is part of the view */
+        void edgeModified(const EdgeModifiedEvent& event);
+        void itemRemoved(const ItemBase::Ptr& item);
+        /**Is connected to the contents changed signal of all indexed items */
+        void itemChanged(ItemBase& item);
+
+        /**Removes @p entry from the tree and inserts it with its current boundary */
+        void refit(ItemEntry& entry);
+
+        /**Evaluates the transform of @p frame to the reference frame along the view */
+        void updateTransform(const FrameId& frame, FrameEntry& entry) const;
+
+        /**Sets the transform of @p entry and refits its items if it changed */
+        void setTransform(FrameEntry& entry, const bool reachable, const Eigen::Affine3d& toReference);
+
+        /**Re-evaluates the transforms of all frames in the subtree below @p root */
+        void updateSubtree(const GraphTraits::vertex_descriptor root);
+
+        /**Subscribes the view to the graph if the reference frame exists.
+         * Clears it if the reference frame has been removed.
+         * @return true if the view has been rebuilt */
+        bool updateView();
+
+        /**Marks the subtree below @p target dirty, is connected to TreeView::edgeAdded */
+        void treeEdgeAdded(const GraphTraits::vertex_descriptor origin, const GraphTraits::vertex_descriptor target);
+
+        static RBox toRBox(const Box& box);
+        static Box toBox(const RBox& box);
+
+        EnvireGraph& graph;
+        const FrameId referenceFrame;
+        RTree tree;
+        std::unordered_map<FrameId, FrameEntry> frames;
+        std::unordered_map<const ItemBase*, ItemEntry> items;
+        /**Tree rooted at the reference frame, is kept up to date by the graph */
+        TreeView view;
+        /**Frames below modified tree edges, their subtrees are re-evaluated by update() */
+        std::unordered_set<FrameId> dirtySubtrees;
+        /**True if all frames have to be re-evaluated, e.g. after edges have been removed */
+        bool transformsDirty;
+    };
+
+}}
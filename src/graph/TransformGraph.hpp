@@ -15,6 +15,7 @@
 #include <envire_core/events/GraphEventPublisher.hpp>
 #include <boost_serialization/BoostTypes.hpp>
 #include <envire_core/items/Transform.hpp>
+#include <envire_core/items/PointTransform.hpp>
 
 
 
@@ -60,6 +61,41 @@ namespace envire { namespace core
          *  @throw UnknownTransformException if the edge between path[i] and path[i+1]
          *                                   does not exist.*/
         const Transform getTransform(const std::shared_ptr<Path> path) const;
+
+        /** Transforms @p count points that are expressed in @p source into
+         *  @p target, i.e. applies getTransform(target, source) to each point.
+         *  The transform is resolved once for the whole array.
+         *  @param in packed xyz triplets
+         *  @param out packed xyz triplets, may be the same array as @p in
+         *  @param threads number of threads to use, 0 means one per core
+         *  @throw UnknownTransformException if the transformation doesn't exist
+         *  @throw UnknownFrameException if @p source or @p target does not exist*/
+        template <class Scalar>
+        void transformPoints(const FrameId& source, const FrameId& target, const Scalar* in,
+                             Scalar* out, const std::size_t count, const unsigned threads = 1) const;
+        /** In place overload for point lists, e.g. base::Pointcloud::points */
+        template <class Scalar, class Alloc>
+        void transformPoints(const FrameId& source, const FrameId& target,
+                             std::vector<Eigen::Matrix<Scalar, 3, 1>, Alloc>& points,
+                             const unsigned threads = 1) const;
+        /** In place overload for matrices that store one point per column */
+        template <class Scalar>
+        void transformPoints(const FrameId& source, const FrameId& target,
+                             Eigen::Matrix<Scalar, 3, Eigen::Dynamic>& points,
+                             const unsigned threads = 1) const;
+
+        /** Like transformPoints() but only applies the rotation */
+        template <class Scalar>
+        void transformNormals(const FrameId& source, const FrameId& target, const Scalar* in,
+                              Scalar* out, const std::size_t count, const unsigned threads = 1) const;
+        template <class Scalar, class Alloc>
+        void transformNormals(const FrameId& source, const FrameId& target,
+                              std::vector<Eigen::Matrix<Scalar, 3, 1>, Alloc>& normals,
+                              const unsigned threads = 1) const;
+        template <class Scalar>
+        void transformNormals(const FrameId& source, const FrameId& target,
+                              Eigen::Matrix<Scalar, 3, Eigen::Dynamic>& normals,
+                              const unsigned threads = 1) const;
         
         /**A convenience wrapper around Base::setEdgeProperty */
         void updateTransform(const vertex_descriptor origin, const vertex_descriptor target,
@@ -83,6 +119,11 @@ namespace envire { namespace core
       using Base::graph;
         
     private:
+        /** @return getTransform(target, source) in the precision of the point kernels */
+        template <class Scalar>
+        Eigen::Transform<Scalar, 3, Eigen::Isometry> getKernelTransform(const FrameId& source,
+                                                                      const FrameId& target) const;
+
         /**Grants access to boost serialization */
         friend class boost::serialization::access;
 
@@ -144,6 +185,76 @@ namespace envire { namespace core
       return getTransform(originVertex, targetVertex);
   }
 
+    template <class F>
+    template <class Scalar>
+    Eigen::Transform<Scalar, 3, Eigen::Isometry> TransformGraph<F>::getKernelTransform(const FrameId& source,
+                                                                                     const FrameId& target) const
+    {
+        if(source == target)
+        {
+            getVertex(source); //throws if the frame does not exist
+            return Eigen::Transform<Scalar, 3, Eigen::Isometry>::Identity();
+        }
+        const Eigen::Affine3d tf = getTransform(target, source).transform.getTransform();
+        return Eigen::Transform<Scalar, 3, Eigen::Isometry>(tf.matrix().template cast<Scalar>());
+    }
+
+    template <class F>
+    template <class Scalar>
+    void TransformGraph<F>::transformPoints(const FrameId& source, const FrameId& target, const Scalar* in,
+                                            Scalar* out, const std::size_t count, const unsigned threads) const
+    {
+        kernels::transformPoints(getKernelTransform<Scalar>(source, target), in, out, count, threads);
+    }
+
+    template <class F>
+    template <class Scalar, class Alloc>
+    void TransformGraph<F>::transformPoints(const FrameId& source, const FrameId& target,
+                                            std::vector<Eigen::Matrix<Scalar, 3, 1>, Alloc>& points,
+                                            const unsigned threads) const
+    {
+        static_assert(sizeof(Eigen::Matrix<Scalar, 3, 1>) == 3 * sizeof(Scalar), "points have to be packed");
+        Scalar* data = points.empty() ? nullptr : points.front().data();
+        transformPoints(source, target, data, data, points.size(), threads);
+    }
+
+    template <class F>
+    template <class Scalar>
+    void TransformGraph<F>::transformPoints(const FrameId& source, const FrameId& target,
+                                            Eigen::Matrix<Scalar, 3, Eigen::Dynamic>& points,
+                                            const unsigned threads) const
+    {
+        transformPoints(source, target, points.data(), points.data(), points.cols(), threads);
+    }
+
+    template <class F>
+    template <class Scalar>
+    void TransformGraph<F>::transformNormals(const FrameId& source, const FrameId& target, const Scalar* in,
+                                             Scalar* out, const std::size_t count, const unsigned threads) const
+    {
+        kernels::transformNormals(getKernelTransform<Scalar>(source, target), in, out, count, threads);
+    }
+
+    template <class F>
+    template <class Scalar, class Alloc>
+    void TransformGraph<F>::transformNormals(const FrameId& source, const FrameId& target,
+                                             std::vector<Eigen::Matrix<Scalar, 3, 1>, Alloc>& normals,
+                                             const unsigned threads) const
+    {
+        static_assert(sizeof(Eigen::Matrix<Scalar, 3, 1>) == 3 * sizeof(Scalar), "normals have to be packed");
+        Scalar* data = normals.empty() ? nullptr : normals.front().data();
+        transformNormals(source, target, data, data, normals.size(), threads);
+    }
+
+    template <class F>
+    template <class Scalar>
+    void TransformGraph<F>::transformNormals(const FrameId& source, const FrameId& target,
+                                             Eigen::Matrix<Scalar, 3, Eigen::Dynamic>& normals,
+                                             const unsigned threads) const
+    {
+        transformNormals(source, target, normals.data(), normals.data(), normals.cols(), threads);
+    }
+
   
     template <class F>
     const Transform TransformGraph<F>::getTransform(const vertex_descriptor originVertex,
@@ -100,3 +100,8 @@ void envire::core::AlignedBoundingBox::clear()
 {
     box.setEmpty();
 }
+
+Eigen::AlignedBox<double,3> AlignedBoundingBox::getAlignedBox() const
+{
+    return box;
+}
@@ -55,6 +55,7 @@ namespace envire { namespace core
         double exteriorDistance(const boost::shared_ptr<BoundingVolume>& bv) const;
         Eigen::Vector3d center() const;
         void clear();
+        Eigen::AlignedBox<double,3> getAlignedBox() const;
 
     };
 
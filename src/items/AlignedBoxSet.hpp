@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef __ENVIRE_CORE_ALIGNED_BOX_SET__
+#define __ENVIRE_CORE_ALIGNED_BOX_SET__
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <vector>
+#include <cassert>
+#include "AlignedBoundingBox.hpp"
+
+namespace envire { namespace core
+{
+
+    /**
+     * A set of axis aligned boxes stored as structure of arrays.
+     *
+     * The bounds of each axis are stored in separate contiguous arrays,
+     * so that the batch tests below compile to packet (SIMD) operations
+     * through Eigen's array expressions. They replace one virtual call per
+     * pair of boxes in AlignedBoundingBox by one pass over all boxes.
+     *
+     * Empty boxes use the representation of Eigen::AlignedBox (min > max)
+     * and never intersect or contain anything.
+     *
+     * @tparam Scalar float or double. float processes twice as many boxes
+     *                per instruction.
+     */
+    template <class Scalar>
+    class AlignedBoxSet
+    {
+    public:
+        typedef Eigen::AlignedBox<Scalar, 3> Box;
+        typedef Eigen::Matrix<Scalar, 3, 1> Vector;
+        /** One value per box */
+        typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> Values;
+        /** One flag per box or point */
+        typedef Eigen::Array<bool, Eigen::Dynamic, 1> Mask;
+        /** A set of points, one point per row. Column major, i.e. each axis is contiguous */
+        typedef Eigen::Array<Scalar, Eigen::Dynamic, 3> PointSet;
+
+        AlignedBoxSet() {}
+        /** Creates a set of @p size empty boxes */
+        explicit AlignedBoxSet(const size_t size) { resize(size); }
+
+        size_t size() const { return minCoords[0].size(); }
+        bool empty() const { return minCoords[0].empty(); }
+
+        /** Resizes the set. New boxes are empty */
+        void resize(const size_t size)
+        {
+            const Box e;
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                minCoords[axis].resize(size, e.min()[axis]);
+                maxCoords[axis].resize(size, e.max()[axis]);
+            }
+        }
+
+        void reserve(const size_t capacity)
+        {
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                minCoords[axis].reserve(capacity);
+                maxCoords[axis].reserve(capacity);
+            }
+        }
+
+        void clear() { resize(0); }
+
+        void push_back(const Box& box)
+        {
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                minCoords[axis].push_back(box.min()[axis]);
+                maxCoords[axis].push_back(box.max()[axis]);
+            }
+        }
+
+        void push_back(const AlignedBoundingBox& box)
+        {
+            push_back(box.getAlignedBox().template cast<Scalar>());
+        }
+
+        void set(const size_t i, const Box& box)
+        {
+            assert(i < size());
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                minCoords[axis][i] = box.min()[axis];
+                maxCoords[axis][i] = box.max()[axis];
+            }
+        }
+
+        Box get(const size_t i) const
+        {
+            assert(i < size());
+            return Box(Vector(minCoords[0][i], minCoords[1][i], minCoords[2][i]),
+                       Vector(maxCoords[0][i], maxCoords[1][i], maxCoords[2][i]));
+        }
+
+        /** Sets @p hits[i] to true if box i intersects @p query.
+         *  Touching boxes intersect. */
+        void intersects(const Box& query, Mask& hits) const
+        {
+            //overlap per axis, negative if the boxes are separated on that axis
+            Values overlap = max(0).min(query.max()[0]) - min(0).max(query.min()[0]);
+            for(int axis = 1; axis < 3; ++axis)
+            {
+                overlap = overlap.min(max(axis).min(query.max()[axis]) - min(axis).max(query.min()[axis]));
+            }
+            hits.resize(size());
+            hits = overlap >= Scalar(0);
+        }
+
+        /** Sets @p hits[i] to true if box i contains @p point */
+        void contains(const Vector& point, Mask& hits) const
+        {
+            hits.resize(size());
+            hits = (min(0) <= point[0]) && (max(0) >= point[0]) &&
+                   (min(1) <= point[1]) && (max(1) >= point[1]) &&
+                   (min(2) <= point[2]) && (max(2) >= point[2]);
+        }
+
+        /** Sets @p distances[i] to the squared distance between @p point and
+         *  box i, 0 if the point is inside. */
+        void squaredExteriorDistance(const Vector& point, Values& distances) const
+        {
+            distances.resize(size());
+            distances.setZero();
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                const Values d = (min(axis) - point[axis]).max(Scalar(0)) +
+                                 (point[axis] - max(axis)).max(Scalar(0));
+                distances += d.square();
+            }
+        }
+
+        /** Sets @p distances[i] to the distance between @p point and box i */
+        void exteriorDistance(const Vector& point, Values& distances) const
+        {
+            squaredExteriorDistance(point, distances);
+            distances = distances.sqrt();
+        }
+
+        /** Sets box i of @p result to the intersection of box i and @p query.
+         *  Boxes that do not intersect @p query become empty as in
+         *  Eigen::AlignedBox::intersection(). */
+        void intersection(const Box& query, AlignedBoxSet& result) const
+        {
+            result.resize(size());
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                result.min(axis) = min(axis).max(query.min()[axis]);
+                result.max(axis) = max(axis).min(query.max()[axis]);
+            }
+        }
+
+        /** Sets @p hits[i] to true if @p box contains point i of @p points */
+        static void contains(const Box& box, const PointSet& points, Mask& hits)
+        {
+            hits.resize(points.rows());
+            hits = (points.col(0) >= box.min()[0]) && (points.col(0) <= box.max()[0]) &&
+                   (points.col(1) >= box.min()[1]) && (points.col(1) <= box.max()[1]) &&
+                   (points.col(2) >= box.min()[2]) && (points.col(2) <= box.max()[2]);
+        }
+
+        /** Sets @p distances[i] to the squared distance between @p box and
+         *  point i of @p points, 0 if the point is inside. */
+        static void squaredExteriorDistance(const Box& box, const PointSet& points, Values& distances)
+        {
+            distances.resize(points.rows());
+            distances.setZero();
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                const Values d = (box.min()[axis] - points.col(axis)).max(Scalar(0)) +
+                                 (points.col(axis) - box.max()[axis]).max(Scalar(0));
+                distances += d.square();
+            }
+        }
+
+        /** @return the lower bounds of all boxes on @p axis */
+        Eigen::Map<const Values> min(const int axis) const { return map(minCoords[axis]); }
+        Eigen::Map<Values> min(const int axis) { return map(minCoords[axis]); }
+        /** @return the upper bounds of all boxes on @p axis */
+        Eigen::Map<const Values> max(const int axis) const { return map(maxCoords[axis]); }
+        Eigen::Map<Values> max(const int axis) { return map(maxCoords[axis]); }
+
+    private:
+        typedef std::vector<Scalar, Eigen::aligned_allocator<Scalar>> Coordinates;
+
+        static Eigen::Map<const Values> map(const Coordinates& c)
+        {
+            return Eigen::Map<const Values>(c.data(), c.size());
+        }
+        static Eigen::Map<Values> map(Coordinates& c)
+        {
+            return Eigen::Map<Values>(c.data(), c.size());
+        }
+
+        Coordinates minCoords[3];
+        Coordinates maxCoords[3];
+    };
+
+    typedef AlignedBoxSet<float> AlignedBoxSetf;
+    typedef AlignedBoxSet<double> AlignedBoxSetd;
+
+}}
+
+#endif
@@ -56,6 +56,10 @@ namespace envire { namespace core
         virtual bool contains(const boost::shared_ptr<BoundingVolume>& bv) const = 0;
         virtual double exteriorDistance(const boost::shared_ptr<BoundingVolume>& bv) const = 0;
         virtual void clear() = 0;
+        /** Returns the axis aligned box that encloses the volume.
+         *  Is used by the SpatialIndex. Returns an empty box by default,
+         *  i.e. volumes that do not override this are not indexed. */
+        virtual Eigen::AlignedBox<double,3> getAlignedBox() const { return Eigen::AlignedBox<double,3>(); }
 
     };
 }}
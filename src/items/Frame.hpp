@@ -29,18 +29,26 @@
 
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/version.hpp>
+#include <boost/serialization/binary_object.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/archive_exception.hpp>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <unordered_map>
 #include <typeindex>
+#include <type_traits>
 #include <glog/logging.h>
     
 #include "ItemBase.hpp"
+#include "ItemTypeMap.hpp"
 #include "RandomGenerator.hpp"
 #include <boost_serialization/BoostTypes.hpp>
 #include <boost_serialization/DynamicSizeSerialization.hpp>
 #include <envire_core/serialization/Serialization.hpp>
+#include <envire_core/serialization/GraphLoadOptions.hpp>
 #include <envire_core/util/Demangle.hpp>
 
 namespace envire { namespace core
@@ -54,8 +62,8 @@ namespace envire { namespace core
     public:
         FrameId id; /** Frame name */
 
-        using ItemList = std::vector<ItemBase::Ptr>;
-        using ItemMap = std::unordered_map<std::type_index, ItemList>;
+        using ItemList = ItemTypeMap::ItemList;
+        using ItemMap = ItemTypeMap;
         //contains all items that have been added to the frame sorted by type
         ItemMap items;
 
@@ -142,17 +150,40 @@ namespace envire { namespace core
         void serialize(Archive & ar, const unsigned int version)
         {
             ar & BOOST_SERIALIZATION_NVP(id);
-            ar & BOOST_SERIALIZATION_NVP(items);
+            const GraphLoadOptions* options = GraphLoadOptions::getCurrent();
+            if(Archive::is_loading::value && options && !options->isFrameSelected(id))
+            {
+                // the frame is removed after loading, its items are skipped
+                GraphLoadOptions::Scope skipItems(GraphLoadOptions::getStructureOnly());
+                ar & BOOST_SERIALIZATION_NVP(items);
+            }
+            else
+                ar & BOOST_SERIALIZATION_NVP(items);
         }
 
     };
 }}
 
-BOOST_CLASS_VERSION(envire::core::Frame::ItemMap, 1)
+/**Version 2 stores the class name once per item list and each item as
+ * length-prefixed record (see Serialization::saveRecord()), thus items of
+ * unknown types can be skipped.
+ * Version 3 embeds text records (see Serialization::saveTextRecord()) in
+ * text based archives, thus their items stay readable and portable.
+ * Binary archives store binary records like version 2. */
+BOOST_CLASS_VERSION(envire::core::Frame::ItemMap, 3)
 
 namespace boost { namespace serialization
 {
 
+    /**Selects binary item records for binary archives and text records for
+     * all other archives */
+    template<class Archive>
+    struct HasBinaryItemRecords : std::false_type {};
+    template<>
+    struct HasBinaryItemRecords<boost::archive::binary_oarchive> : std::true_type {};
+    template<>
+    struct HasBinaryItemRecords<boost::archive::binary_iarchive> : std::true_type {};
+
     /**Serializes envire::core::Frame::ItemMap. Usses envire::core::Serialization
      * to correctly serialize ItemBase types. The type_index is not serialized, since
      * it is provided by each Item */
@@ -180,12 +211,19 @@ namespace boost { namespace serialization
         }
         else
             saveSizeValue(ar, serializable_types);
+        std::vector<uint8_t> record;
+        std::string text_record;
         for(envire::core::Frame::ItemMap::const_iterator it = item_map.begin(); it != item_map.end(); it++)
         {
             if(serializable[std::distance(item_map.begin(), it)])
             {
-                // Store list size
                 const envire::core::Frame::ItemList& item_list = it->second;
+                std::string class_name;
+                item_list.front()->getClassName(class_name);
+                if(version >= 2)
+                    ar << boost::serialization::make_nvp("class_name", class_name);
+
+                // Store list size
                 uint64_t list_size = item_list.size();
                 if(version == 0)
                 {
@@ -197,21 +235,81 @@ namespace boost { namespace serialization
                 for(envire::core::Frame::ItemList::const_iterator it = item_list.begin(); it != item_list.end(); it++)
                 {
                     // Serialize item
-                    if(!envire::core::Serialization::save(ar, *it))
+                    bool saved;
+                    if(version >= 3 && !HasBinaryItemRecords<Archive>::value)
                     {
-                        std::string error_msg = "Failed to serialize an item of type ";
-                        std::string class_name;
-                        if((*it)->getClassName(class_name))
-                            error_msg += class_name;
-                        else
-                            class_name += (*it)->getEmbeddedTypeInfo()->name();
-                        throw std::runtime_error(error_msg);
+                        saved = envire::core::Serialization::saveTextRecord(text_record, *it, class_name);
+                        if(saved)
+                        {
+                            uint64_t record_size = text_record.size();
+                            saveSizeValue(ar, record_size);
+                            ar << boost::serialization::make_nvp("record", text_record);
+                        }
+                    }
+                    else if(version >= 2)
+                    {
+                        saved = envire::core::Serialization::saveRecord(record, *it, class_name);
+                        if(saved)
+                        {
+                            uint64_t record_size = record.size();
+                            saveSizeValue(ar, record_size);
+                            ar << boost::serialization::make_nvp("record", boost::serialization::make_binary_object(record.data(), record.size()));
+                        }
+                    }
+                    else
+                        saved = envire::core::Serialization::save(ar, *it);
+                    if(!saved)
+                    {
+                        throw std::runtime_error("Failed to serialize an item of type " + class_name);
                     }
                 }
             }
         }
     }
 
+    /**Reads an item record of @p size bytes into @p record.
+     * The size is read from the archive and might be corrupted, records
+     * larger than 1 GiB are rejected instead of allocating them.
+     * @throw boost::archive::archive_exception if the record is too large */
+    template<class Archive>
+    inline void loadItemRecord(Archive & ar, std::vector<uint8_t>& record, const uint64_t size)
+    {
+        const uint64_t max_record_size = uint64_t(1) << 30;
+        if(size > max_record_size)
+            throw boost::archive::archive_exception(boost::archive::archive_exception::input_stream_error);
+        record.resize(size);
+        ar >> boost::serialization::make_nvp("record", boost::serialization::make_binary_object(record.data(), record.size()));
+    }
+
+    /**Reads a text record of @p size characters into @p record.
+     * @throw boost::archive::archive_exception if the record is too large
+     *        or does not match its size */
+    template<class Archive>
+    inline void loadItemRecord(Archive & ar, std::string& record, const uint64_t size)
+    {
+        const uint64_t max_record_size = uint64_t(1) << 30;
+        if(size > max_record_size)
+            throw boost::archive::archive_exception(boost::archive::archive_exception::input_stream_error);
+        ar >> boost::serialization::make_nvp("record", record);
+        if(record.size() != size)
+            throw boost::archive::archive_exception(boost::archive::archive_exception::input_stream_error);
+    }
+
+    /**Binary archives store the record as raw bytes, thus it is read in
+     * chunks. A corrupted size fails at the end of the stream without
+     * allocating more memory than the stream contains. */
+    inline void loadItemRecord(boost::archive::binary_iarchive & ar, std::vector<uint8_t>& record, const uint64_t size)
+    {
+        const uint64_t chunk_size = uint64_t(1) << 20;
+        record.clear();
+        while(record.size() < size)
+        {
+            const std::size_t offset = record.size();
+            record.resize(offset + std::min(chunk_size, size - offset));
+            ar.load_binary(record.data() + offset, record.size() - offset);
+        }
+    }
+
     /**Unserializes envire::core::Frame::ItemMap. Uses envire::core::Serialization
      * to correctly unserialize ItemBase types. The type_index is retrieve from the
      * first Item in each ItemList */
@@ -231,10 +329,24 @@ namespace boost { namespace serialization
         }
         else
             loadSizeValue(ar, map_size);
+        // see envire::core::EnvireGraph::loadFromFile()
+        const envire::core::GraphLoadOptions* options = envire::core::GraphLoadOptions::getCurrent();
+        std::vector<uint8_t> record;
+        std::string text_record;
+        std::size_t skipped_types = 0;
         for(std::size_t i = 0; i < map_size; i++)
         {
+            std::string class_name;
+            if(version >= 2)
+                ar >> boost::serialization::make_nvp("class_name", class_name);
+            const bool selected = version < 2 || !options || options->isItemClassSelected(class_name);
+            if(!selected)
+                skipped_types++;
+            const bool loadable = version < 2 || (selected && envire::core::Serialization::isLoadable(class_name));
+
             // Recover list size
             envire::core::Frame::ItemList item_list;
+            bool filtered = false;
             uint64_t list_size;
             if(version == 0)
             {
@@ -246,26 +358,53 @@ namespace boost { namespace serialization
                 loadSizeValue(ar, list_size);
             if(list_size > 0)
             {
-                item_list.reserve(list_size);
+                // the size might be corrupted, the list grows if it is larger
+                item_list.reserve(std::min<uint64_t>(list_size, 1024));
                 for(std::size_t j = 0; j < list_size; j++)
                 {
                     // Unserializes item
                     envire::core::ItemBase::Ptr item;
-                    if(envire::core::Serialization::load(ar, item))
-                        item_list.push_back(item);
+                    if(version >= 3 && !HasBinaryItemRecords<Archive>::value)
+                    {
+                        // the record is skipped if the type is unknown or not selected
+                        uint64_t record_size;
+                        loadSizeValue(ar, record_size);
+                        loadItemRecord(ar, text_record, record_size);
+                        if(loadable && envire::core::Serialization::loadTextRecord(text_record, class_name, item))
+                            item_list.push_back(item);
+                    }
+                    else if(version >= 2)
+                    {
+                        uint64_t record_size;
+                        loadSizeValue(ar, record_size);
+                        loadItemRecord(ar, record, record_size);
+                        if(loadable && envire::core::Serialization::loadRecord(record.data(), record.size(), class_name, item))
+                            item_list.push_back(item);
+                    }
+                    else if(envire::core::Serialization::load(ar, item))
+                    {
+                        // older archives have to decode the item to know its class
+                        if(!options || (item->getClassName(class_name) && options->isItemClassSelected(class_name)))
+                            item_list.push_back(item);
+                        else
+                            filtered = true;
+                    }
                 }
             }
+            // a list that has been dropped by the options is not a failure
+            if(item_list.empty() && filtered)
+                skipped_types++;
 
             if(!item_list.empty())
             {
-                // Insert ItemList in ItemMap by using the type_index of the first element
-                std::pair<std::type_index, envire::core::Frame::ItemList> new_entry(item_list.front()->getTypeIndex(), std::move(item_list));
-                item_map.insert(std::move(new_entry));
+                // Insert ItemList in ItemMap by using the type of the first element
+                const envire::core::ItemBase::Ptr& first = item_list.front();
+                item_map.getOrCreate(first->getTypeIndex(), first->getTypeId()) = std::move(item_list);
             }
         }
 
-        if(item_map.size() < map_size)
-            LOG(ERROR) << "Failed to deserialize all items. All items of " << (map_size-item_map.size()) << " types have been dropped.";
+        if(item_map.size() + skipped_types < map_size)
+            LOG(ERROR) << "Failed to deserialize all items. All items of " << (map_size - skipped_types - item_map.size()) << " types have been dropped.";
     }
 
     /**Splits serialization of envire::core::Frame::ItemMap
@@ -29,8 +29,15 @@
 #include "ItemBase.hpp"
 #include "ItemMetadata.hpp"
 #include "SpatioTemporal.hpp"
+#include "ItemPayload.hpp"
+#include "ItemDataSize.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <utility>
+#include <boost/make_shared.hpp>
+#include <boost/pool/pool_alloc.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/nvp.hpp>
 #include <boost_serialization/BoostTypes.hpp>
@@ -42,6 +49,10 @@ namespace envire { namespace core
     *
     * @Note: The _ItemData type must have a default constructor and
     *        copy operator.
+    *
+    * Copies of an item share large payloads copy-on-write (see ItemPayload).
+    * The payload is detached on the first call to a mutating accessor
+    * (getMutableData(), getRawData()).
     */
     template<class _ItemData>
     class Item : public ItemBase
@@ -51,67 +62,134 @@ namespace envire { namespace core
         typedef _ItemData TemplateType;
 
     protected:
-        SpatioTemporal<_ItemData> spatio_temporal_data;
+        SpatioTemporal<ItemPayload<_ItemData>> spatio_temporal_data;
+
+    private:
+        /**State of the uuid, see ItemBase::setLazyIDs() */
+        enum IDState : std::uint8_t
+        {
+            ID_READY,
+            ID_PENDING,
+            ID_GENERATING
+        };
+        mutable std::atomic<std::uint8_t> id_state;
 
     public:
 
-        Item() : ItemBase()
+        Item() : ItemBase(), id_state(ID_READY)
         {
             spatio_temporal_data.time = base::Time::now();
-            spatio_temporal_data.uuid = SpatioTemporal<_ItemData>::generateNewUUID();
+            initID();
         }
 
-        Item(const _ItemData& data) : ItemBase(), spatio_temporal_data(data)
+        Item(const _ItemData& data) : ItemBase(), spatio_temporal_data(ItemPayload<_ItemData>(data)), id_state(ID_READY)
         {
             spatio_temporal_data.time = base::Time::now();
-            spatio_temporal_data.uuid = SpatioTemporal<_ItemData>::generateNewUUID();
+            initID();
         }
 
-        Item(const Item<_ItemData>& item) : ItemBase(item)
+        Item(_ItemData&& data) : ItemBase(), spatio_temporal_data(ItemPayload<_ItemData>(std::move(data))), id_state(ID_READY)
+        {
+            spatio_temporal_data.time = base::Time::now();
+            initID();
+        }
+
+        /**Creates an item with the given timestamp and frame.
+         * Does not read the clock, use this when the time is known already
+         * (e.g. the timestamp of a sensor sample). */
+        Item(const _ItemData& data, const base::Time& time, const FrameId& frame = FrameId()) :
+            ItemBase(), spatio_temporal_data(ItemPayload<_ItemData>(data)), id_state(ID_READY)
+        {
+            spatio_temporal_data.time = time;
+            spatio_temporal_data.frame_id = frame;
+            initID();
+        }
+
+        /**Same as above but moves @p data into the item */
+        Item(_ItemData&& data, const base::Time& time, const FrameId& frame = FrameId()) :
+            ItemBase(), spatio_temporal_data(ItemPayload<_ItemData>(std::move(data))), id_state(ID_READY)
+        {
+            spatio_temporal_data.time = time;
+            spatio_temporal_data.frame_id = frame;
+            initID();
+        }
+
+        Item(const Item<_ItemData>& item) : ItemBase(item),
+            spatio_temporal_data(item.residentPayload()), id_state(ID_READY)
         {
             spatio_temporal_data.time = item.spatio_temporal_data.time;
-            spatio_temporal_data.uuid = item.spatio_temporal_data.uuid;
+            spatio_temporal_data.uuid = item.getID();
             spatio_temporal_data.frame_id = item.spatio_temporal_data.frame_id;
-            spatio_temporal_data.data = item.spatio_temporal_data.data;
         }
 
-        Item(Item<_ItemData>&& item) : ItemBase(std::move(item))
+        Item(Item<_ItemData>&& item) : ItemBase(std::move(item)),
+            spatio_temporal_data(std::move(item.residentPayload())), id_state(ID_READY)
         {
             spatio_temporal_data.time = std::move(item.spatio_temporal_data.time);
-            spatio_temporal_data.uuid = std::move(item.spatio_temporal_data.uuid);
+            spatio_temporal_data.uuid = item.getID();
             spatio_temporal_data.frame_id = std::move(item.spatio_temporal_data.frame_id);
-            spatio_temporal_data.data = std::move(item.spatio_temporal_data.data);
         }
 
         //https://stackoverflow.com/questions/12255546/c-deep-copying-a-base-class-pointer
         virtual ItemBase::Ptr clone() const {
-            //has to use this constructor, derived items need default constructor otherwise
-            ItemBase::Ptr ptr = ItemBase::Ptr(new Item<_ItemData>(this->getData()));
-            ptr->setTime(this->getTime());
-            ptr->setID(this->getID());
-            ptr->setFrame(this->getFrame());
-            return ptr;
+            //shares the data copy-on-write
+            return boost::make_shared<Item<_ItemData>>(*this);
         }
 
         virtual ~Item() {}
 
+        /**@brief create
+        *
+        * Creates a new item. The item and its reference count are placed in
+        * a single allocation. @p args are forwarded to the constructor, e.g.
+        * create(std::move(data), time, frame) moves the payload into the item
+        * and does not read the clock.
+        *
+        */
+        template <class... Args>
+        static Ptr create(Args&&... args)
+        {
+            return boost::make_shared<Item<_ItemData>>(std::forward<Args>(args)...);
+        }
+
+        /**@brief createPooled
+        *
+        * Same as create() but the memory is taken from a pool that is shared
+        * by all allocations of the same size. Destroyed items return their
+        * memory to the pool, where it is reused by the next item. Use this
+        * for small items that are created and destroyed at a high rate
+        * (e.g. poses or imu samples). The pool is thread safe. It never
+        * returns memory to the system.
+        *
+        */
+        template <class... Args>
+        static Ptr createPooled(Args&&... args)
+        {
+            return boost::allocate_shared<Item<_ItemData>>(boost::fast_pool_allocator<Item<_ItemData>>(),
+                                                           std::forward<Args>(args)...);
+        }
+
         Item<_ItemData>& operator=(const Item<_ItemData>& item)
         {
             ItemBase::operator=(item);
+            ensureDataResident();
             spatio_temporal_data.time = item.spatio_temporal_data.time;
-            spatio_temporal_data.uuid = item.spatio_temporal_data.uuid;
+            spatio_temporal_data.uuid = item.getID();
+            id_state.store(ID_READY, std::memory_order_release);
             spatio_temporal_data.frame_id = item.spatio_temporal_data.frame_id;
-            spatio_temporal_data.data = item.spatio_temporal_data.data;
+            spatio_temporal_data.data = item.residentPayload();
             return *this;
         }
 
         Item<_ItemData>& operator=(Item<_ItemData>&& item)
         {
             ItemBase::operator=(std::move(item));
+            ensureDataResident();
             spatio_temporal_data.time = std::move(item.spatio_temporal_data.time);
-            spatio_temporal_data.uuid = std::move(item.spatio_temporal_data.uuid);
+            spatio_temporal_data.uuid = item.getID();
+            id_state.store(ID_READY, std::memory_order_release);
             spatio_temporal_data.frame_id = std::move(item.spatio_temporal_data.frame_id);
-            spatio_temporal_data.data = std::move(item.spatio_temporal_data.data);
+            spatio_temporal_data.data = std::move(item.residentPayload());
             return *this;
         }
 
@@ -134,14 +212,26 @@ namespace envire { namespace core
         * Sets the unique identifier of the item
         *
         */
-        virtual void setID(const boost::uuids::uuid& id) { this->spatio_temporal_data.uuid = id; }
+        virtual void setID(const boost::uuids::uuid& id)
+        {
+            this->spatio_temporal_data.uuid = id;
+            id_state.store(ID_READY, std::memory_order_release);
+        }
 
         /**@brief getID
         *TARGET
-        * Returns the unique identifier of the item
+        * Returns the unique identifier of the item.
+        * Generates the identifier of lazy items (see ItemBase::setLazyIDs())
         *
         */
-        virtual const boost::uuids::uuid& getID() const { return this->spatio_temporal_data.uuid; }
+        virtual const boost::uuids::uuid& getID() const
+        {
+            if(id_state.load(std::memory_order_acquire) != ID_READY)
+            {
+                materializeID();
+            }
+            return this->spatio_temporal_data.uuid;
+        }
 
         /**@brief setFrame
         *
@@ -162,19 +252,74 @@ namespace envire { namespace core
         * Sets the user data
         *
         */
-        void setData(const _ItemData& data) { this->spatio_temporal_data.data = data; }
-        void setData(_ItemData&& data) { this->spatio_temporal_data.data = std::move(data); }
+        void setData(const _ItemData& data) { ensureDataResident(); this->spatio_temporal_data.data.set(data); }
+        void setData(_ItemData&& data) { ensureDataResident(); this->spatio_temporal_data.data.set(std::move(data)); }
+
+        /**@brief getData
+        *
+        * Returns the user data for reading. Never copies the data, also not
+        * if it is shared with a copy of this item. Restores the data if it
+        * has been released (see ItemBase::releaseData()).
+        *
+        */
+        const _ItemData& getData() const { return residentPayload().get(); }
+
+        /**@brief getMutableData
+        *
+        * Returns the user data for writing. Detaches the data by copying it
+        * if it is shared with a copy of this item. Restores the data if it
+        * has been released (see ItemBase::releaseData()).
+        *
+        * @warning The reference must not be used anymore after the item has
+        *          been copied, because the copy would see the modifications.
+        * @note Reading items concurrently is thread safe, also if they share
+        *       their data. Writing to an item requires exclusive access to
+        *       that item, like any other modification.
+        *
+        */
+        _ItemData& getMutableData() { return residentPayload().getMutable(); }
 
         /**@brief getData
         *
-        * Returns the user data
+        * Returns the user data of a non-const item without detaching it.
+        * Small payloads that are stored inline (see ItemPayloadIsShared) are
+        * returned for writing, because they are never shared. Payloads that
+        * are shared copy-on-write are returned for reading only, use
+        * getMutableData() to write them.
         *
         */
-        _ItemData& getData() { return this->spatio_temporal_data.data; }
-        const _ItemData& getData() const { return this->spatio_temporal_data.data; }
+        typename ItemPayload<_ItemData>::InPlaceReference getData() { return residentPayload().getInPlace(); }
+
+        /**@return true if the user data is shared with a copy of this item */
+        bool isDataShared() const { return this->spatio_temporal_data.data.isShared(); }
 
+        virtual bool hasReleasableData() const { return ItemPayloadIsShared<_ItemData>::value; }
+
+        virtual bool canReleaseData() const
+        {
+            return hasReleasableData() && isDataResident() && !isDataShared();
+        }
 
-        envire::core::SpatioTemporal<_ItemData>& asSpatioTemporal() {return spatio_temporal_data;}
+
+        /**@return a copy of the item as SpatioTemporal.
+         * @note The data is shared copy-on-write and cannot be exposed as
+         *       SpatioTemporal<_ItemData>&, use the setters to modify the item */
+        envire::core::SpatioTemporal<_ItemData> toSpatioTemporal() const
+        {
+            envire::core::SpatioTemporal<_ItemData> result(getData());
+            result.time = spatio_temporal_data.time;
+            result.uuid = getID();
+            result.frame_id = spatio_temporal_data.frame_id;
+            return result;
+        }
+
+        /**@deprecated use toSpatioTemporal() instead. Returns a const copy,
+         *             the item cannot be modified through it anymore */
+        [[deprecated("returns a copy, use toSpatioTemporal() and the setters")]]
+        const envire::core::SpatioTemporal<_ItemData> asSpatioTemporal() const
+        {
+            return toSpatioTemporal();
+        }
 
 
         virtual bool getClassName(std::string& class_name) const
@@ -202,14 +347,100 @@ namespace envire { namespace core
           return &typeid(envire::core::Item<_ItemData>);
         }
         
+        virtual ItemTypeId getTypeId() const
+        {
+          return getItemTypeId<envire::core::Item<_ItemData>>();
+        }
+        
         virtual const std::type_info* getEmbeddedTypeInfo() const
         {
           return &typeid(_ItemData);
         }
 
-        virtual void* getRawData() { return &spatio_temporal_data.data; }
+        virtual void* getRawData() { return &residentPayload().getMutable(); }
+
+        /**@return the estimate of ItemDataSize<_ItemData>, 0 if the data has been released */
+        virtual std::size_t getDataSize() const
+        {
+            return isDataResident() ? ItemDataSize<_ItemData>::get(spatio_temporal_data.data.get()) : 0;
+        }
+
+        virtual std::size_t getMemoryUsage() const
+        {
+            std::size_t bytes = sizeof(*this) + getDataSize() +
+                                ItemDataSize<std::string>::get(spatio_temporal_data.frame_id) - sizeof(std::string);
+            if(!ItemPayloadIsShared<_ItemData>::value)
+            {
+                //the data is stored inside the item
+                bytes -= std::min(bytes, sizeof(_ItemData));
+            }
+            return bytes;
+        }
+
+        virtual void adoptData(ItemBase& other)
+        {
+            assert(dynamic_cast<Item<_ItemData>*>(&other));
+            //shares the data of the loaded item instead of moving it, a move
+            //would allocate a new default payload for @p other
+            spatio_temporal_data.data = static_cast<Item<_ItemData>&>(other).residentPayload();
+        }
+
+    protected:
+        virtual bool releasePayload() { return spatio_temporal_data.data.release(); }
+        virtual void resetPayload() { spatio_temporal_data.data = ItemPayload<_ItemData>(); }
+
+        /**@deprecated compatibility accessors for derived items that used to
+         *             access spatio_temporal_data.data directly. The member
+         *             stores an ItemPayload now. */
+        [[deprecated("use getData() or getMutableData()")]]
+        _ItemData& itemData() { return getMutableData(); }
+        [[deprecated("use getData()")]]
+        const _ItemData& itemData() const { return getData(); }
 
     private:
+        const ItemPayload<_ItemData>& residentPayload() const
+        {
+            ensureDataResident();
+            return spatio_temporal_data.data;
+        }
+
+        ItemPayload<_ItemData>& residentPayload()
+        {
+            ensureDataResident();
+            return spatio_temporal_data.data;
+        }
+
+        void initID()
+        {
+            if(ItemBase::hasLazyIDs())
+            {
+                id_state.store(ID_PENDING, std::memory_order_relaxed);
+            }
+            else
+            {
+                spatio_temporal_data.uuid = SpatioTemporal<_ItemData>::generateNewUUID();
+            }
+        }
+
+        /**Generates the uuid of a lazy item. The first caller generates the
+         * id, concurrent callers wait until it is available. */
+        void materializeID() const
+        {
+            std::uint8_t expected = ID_PENDING;
+            if(id_state.compare_exchange_strong(expected, ID_GENERATING, std::memory_order_acquire))
+            {
+                const_cast<boost::uuids::uuid&>(spatio_temporal_data.uuid) = SpatioTemporal<_ItemData>::generateNewUUID();
+                id_state.store(ID_READY, std::memory_order_release);
+            }
+            else
+            {
+                while(id_state.load(std::memory_order_acquire) != ID_READY)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
         /**Grants access to boost serialization */
         friend class boost::serialization::access;
 
@@ -219,9 +450,26 @@ namespace envire { namespace core
         {
             ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(envire::core::ItemBase);
             ar & boost::serialization::make_nvp("time", spatio_temporal_data.time.microseconds);
+            if(Archive::is_saving::value)
+            {
+                getID();
+            }
             ar & boost::serialization::make_nvp("uuid", spatio_temporal_data.uuid);
+            if(Archive::is_loading::value)
+            {
+                id_state.store(ID_READY, std::memory_order_release);
+            }
             ar & boost::serialization::make_nvp("frame_name", spatio_temporal_data.frame_id);
-            ar & boost::serialization::make_nvp("user_data", spatio_temporal_data.data);
+            ensureDataResident();
+            if(Archive::is_saving::value)
+            {
+                //saving does not modify the data, thus there is no need to detach it
+                ar & boost::serialization::make_nvp("user_data", const_cast<_ItemData&>(spatio_temporal_data.data.get()));
+            }
+            else
+            {
+                ar & boost::serialization::make_nvp("user_data", spatio_temporal_data.data.getMutable());
+            }
         }
 
     };
@@ -27,21 +27,45 @@
 #include "ItemBase.hpp"
 #include "RandomGenerator.hpp"
 #define BOOST_SERIALIZATION_DYN_LINK 1
+#include <atomic>
+#include <thread>
 
 using namespace envire::core;
 
-ItemBase::ItemBase()
+namespace
 {
+    std::atomic<bool> lazyIDs(false);
+    
+    /**Marks items whose data is being restored by another thread */
+    class RestoringDataSource : public ItemDataSource
+    {
+    public:
+        virtual void restoreData(ItemBase& item) {}
+    } restoring;
 }
 
-ItemBase::ItemBase(const ItemBase& item)
+std::atomic<unsigned> ItemBase::accessTrackers(0);
+
+ItemBase::ItemBase() : itemContentsChanged(nullptr), version(0),
+    dataSource(nullptr), accessed(false)
+{
+}
+
+ItemBase::ItemBase(const ItemBase& item) : itemContentsChanged(nullptr), version(item.getVersion()),
+    dataSource(nullptr), accessed(false)
 {
 }
 
-ItemBase::ItemBase(ItemBase&& item)
+ItemBase::ItemBase(ItemBase&& item) : itemContentsChanged(nullptr), version(item.getVersion()),
+    dataSource(nullptr), accessed(false)
 {
 }
 
+ItemBase::~ItemBase()
+{
+    delete itemContentsChanged.load(std::memory_order_acquire);
+}
+
 ItemBase& ItemBase::operator=(const ItemBase& item)
 {
     return *this;
@@ -60,8 +84,113 @@ std::string ItemBase::getClassName() const
     return "UnknownItem";
 }
 
+void ItemBase::setLazyIDs(const bool lazy)
+{
+    lazyIDs.store(lazy, std::memory_order_relaxed);
+}
+
+bool ItemBase::hasLazyIDs()
+{
+    return lazyIDs.load(std::memory_order_relaxed);
+}
+
 void ItemBase::contentsChanged(){
-    itemContentsChanged(*this);
+    version.fetch_add(1, std::memory_order_acq_rel);
+    ContentsChangedSignal* signal = itemContentsChanged.load(std::memory_order_acquire);
+    if(signal)
+    {
+        (*signal)(*this);
+    }
+}
+
+bool ItemBase::releaseData(ItemDataSource* source)
+{
+    assert(source);
+    if(!isDataResident() || !releasePayload())
+    {
+        return false;
+    }
+    dataSource.store(source, std::memory_order_release);
+    return true;
+}
+
+void ItemBase::restoreData() const
+{
+    ItemDataSource* source = dataSource.load(std::memory_order_acquire);
+    while(source)
+    {
+        if(source == &restoring)
+        {
+            //another thread restores the data
+            std::this_thread::yield();
+            source = dataSource.load(std::memory_order_acquire);
+        }
+        else if(dataSource.compare_exchange_weak(source, &restoring, std::memory_order_acquire))
+        {
+            try
+            {
+                source->restoreData(const_cast<ItemBase&>(*this));
+            }
+            catch(...)
+            {
+                dataSource.store(source, std::memory_order_release);
+                throw;
+            }
+            dataSource.store(nullptr, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+bool ItemBase::discardReleasedData()
+{
+    ItemDataSource* source = dataSource.load(std::memory_order_acquire);
+    while(source)
+    {
+        if(source == &restoring)
+        {
+            //another thread restores the data
+            std::this_thread::yield();
+            source = dataSource.load(std::memory_order_acquire);
+        }
+        else if(dataSource.compare_exchange_weak(source, &restoring, std::memory_order_acquire))
+        {
+            resetPayload();
+            dataSource.store(nullptr, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ItemBase::enableAccessTracking()
+{
+    accessTrackers.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ItemBase::disableAccessTracking()
+{
+    assert(accessTrackers.load(std::memory_order_relaxed) > 0);
+    accessTrackers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+ItemBase::ContentsChangedSignal& ItemBase::getContentsChangedSignal()
+{
+    ContentsChangedSignal* signal = itemContentsChanged.load(std::memory_order_acquire);
+    if(!signal)
+    {
+        //several threads may connect at the same time, only one signal wins
+        ContentsChangedSignal* created = new ContentsChangedSignal();
+        if(itemContentsChanged.compare_exchange_strong(signal, created, std::memory_order_acq_rel))
+        {
+            signal = created;
+        }
+        else
+        {
+            delete created;
+        }
+    }
+    return *signal;
 }
 
 BOOST_CLASS_EXPORT(envire::core::ItemBase)
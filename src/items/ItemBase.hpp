@@ -34,13 +34,31 @@
 #include <boost/serialization/export.hpp>
 #include <boost/signals2.hpp>
 #include <base/Time.hpp>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <string>
 #include <type_traits>
 #include <typeindex>
+#include "ItemTypeId.hpp"
 
 namespace envire { namespace core
 {
     using FrameId = std::string;
+    
+    class ItemBase;
+    
+    /**Restores the data of items that has been released using
+     * ItemBase::releaseData(), e.g. by reading it from disk (see ItemSpillStore) */
+    class ItemDataSource
+    {
+    public:
+        virtual ~ItemDataSource() {}
+        /**Restores the data of @p item using ItemBase::adoptData().
+         * Is called at most once per release, but may be called concurrently
+         * for different items, thus implementations have to lock their state. */
+        virtual void restoreData(ItemBase& item) = 0;
+    };
 
     /**@class ItemBase
     *
@@ -58,7 +76,7 @@ namespace envire { namespace core
         ItemBase();
         ItemBase(const ItemBase& item);
         ItemBase(ItemBase&& item);
-        virtual ~ItemBase() {}
+        virtual ~ItemBase();
         virtual ItemBase::Ptr clone() const = 0;
 
         ItemBase& operator=(const ItemBase& item);
@@ -93,6 +111,18 @@ namespace envire { namespace core
         virtual const boost::uuids::uuid& getID() const = 0;
         const std::string getIDString() const { return boost::uuids::to_string(this->getID()); }
 
+        /**@brief setLazyIDs
+        *
+        * Enables or disables lazy ids for all items that are created afterwards.
+        * The uuid of a lazy item is generated when getID() is called for the
+        * first time instead of in the constructor. Items that are never
+        * identified (e.g. never added to a graph) do not pay for their id.
+        * Disabled by default.
+        *
+        */
+        static void setLazyIDs(const bool lazy);
+        static bool hasLazyIDs();
+
         /**@brief setFrame
         *
         * Sets the frame name of the item
@@ -122,6 +152,12 @@ namespace envire { namespace core
           return std::type_index(*getTypeInfo());
         }
         
+        /**Returns the dense id of the item type (see getItemTypeId()) */
+        virtual ItemTypeId getTypeId() const
+        {
+          return getItemTypeId(getTypeIndex());
+        }
+        
         /**Returns the data type of the embedded data*/
         std::type_index getEmbeddedTypeIndex() const
         {
@@ -138,10 +174,68 @@ namespace envire { namespace core
 
         /** Returns a raw pointer to the data of an Item */
         virtual void* getRawData() { return NULL; }
+
+        /** Returns an estimate of the memory used by the data of an Item in bytes,
+         *  see ItemDataSize. Is used to enforce EnvireGraph::RetentionPolicy::maxBytes */
+        virtual std::size_t getDataSize() const { return 0; }
+        
+        /** Returns an estimate of the memory used by the whole item, i.e. the
+         *  object, its metadata and getDataSize(). Data that is shared
+         *  copy-on-write is counted by every item that shares it. */
+        virtual std::size_t getMemoryUsage() const { return sizeof(ItemBase) + getDataSize(); }
+        
+        /** Frees the data of the item. The data is restored by @p source on
+         *  the next access (e.g. getData()).
+         *  @return false if the data cannot be freed because it is stored
+         *          inline or shared with another item */
+        bool releaseData(ItemDataSource* source);
+        
+        /** Returns false if the data of this item type can never be released,
+         *  because it is stored inline (see ItemPayloadIsShared) */
+        virtual bool hasReleasableData() const { return false; }
+        
+        /** Returns true if releaseData() would free the data now, i.e. the data
+         *  is resident, releasable and not shared with a copy of the item */
+        virtual bool canReleaseData() const { return false; }
+        
+        /** Returns false if the data has been released and not been restored yet */
+        bool isDataResident() const { return dataSource.load(std::memory_order_acquire) == nullptr; }
         
-        /** Emits the itemContentsChanged event */
+        /** Restores the data immediately if it has been released.
+         *  If several threads access a released item at the same time, the
+         *  first one restores the data and the others wait for it. */
+        void restoreData() const;
+        
+        /** Detaches released data from its source without restoring it. The
+         *  item holds default constructed data afterwards. Is used by sources
+         *  that are destroyed while the data of an item cannot be restored.
+         *  @return true if the data had been released */
+        bool discardReleasedData();
+        
+        /** Moves the data of @p other into this item. @p other has to be of
+         *  the same type. Is used by ItemDataSource to restore released data */
+        virtual void adoptData(ItemBase& other) {}
+        
+        /** Returns true if the data has been accessed since the last call.
+         *  Can be used to approximate least recently used items. Accesses are
+         *  only recorded while access tracking is enabled. */
+        bool testAndClearAccessed() { return accessed.exchange(false, std::memory_order_relaxed); }
+        
+        /** Enables the recording of data accesses for testAndClearAccessed().
+         *  Calls are counted, every call has to be matched by a call to
+         *  disableAccessTracking(). Tracking is disabled by default, thus
+         *  data accesses cost a single load if nobody needs it. */
+        static void enableAccessTracking();
+        static void disableAccessTracking();
+        
+        /** Increments the version and emits the contents changed signal.
+         *  Is nearly free if no callback is connected. */
         void contentsChanged();
         
+        /** Returns the number of contentsChanged() calls on this item.
+         *  Can be polled to detect changes without connecting a callback.*/
+        std::uint64_t getVersion() const { return version.load(std::memory_order_acquire); }
+        
         /**
          * registeres a changed callback function ponter
          * @warning to receive callbacks, the contentsChanged() method must be called manually to emit the signal
@@ -151,10 +245,11 @@ namespace envire { namespace core
          * e.g.  connectContentsChangedCallback([&reactor](const ItemBase& item){reactor.frame=item.getFrame();reactor.called=true;});
          * connectContentsChangedCallback(boost::bind(&ItemContentReactor::cb, &reactor,  _1));
          * @warning Lambda functions cannot be disconnected.
+         * @note The signal is allocated when the first callback is connected
          * 
          */
         template<class CALLBACK> void connectContentsChangedCallback(const CALLBACK &callback){
-            itemContentsChanged.connect(callback);
+            getContentsChangedSignal().connect(callback);
         }
         
         /**
@@ -163,7 +258,11 @@ namespace envire { namespace core
          * @param callback the function to call on change compatible with boost signale (using functor objects or boost::bind)
          */
         template<class CALLBACK> void disconnectContentsChangedCallback(const CALLBACK &callback){
-            itemContentsChanged.disconnect(callback);
+            ContentsChangedSignal* signal = itemContentsChanged.load(std::memory_order_acquire);
+            if(signal)
+            {
+                signal->disconnect(callback);
+            }
         }
 
     private:
@@ -176,21 +275,61 @@ namespace envire { namespace core
         {
         }
         
-        /** This signal can be manually emitted to notify about the change */
-        boost::signals2::signal<void (ItemBase& item)> itemContentsChanged;
+        using ContentsChangedSignal = boost::signals2::signal<void (ItemBase& item)>;
+        
+        /**Returns the signal, creates it if it does not exist yet */
+        ContentsChangedSignal& getContentsChangedSignal();
+        
+        /** Is emitted by contentsChanged(). Null until a callback is connected */
+        std::atomic<ContentsChangedSignal*> itemContentsChanged;
+        
+        /** Number of contentsChanged() calls */
+        std::atomic<std::uint64_t> version;
+        
+        /** Restores the data if it has been released. Is null while the data is resident */
+        mutable std::atomic<ItemDataSource*> dataSource;
+        
+        /** Is set by every data access while access tracking is enabled, see testAndClearAccessed() */
+        mutable std::atomic<bool> accessed;
+        
+        /** Number of enableAccessTracking() calls without matching disableAccessTracking() */
+        static std::atomic<unsigned> accessTrackers;
+        
+    protected:
+        /** Has to be called before the data of the item is accessed.
+         *  Restores released data and marks the item as accessed if access
+         *  tracking is enabled */
+        void ensureDataResident() const
+        {
+            if(dataSource.load(std::memory_order_acquire))
+                restoreData();
+            if(accessTrackers.load(std::memory_order_relaxed) != 0 && !accessed.load(std::memory_order_relaxed))
+                accessed.store(true, std::memory_order_relaxed);
+        }
+        
+        /** Frees the data, see releaseData() */
+        virtual bool releasePayload() { return false; }
+        
+        /** Replaces the released data by default constructed data, see discardReleasedData() */
+        virtual void resetPayload() {}
         
     };
 
     /**Mark this class as abstract class */
     BOOST_SERIALIZATION_ASSUME_ABSTRACT(envire::core::ItemBase);
     
+    /**Casts the items of an item list to @p TARGET.
+     * The lists in a Frame are selected by the exact type of the items,
+     * thus a static cast is sufficient. It does not touch the reference count. */
     template <class TARGET>
     struct ItemBaseCaster 
     {
-        TARGET& operator()(const ItemBase::Ptr p) const
+        static_assert(std::is_base_of<ItemBase, TARGET>::value, "TARGET has to derive from ItemBase");
+
+        TARGET& operator()(const ItemBase::Ptr& p) const
         {
-            //FIXME static_assert that TARGET is ItemBase::PtrType<X>
-            return *(boost::dynamic_pointer_cast<TARGET>(p));
+            assert(dynamic_cast<TARGET*>(p.get()) != nullptr);
+            return static_cast<TARGET&>(*p);
         }
     };
 }}
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Core>
+
+namespace envire { namespace core
+{
+    /**Estimates the memory used by the user data of an Item<T> in bytes,
+     * including the heap memory that is owned by the data.
+     *
+     * The default returns sizeof(T), which is exact for types that do not
+     * own heap memory. Specialize this for other types, e.g.
+     *
+     *   template <>
+     *   struct ItemDataSize<MyCloud>
+     *   {
+     *       static std::size_t get(const MyCloud& c)
+     *       {
+     *           return sizeof(MyCloud) + c.points.capacity() * sizeof(c.points[0]);
+     *       }
+     *   };
+     *
+     * The estimate is used by the retention policies, the spill store and
+     * the memory report of EnvireGraph. */
+    template <class T, class Enable = void>
+    struct ItemDataSize
+    {
+        static std::size_t get(const T& data) { return sizeof(T); }
+    };
+
+    template <class Char, class Traits, class Alloc>
+    struct ItemDataSize<std::basic_string<Char, Traits, Alloc>>
+    {
+        using String = std::basic_string<Char, Traits, Alloc>;
+        static std::size_t get(const String& data)
+        {
+            //short strings are stored inside the object
+            const char* begin = reinterpret_cast<const char*>(&data);
+            const char* chars = reinterpret_cast<const char*>(data.data());
+            const bool local = chars >= begin && chars < begin + sizeof(String);
+            return sizeof(String) + (local ? 0 : (data.capacity() + 1) * sizeof(Char));
+        }
+    };
+
+    template <class T, class Alloc>
+    struct ItemDataSize<std::vector<T, Alloc>>
+    {
+        static std::size_t get(const std::vector<T, Alloc>& data)
+        {
+            std::size_t bytes = sizeof(data) + data.capacity() * sizeof(T);
+            if(!std::is_trivially_copyable<T>::value)
+            {
+                //elements that own heap memory, e.g. strings
+                for(const T& element : data)
+                {
+                    bytes += ItemDataSize<T>::get(element) - sizeof(T);
+                }
+            }
+            return bytes;
+        }
+    };
+
+    template <class Scalar, int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+    struct ItemDataSize<Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>>
+    {
+        using Matrix = Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>;
+        static std::size_t get(const Matrix& data)
+        {
+            const bool dynamic = Rows == Eigen::Dynamic || Cols == Eigen::Dynamic;
+            return sizeof(Matrix) + (dynamic ? data.size() * sizeof(Scalar) : 0);
+        }
+    };
+}}
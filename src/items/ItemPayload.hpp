@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <Eigen/Geometry>
+
+namespace envire { namespace core
+{
+    /**Marks payloads that do not own any resources and thus can be copied
+     * by copying their bytes, although they might not be trivially copyable.
+     * This holds for trivially copyable types and for fixed size Eigen types.
+     * Specialize this for other types, e.g. structs of Eigen members. */
+    template <class T>
+    struct ItemPayloadIsCheapToCopy : std::is_trivially_copyable<T> {};
+
+    template <class S, int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+    struct ItemPayloadIsCheapToCopy<Eigen::Matrix<S, Rows, Cols, Options, MaxRows, MaxCols>> :
+        std::integral_constant<bool, Rows != Eigen::Dynamic && Cols != Eigen::Dynamic &&
+                                     std::is_arithmetic<S>::value> {};
+
+    template <class S, int Options>
+    struct ItemPayloadIsCheapToCopy<Eigen::Quaternion<S, Options>> : std::is_arithmetic<S> {};
+
+    template <class S>
+    struct ItemPayloadIsCheapToCopy<Eigen::AngleAxis<S>> : std::is_arithmetic<S> {};
+
+    template <class S, int Dim, int Mode, int Options>
+    struct ItemPayloadIsCheapToCopy<Eigen::Transform<S, Dim, Mode, Options>> :
+        std::integral_constant<bool, Dim != Eigen::Dynamic && std::is_arithmetic<S>::value> {};
+
+    template <class S, int Dim>
+    struct ItemPayloadIsCheapToCopy<Eigen::Translation<S, Dim>> :
+        std::integral_constant<bool, Dim != Eigen::Dynamic && std::is_arithmetic<S>::value> {};
+
+    template <class S, int Dim>
+    struct ItemPayloadIsCheapToCopy<Eigen::AlignedBox<S, Dim>> :
+        std::integral_constant<bool, Dim != Eigen::Dynamic && std::is_arithmetic<S>::value> {};
+
+    /**Decides whether the payload of Item<T> is shared copy-on-write.
+     * Small payloads that are cheap to copy (e.g. poses, Eigen::Affine3d) are
+     * cheaper to copy than to share and are stored inline, without an extra
+     * allocation. Specialize this for a type to force either storage. */
+    template <class T>
+    struct ItemPayloadIsShared : std::integral_constant<bool,
+        !(ItemPayloadIsCheapToCopy<T>::value && sizeof(T) <= 128)> {};
+
+    /**Storage of the user data of an Item.
+     * 
+     * The shared variant implements copy-on-write: copies share the payload
+     * and the first call to getMutable() on a shared payload detaches it by
+     * copying. get() never copies. Thus copying an item (or cloning it) costs
+     * O(metadata) as long as the copies are only read.
+     * 
+     * Concurrent get() calls are safe, also on payloads that share their data.
+     * getMutable() and set() modify the payload object and must not be called
+     * concurrently with any other access to the same payload object.
+     * A moved-from payload holds a new default constructed value, like a
+     * moved-from item did before the payload was shared.
+     * 
+     * @warning A reference obtained from getMutable() must not be used to
+     *          modify the payload after the payload has been copied, because
+     *          the copy would see the modification. Call getMutable() again. */
+    template <class T, bool Shared = ItemPayloadIsShared<T>::value>
+    class ItemPayload
+    {
+    public:
+        /**Reference that Item<T>::getData() returns for non-const items.
+         * Shared payloads cannot be written in place */
+        typedef const T& InPlaceReference;
+
+        ItemPayload() : data(boost::make_shared<T>()) {}
+        explicit ItemPayload(const T& value) : data(boost::make_shared<T>(value)) {}
+        explicit ItemPayload(T&& value) : data(boost::make_shared<T>(std::move(value))) {}
+
+        ItemPayload(const ItemPayload& other) = default;
+        ItemPayload& operator=(const ItemPayload& other) = default;
+
+        ItemPayload(ItemPayload&& other) : data(std::move(other.data))
+        {
+            other.data = boost::make_shared<T>();
+        }
+
+        ItemPayload& operator=(ItemPayload&& other)
+        {
+            if(this != &other)
+            {
+                data = std::move(other.data);
+                other.data = boost::make_shared<T>();
+            }
+            return *this;
+        }
+
+        const T& get() const
+        {
+            assert(data); //released payloads must not be accessed
+            return *data;
+        }
+
+        InPlaceReference getInPlace() const { return get(); }
+
+        /**@return a reference to the payload that is not shared with any
+         *         other item. Copies the payload if it is shared */
+        T& getMutable()
+        {
+            assert(data); //released payloads must not be accessed
+            if(data.use_count() > 1)
+            {
+                data = boost::make_shared<T>(*data);
+            }
+            return *data;
+        }
+
+        void set(const T& value)
+        {
+            if(data && data.use_count() == 1)
+                *data = value;
+            else
+                data = boost::make_shared<T>(value);
+        }
+
+        void set(T&& value)
+        {
+            if(data && data.use_count() == 1)
+                *data = std::move(value);
+            else
+                data = boost::make_shared<T>(std::move(value));
+        }
+
+        /**@return true if the payload is shared with another item */
+        bool isShared() const { return data && data.use_count() > 1; }
+
+        /**Frees the payload if it is not shared. The payload is empty afterwards.
+         * @return true if the payload has been freed */
+        bool release()
+        {
+            if(!data || data.use_count() > 1)
+                return false;
+            data.reset();
+            return true;
+        }
+
+    private:
+        boost::shared_ptr<T> data; /**<Is only null after the payload has been released */
+    };
+
+    /**Inline storage for small payloads, copies copy the value */
+    template <class T>
+    class ItemPayload<T, false>
+    {
+    public:
+        /**Inline payloads are never shared and can be written in place */
+        typedef T& InPlaceReference;
+
+        ItemPayload() : data() {}
+        explicit ItemPayload(const T& value) : data(value) {}
+        explicit ItemPayload(T&& value) : data(std::move(value)) {}
+
+        const T& get() const { return data; }
+        T& getMutable() { return data; }
+        InPlaceReference getInPlace() { return data; }
+        void set(const T& value) { data = value; }
+        void set(T&& value) { data = std::move(value); }
+        bool isShared() const { return false; }
+        /**Inline payloads cannot be freed */
+        bool release() { return false; }
+
+    private:
+        T data;
+    };
+}}
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <boost/container/small_vector.hpp>
+#include <typeindex>
+#include <vector>
+#include "ItemBase.hpp"
+#include "ItemTypeId.hpp"
+
+namespace envire { namespace core
+{
+    /**A small flat map from item type to the list of items of that type.
+     * Most frames only contain a few item types, thus the entries are stored
+     * in a vector with inline capacity for kInlineTypes types and are searched
+     * linearly. Lookups by ItemTypeId compare integers only.
+     *
+     * The interface mirrors the parts of std::unordered_map that are used by
+     * the EnvireGraph. Iterators are invalidated by insertion and erasure. */
+    class ItemTypeMap
+    {
+    public:
+        using ItemList = std::vector<ItemBase::Ptr>;
+
+        /**An entry of the map. The member names mirror std::pair. */
+        struct value_type
+        {
+            value_type(const std::type_index& type, const ItemTypeId typeId) :
+                first(type), typeId(typeId) {}
+
+            std::type_index first; /**<Type of the items */
+            ItemList second; /**<The items. Never empty while stored in the map */
+            ItemTypeId typeId; /**<Dense id of first */
+        };
+
+        /**Number of item types that can be stored without heap allocation */
+        static constexpr std::size_t kInlineTypes = 3;
+
+        using Entries = boost::container::small_vector<value_type, kInlineTypes>;
+        using iterator = Entries::iterator;
+        using const_iterator = Entries::const_iterator;
+        using size_type = std::size_t;
+
+        iterator begin() { return entries.begin(); }
+        iterator end() { return entries.end(); }
+        const_iterator begin() const { return entries.begin(); }
+        const_iterator end() const { return entries.end(); }
+
+        size_type size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+        void clear() { entries.clear(); }
+
+        /**@return the most recently inserted entry. The map must not be empty */
+        value_type& back() { return entries.back(); }
+        const value_type& back() const { return entries.back(); }
+
+        /**Removes the most recently inserted entry */
+        void pop_back() { entries.pop_back(); }
+
+        iterator find(const ItemTypeId typeId)
+        {
+            iterator it = entries.begin();
+            while(it != entries.end() && it->typeId != typeId)
+                ++it;
+            return it;
+        }
+
+        const_iterator find(const ItemTypeId typeId) const
+        {
+            const_iterator it = entries.begin();
+            while(it != entries.end() && it->typeId != typeId)
+                ++it;
+            return it;
+        }
+
+        iterator find(const std::type_index& type)
+        {
+            iterator it = entries.begin();
+            while(it != entries.end() && it->first != type)
+                ++it;
+            return it;
+        }
+
+        const_iterator find(const std::type_index& type) const
+        {
+            const_iterator it = entries.begin();
+            while(it != entries.end() && it->first != type)
+                ++it;
+            return it;
+        }
+
+        size_type count(const std::type_index& type) const
+        {
+            return find(type) != end() ? 1 : 0;
+        }
+
+        /**@return the list of @p type. Creates an empty list if it does not exist */
+        ItemList& operator[](const std::type_index& type)
+        {
+            return getOrCreate(type, getItemTypeId(type));
+        }
+
+        /**@return the list of @p type. Creates an empty list if it does not exist.
+         * @param typeId has to be the id of @p type */
+        ItemList& getOrCreate(const std::type_index& type, const ItemTypeId typeId)
+        {
+            iterator it = find(typeId);
+            if(it == entries.end())
+            {
+                entries.emplace_back(type, typeId);
+                return entries.back().second;
+            }
+            return it->second;
+        }
+
+        /**@return the list of @p type
+         * @throw std::out_of_range if there are no items of @p type */
+        const ItemList& at(const std::type_index& type) const
+        {
+            const_iterator it = find(type);
+            if(it == entries.end())
+                throw std::out_of_range("ItemTypeMap::at");
+            return it->second;
+        }
+
+        iterator erase(const_iterator pos) { return entries.erase(pos); }
+
+        size_type erase(const std::type_index& type)
+        {
+            iterator it = find(type);
+            if(it == entries.end())
+                return 0;
+            entries.erase(it);
+            return 1;
+        }
+
+    private:
+        Entries entries;
+    };
+}}
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace envire { namespace core
+{
+    /**
+     * Kernels that apply one rigid transform to large arrays of points or
+     * normals. The arrays are packed xyz triplets, e.g. the data of a
+     * std::vector<Eigen::Vector3d> or of a column major 3xN matrix.
+     *
+     * The kernels are bound by memory bandwidth rather than arithmetic,
+     * therefore the loop is kept simple enough to be vectorized by the
+     * compiler and large arrays can be split across threads.
+     * @p in and @p out may be the same array, they must not overlap otherwise.
+     */
+    namespace kernels
+    {
+        /** Arrays with fewer points than this are never split */
+        constexpr std::size_t minPointsPerThread = 1 << 16;
+
+        /** Calls @p func(begin, end) for up to @p threads consecutive
+         *  ranges covering [0, count) */
+        template <class Func>
+        void parallelFor(const std::size_t count, unsigned threads, Func func)
+        {
+            threads = std::max(1u, std::min<unsigned>(threads, count / minPointsPerThread));
+            if(threads == 1)
+            {
+                func(std::size_t(0), count);
+                return;
+            }
+            const std::size_t chunk = (count + threads - 1) / threads;
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for(unsigned i = 1; i < threads; ++i)
+            {
+                const std::size_t begin = std::min(count, i * chunk);
+                const std::size_t end = std::min(count, begin + chunk);
+                workers.emplace_back(func, begin, end);
+            }
+            func(std::size_t(0), std::min(count, chunk));
+            for(std::thread& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        /** Sets out[i] = tf * in[i] for @p count points.
+         *  @param threads number of threads to use, 0 means one per core */
+        template <class Scalar>
+        void transformPoints(const Eigen::Transform<Scalar, 3, Eigen::Isometry>& tf,
+                             const Scalar* in, Scalar* out, const std::size_t count,
+                             const unsigned threads = 1)
+        {
+            const auto& m = tf.matrix();
+            const Scalar r00 = m(0,0), r01 = m(0,1), r02 = m(0,2), t0 = m(0,3);
+            const Scalar r10 = m(1,0), r11 = m(1,1), r12 = m(1,2), t1 = m(1,3);
+            const Scalar r20 = m(2,0), r21 = m(2,1), r22 = m(2,2), t2 = m(2,3);
+            parallelFor(count, threads ? threads : std::thread::hardware_concurrency(),
+                        [=](const std::size_t begin, const std::size_t end)
+            {
+                for(std::size_t i = begin; i < end; ++i)
+                {
+                    //read the point first, in and out may alias
+                    const Scalar x = in[3 * i], y = in[3 * i + 1], z = in[3 * i + 2];
+                    out[3 * i]     = r00 * x + r01 * y + r02 * z + t0;
+                    out[3 * i + 1] = r10 * x + r11 * y + r12 * z + t1;
+                    out[3 * i + 2] = r20 * x + r21 * y + r22 * z + t2;
+                }
+            });
+        }
+
+        /** Sets out[i] = tf.linear() * in[i] for @p count normals.
+         *  @param threads number of threads to use, 0 means one per core */
+        template <class Scalar>
+        void transformNormals(const Eigen::Transform<Scalar, 3, Eigen::Isometry>& tf,
+                              const Scalar* in, Scalar* out, const std::size_t count,
+                              const unsigned threads = 1)
+        {
+            const auto& m = tf.matrix();
+            const Scalar r00 = m(0,0), r01 = m(0,1), r02 = m(0,2);
+            const Scalar r10 = m(1,0), r11 = m(1,1), r12 = m(1,2);
+            const Scalar r20 = m(2,0), r21 = m(2,1), r22 = m(2,2);
+            parallelFor(count, threads ? threads : std::thread::hardware_concurrency(),
+                        [=](const std::size_t begin, const std::size_t end)
+            {
+                for(std::size_t i = begin; i < end; ++i)
+                {
+                    const Scalar x = in[3 * i], y = in[3 * i + 1], z = in[3 * i + 2];
+                    out[3 * i]     = r00 * x + r01 * y + r02 * z;
+                    out[3 * i + 1] = r10 * x + r11 * y + r12 * z;
+                    out[3 * i + 2] = r20 * x + r21 * y + r22 * z;
+                }
+            });
+        }
+    }
+}}
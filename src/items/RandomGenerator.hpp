@@ -32,6 +32,7 @@
 #ifndef RANDOMGENERATOR_HPP
 #define RANDOMGENERATOR_HPP
 
+#include <cstdint>
 #include <boost/thread/tss.hpp>
 #include <boost/uuid/random_generator.hpp>
 
@@ -56,6 +57,64 @@ namespace envire { namespace core
             return *randGen;
         }
     };
+    
+    /**A fast, lock free generator for random (version 4) uuids.
+     * 
+     * Each thread draws a 128 bit seed from its RandomGenerator once and
+     * afterwards mixes an incrementing counter with the seed through the
+     * splitmix64 finalizer. Generating a uuid thus neither locks nor asks
+     * the operating system for entropy. The ids are unique with the same
+     * overwhelming probability as ids drawn from a random_generator. */
+    class UUIDGenerator
+    {
+    public:
+        /**Returns a new uuid using the generator of the calling thread */
+        static boost::uuids::uuid generate()
+        {
+            static thread_local UUIDGenerator generator;
+            return generator();
+        }
+        
+        boost::uuids::uuid operator()()
+        {
+            ++counter;
+            const std::uint64_t high = mix(seedHigh + counter);
+            const std::uint64_t low = mix(seedLow ^ (counter * 0x9E3779B97F4A7C15ULL));
+            boost::uuids::uuid id;
+            for(int i = 0; i < 8; ++i)
+            {
+                id.data[i] = static_cast<std::uint8_t>(high >> (56 - 8 * i));
+                id.data[i + 8] = static_cast<std::uint8_t>(low >> (56 - 8 * i));
+            }
+            //mark as random uuid (version 4, variant RFC 4122)
+            id.data[6] = (id.data[6] & 0x0F) | 0x40;
+            id.data[8] = (id.data[8] & 0x3F) | 0x80;
+            return id;
+        }
+        
+    private:
+        UUIDGenerator() : seedHigh(0), seedLow(0), counter(0)
+        {
+            const boost::uuids::uuid seed = RandomGenerator::getRandomGenerator()();
+            for(int i = 0; i < 8; ++i)
+            {
+                seedHigh = (seedHigh << 8) | seed.data[i];
+                seedLow = (seedLow << 8) | seed.data[i + 8];
+            }
+        }
+        
+        /**splitmix64 finalizer, a bijection with good avalanche behaviour */
+        static std::uint64_t mix(std::uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+        
+        std::uint64_t seedHigh;
+        std::uint64_t seedLow;
+        std::uint64_t counter;
+    };
 }}
 #endif	/* RANDOMGENERATOR_HPP */
 
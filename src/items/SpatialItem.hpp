@@ -35,12 +35,27 @@
 namespace envire { namespace core
 {
 
+    /**@class SpatialItemBase
+    *
+    * Type independent interface of all SpatialItem<T> classes.
+    * Is used to detect spatial items (e.g. by the SpatialIndex).
+    */
+    class SpatialItemBase
+    {
+    public:
+        virtual ~SpatialItemBase() {}
+        /** Returns the boundary of the item, may be null */
+        virtual const boost::shared_ptr<BoundingVolume>& getBoundary() const = 0;
+    };
+
     /**@class SpatialItem
     *
     * SpatialItem class
+    * @note Call contentsChanged() after modifying the boundary to update
+    *       spatial indices.
     */
     template<class _ItemData>
-    class SpatialItem : public Item<_ItemData>
+    class SpatialItem : public Item<_ItemData>, public SpatialItemBase
     {
 
     public:
@@ -61,7 +76,7 @@ namespace envire { namespace core
         void setBoundary(const boost::shared_ptr<BoundingVolume>& boundary) {this->boundary = boundary;}
 
         boost::shared_ptr<BoundingVolume> getBoundary() {return boundary;}
-        const boost::shared_ptr<BoundingVolume>& getBoundary() const {return boundary;}
+        virtual const boost::shared_ptr<BoundingVolume>& getBoundary() const {return boundary;}
 
         void extendBoundary(const Eigen::Vector3d& point)
         {
@@ -29,7 +29,7 @@
 
 #include <string>
 #include <base/Time.hpp>
-#include <base-logging/Singleton.hpp>
+#include "RandomGenerator.hpp"
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/random_generator.hpp>
@@ -72,6 +72,8 @@ public:
 
     SpatioTemporal(const T& data) : uuid(boost::uuids::nil_uuid()), data(data) {}
 
+    SpatioTemporal(T&& data) : uuid(boost::uuids::nil_uuid()), data(std::move(data)) {}
+
     void setTime(const base::Time& time) { this->time = time; }
     const base::Time& getTime() const { return time; }
 
@@ -86,11 +88,12 @@ public:
     const T& getData() {return data;}
 
     /**
-     * Generates a new UUID using a Mersenne Twister pseudo-random generator (mt19937)
+     * Generates a new random UUID using the thread local UUIDGenerator.
+     * Is thread safe.
      */
     static boost::uuids::uuid generateNewUUID()
     {
-        return (*base::Singleton<boost::uuids::random_generator>::getInstance())();
+        return UUIDGenerator::generate();
     }
 };
 
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "GraphLoadOptions.hpp"
+#include <regex>
+
+using namespace envire::core;
+
+namespace
+{
+    thread_local const GraphLoadOptions* currentOptions = nullptr;
+}
+
+GraphLoadOptions& GraphLoadOptions::selectFrames(const std::unordered_set<FrameId>& frames)
+{
+    frameFilter = [frames](const FrameId& frame) { return frames.count(frame) > 0; };
+    return *this;
+}
+
+GraphLoadOptions& GraphLoadOptions::selectFramesMatching(const std::string& pattern)
+{
+    const std::regex expression(pattern); //may throw
+    frameFilter = [expression](const FrameId& frame) { return std::regex_match(frame, expression); };
+    return *this;
+}
+
+GraphLoadOptions::Scope::Scope(const GraphLoadOptions& options) : previous(currentOptions)
+{
+    currentOptions = &options;
+}
+
+GraphLoadOptions::Scope::~Scope()
+{
+    currentOptions = previous;
+}
+
+const GraphLoadOptions* GraphLoadOptions::getCurrent()
+{
+    return currentOptions;
+}
+
+const GraphLoadOptions& GraphLoadOptions::getStructureOnly()
+{
+    static const GraphLoadOptions options = []
+    {
+        GraphLoadOptions structure;
+        structure.structureOnly = true;
+        return structure;
+    }();
+    return options;
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <envire_core/items/ItemBase.hpp>
+#include <envire_core/items/ItemMetadata.hpp>
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+namespace envire { namespace core
+{
+
+/**
+ * @brief Restricts which parts of a graph file are loaded.
+ * Is used by EnvireGraph::loadFromFile() and MappedGraphFile::load().
+ *
+ * Skipped items are never decoded. A MappedGraphFile does not even read
+ * them, while the length-prefixed records of a boost archive (see
+ * Frame::ItemMap version 2) are read but not decoded. Archives of older
+ * versions have to decode every item, skipped items are dropped afterwards.
+ *
+ * Frames that are not selected are not part of the loaded graph, neither
+ * are transforms from or to them.
+ */
+class GraphLoadOptions
+{
+public:
+    /** Loads the frames and transforms only, all items are skipped */
+    bool structureOnly = false;
+
+    /** If not empty, only items of these classes are loaded (see ItemBase::getClassName()) */
+    std::unordered_set<std::string> itemClasses;
+
+    /** Items of these classes are skipped */
+    std::unordered_set<std::string> excludedItemClasses;
+
+    /** If set, only the frames for which it returns true are loaded */
+    std::function<bool (const FrameId&)> frameFilter;
+
+    /** Loads items of type @p T, see itemClasses.
+     *  @throw std::out_of_range if @p T is not registered (see ENVIRE_REGISTER_ITEM) */
+    template <class T>
+    GraphLoadOptions& includeItems()
+    {
+        itemClasses.insert(ItemMetadataMapping::getMetadata(typeid(T)).className);
+        return *this;
+    }
+
+    /** Skips items of type @p T, see excludedItemClasses.
+     *  @throw std::out_of_range if @p T is not registered (see ENVIRE_REGISTER_ITEM) */
+    template <class T>
+    GraphLoadOptions& excludeItems()
+    {
+        excludedItemClasses.insert(ItemMetadataMapping::getMetadata(typeid(T)).className);
+        return *this;
+    }
+
+    /** Loads only the given @p frames */
+    GraphLoadOptions& selectFrames(const std::unordered_set<FrameId>& frames);
+
+    /** Loads only frames whose whole id matches the ECMAScript regular expression @p pattern.
+     *  @throw std::regex_error if @p pattern is invalid */
+    GraphLoadOptions& selectFramesMatching(const std::string& pattern);
+
+    /** Loads only @p root and the frames below it in @p tree.
+     *  The tree is usually built from a structure only load of the same
+     *  file, which is cheap (see EnvireGraph::getTree()).
+     *  @throw UnknownFrameException if @p root is not part of @p graph */
+    template <class GRAPH, class TREE>
+    GraphLoadOptions& selectSubtree(const GRAPH& graph, const TREE& tree, const FrameId& root)
+    {
+        std::unordered_set<FrameId> frames;
+        tree.visitDfs(graph.getVertex(root), [&](typename GRAPH::vertex_descriptor node,
+                                                 typename GRAPH::vertex_descriptor parent)
+        {
+            frames.insert(graph.getFrameId(node));
+        });
+        return selectFrames(frames);
+    }
+
+    bool isFrameSelected(const FrameId& frame) const { return !frameFilter || frameFilter(frame); }
+
+    /** @return true if the items of @p className in selected frames are loaded */
+    bool isItemClassSelected(const std::string& className) const
+    {
+        return !structureOnly && (itemClasses.empty() || itemClasses.count(className)) &&
+               !excludedItemClasses.count(className);
+    }
+
+    /**
+     * Makes options available to the deserialization of Frame and
+     * Frame::ItemMap on the current thread while it is alive.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const GraphLoadOptions& options);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        const GraphLoadOptions* previous;
+    };
+
+    /** @return the options of the innermost Scope of the current thread or null */
+    static const GraphLoadOptions* getCurrent();
+
+    /** @return options that load the structure only */
+    static const GraphLoadOptions& getStructureOnly();
+};
+
+}}
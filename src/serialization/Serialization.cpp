@@ -31,6 +31,9 @@
 #include <envire_core/serialization/BinaryBufferHelper.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <sstream>
 
 #ifdef CMAKE_ENABLE_PLUGINS
     #include <envire_core/plugin/ClassLoader.hpp>
@@ -55,6 +58,127 @@ bool Serialization::loadFromBinary(const std::vector< uint8_t >& binary, ItemBas
     return load(ia, item);
 }
 
+bool Serialization::loadFromBinary(const uint8_t* data, std::size_t size, ItemBase::Ptr& item)
+{
+    BinaryInputBuffer buffer(data, size);
+    std::istream istream(&buffer);
+    boost::archive::binary_iarchive ia(istream);
+    return load(ia, item);
+}
+
+bool Serialization::saveRecord(std::vector< uint8_t >& record, const ItemBase::Ptr& item, const std::string& class_name)
+{
+    HandlePtr handle;
+    if(!getHandle(class_name, handle) || !handle)
+        return false;
+    record.clear();
+    BinaryOutputBuffer buffer(&record);
+    std::ostream ostream(&buffer);
+    //the records are embedded in an archive, the header would be redundant
+    boost::archive::binary_oarchive oa(ostream, boost::archive::no_header);
+    try
+    {
+        return handle->save(oa, item);
+    }
+    catch(const std::runtime_error& e)
+    {
+        LOG(ERROR) << "Caught exception while trying to save an item of type " << class_name;
+    }
+    return false;
+}
+
+bool Serialization::loadRecord(const uint8_t* data, std::size_t size, const std::string& class_name, ItemBase::Ptr& item)
+{
+    HandlePtr handle;
+    if(!getHandle(class_name, handle) || !handle)
+        return false;
+    BinaryInputBuffer buffer(data, size);
+    std::istream istream(&buffer);
+    boost::archive::binary_iarchive ia(istream, boost::archive::no_header);
+    try
+    {
+        return handle->load(ia, item);
+    }
+    catch(const std::runtime_error& e)
+    {
+        LOG(ERROR) << "Caught exception while trying to load an item of type " << class_name;
+    }
+    return false;
+}
+
+bool Serialization::saveTextRecord(std::string& record, const ItemBase::Ptr& item, const std::string& class_name)
+{
+    HandlePtr handle;
+    if(!getHandle(class_name, handle) || !handle)
+        return false;
+    std::ostringstream ostream;
+    try
+    {
+        bool saved;
+        {
+            boost::archive::text_oarchive oa(ostream, boost::archive::no_header);
+            saved = handle->save(oa, item);
+        }
+        record = ostream.str();
+        return saved;
+    }
+    catch(const std::runtime_error& e)
+    {
+        LOG(ERROR) << "Caught exception while trying to save an item of type " << class_name;
+    }
+    return false;
+}
+
+bool Serialization::loadTextRecord(const std::string& record, const std::string& class_name, ItemBase::Ptr& item)
+{
+    HandlePtr handle;
+    if(!getHandle(class_name, handle) || !handle)
+        return false;
+    std::istringstream istream(record);
+    try
+    {
+        boost::archive::text_iarchive ia(istream, boost::archive::no_header);
+        return handle->load(ia, item);
+    }
+    catch(const std::runtime_error& e)
+    {
+        LOG(ERROR) << "Caught exception while trying to load an item of type " << class_name;
+    }
+    return false;
+}
+
+bool Serialization::isLoadable(const std::string& class_name)
+{
+    if(hasHandle(class_name))
+        return true;
+
+    // load plugin lib
+    if(!loadPluginLibrary(class_name))
+    {
+        LOG(ERROR) << "Failed to load plugin library for item " << class_name;
+        return false;
+    }
+
+    if(hasHandle(class_name))
+    {
+        LOG(INFO) << "Successfully loaded plugin library for item " << class_name;
+        return true;
+    }
+    LOG(ERROR) << "Library has been loaded but can't find a serialization handle for " << class_name << "."
+               << "Did you forget to register the Item with the ENVIRE_REGISTER_ITEM macro?";
+    return false;
+}
+
+ItemBase::Ptr Serialization::createItem(const std::string& class_name)
+{
+    if(!isLoadable(class_name))
+        return ItemBase::Ptr();
+    HandlePtr handle;
+    if(getHandle(class_name, handle) && handle)
+        return handle->create();
+    return ItemBase::Ptr();
+}
+
 bool Serialization::isSerializable(const ItemBase::Ptr& item)
 {
     std::string class_name;
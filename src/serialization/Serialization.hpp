@@ -167,6 +167,81 @@ public:
      */
     static bool loadFromBinary(const std::vector< uint8_t >& binary, ItemBase::Ptr& item);
 
+    /**
+     * @brief Unserializes an abstract item from a binary blob that is not
+     * owned by a vector, e.g. a memory mapped file
+     *
+     * @param data begin of the binary data
+     * @param size size of the binary data in bytes
+     * @param item pointer to the ItemBase class
+     * @return true if successful
+     */
+    static bool loadFromBinary(const uint8_t* data, std::size_t size, ItemBase::Ptr& item);
+
+    /**
+     * @brief Serializes the item without ItemHeader to a binary record.
+     * The records are length-prefixed in a Frame::ItemMap, which allows
+     * loaders to skip items without decoding them.
+     *
+     * @param record binary data, is overwritten
+     * @param item pointer to the ItemBase class
+     * @param class_name class name of the item, see ItemBase::getClassName()
+     * @return true if successful
+     */
+    static bool saveRecord(std::vector< uint8_t >& record, const ItemBase::Ptr& item, const std::string& class_name);
+
+    /**
+     * @brief Unserializes an item from a record created by saveRecord()
+     *
+     * @param data begin of the record
+     * @param size size of the record in bytes
+     * @param class_name class name of the item stored in the record
+     * @param item pointer to the ItemBase class
+     * @return true if successful
+     */
+    static bool loadRecord(const uint8_t* data, std::size_t size, const std::string& class_name, ItemBase::Ptr& item);
+
+    /**
+     * @brief Serializes the item without ItemHeader to a text record.
+     * Text based archives embed these records instead of binary ones,
+     * thus the items stay readable and independent of the platform.
+     *
+     * @param record text data, is overwritten
+     * @param item pointer to the ItemBase class
+     * @param class_name class name of the item, see ItemBase::getClassName()
+     * @return true if successful
+     */
+    static bool saveTextRecord(std::string& record, const ItemBase::Ptr& item, const std::string& class_name);
+
+    /**
+     * @brief Unserializes an item from a record created by saveTextRecord()
+     *
+     * @param record text data
+     * @param class_name class name of the item stored in the record
+     * @param item pointer to the ItemBase class
+     * @return true if successful
+     */
+    static bool loadTextRecord(const std::string& record, const std::string& class_name, ItemBase::Ptr& item);
+
+    /**
+     * @brief Returns true if items of a class can be unserialized.
+     * Loads the plugin library of the class if needed.
+     *
+     * @param class_name name of the item class, see ItemBase::getClassName()
+     * @return true if a serialization handle is registered
+     */
+    static bool isLoadable(const std::string& class_name);
+
+    /**
+     * @brief Creates a default constructed item of a registered class.
+     * Loads the plugin library of the class if needed.
+     *
+     * @param class_name name of the item class, see ItemBase::getClassName()
+     * @return the new item or null if the class is unknown or its handle
+     *         cannot create items
+     */
+    static ItemBase::Ptr createItem(const std::string& class_name);
+
     /**
      * @brief Returns true if a serialization handle is registered for the given item.
      *
@@ -54,6 +54,10 @@ public:
 
     virtual bool save(boost::archive::text_oarchive& ar, const ItemBase::Ptr& item) = 0;
     virtual bool load(boost::archive::text_iarchive& ar, ItemBase::Ptr& item) = 0;
+
+    /** Creates a default constructed item of the handled class.
+     *  Returns null if the handle does not support it. */
+    virtual ItemBase::Ptr create() { return ItemBase::Ptr(); }
 };
 
 }}
\ No newline at end of file
@@ -48,10 +48,17 @@ namespace envire { namespace core
  * in a static map used by the methods in the class envire::core::Serialization.
  */
 #define ENVIRE_REGISTER_SERIALIZATION( _classname, _datatype) \
-ENVIRE_REGISTER_SERIALIZATION_INTERNAL( _classname, _datatype, __COUNTER__ )
+ENVIRE_REGISTER_SERIALIZATION_EXPAND( _classname, _datatype, __COUNTER__ )
 
+/** Expands __COUNTER__ before it is concatenated */
+#define ENVIRE_REGISTER_SERIALIZATION_EXPAND( _classname, _datatype, _unique_id ) \
+ENVIRE_REGISTER_SERIALIZATION_INTERNAL( _classname, _datatype, _unique_id )
+
+/** The handle is defined in an anonymous namespace, since __COUNTER__ is only
+ *  unique within one translation unit */
 #define ENVIRE_REGISTER_SERIALIZATION_INTERNAL( _classname, _datatype, _unique_id ) \
 BOOST_CLASS_EXPORT(_classname) \
+namespace { \
 class SerializationHandle ## _unique_id : public envire::core::SerializationHandle \
 { \
 public: \
@@ -75,8 +82,13 @@ public: \
         ar >> BOOST_SERIALIZATION_NVP(item); \
         return true; \
     }; \
+    virtual envire::core::ItemBase::Ptr create() \
+    { \
+        return envire::core::ItemBase::Ptr(new _classname); \
+    }; \
 }; \
-static envire::core::SerializationRegistration<SerializationHandle ## _unique_id> reg(#_classname);
+static envire::core::SerializationRegistration<SerializationHandle ## _unique_id> reg ## _unique_id(#_classname); \
+}
 
 
 
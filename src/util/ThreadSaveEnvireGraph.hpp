@@ -1,6 +1,8 @@
 #pragma once
 
 #include <mutex>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <vector>
 #include "../graph/EnvireGraph.hpp"
@@ -143,6 +145,76 @@ class ThreadSaveEnvireGraph {
         return graph->getFrames(origin, target);
     }
 
+    /**********
+    *   Waiting
+    ***********/
+
+    /**
+     * @brief Returns a future that becomes ready once the frame exists
+     * 
+     * The future is fulfilled by the thread that adds the frame.
+     */
+    std::shared_future<void> waitForFrame(const envire::core::FrameId& name) {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        return graph->waitForFrame(name);
+    }
+
+    /**
+     * @brief Blocks until the frame exists or the timeout expired
+     * 
+     * The wait is given up if the timeout expired.
+     * 
+     * @warning do not call this while holding the lock (see lock()), otherwise no other thread can add the frame
+     * @return true if the frame exists
+     */
+    bool waitForFrame(const envire::core::FrameId& name, const std::chrono::milliseconds& timeout) {
+        std::shared_future<void> future = waitForFrame(name);
+        if (future.wait_for(timeout) == std::future_status::ready) {
+            return true;
+        }
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        //the frame might have been added after the timeout expired
+        if (future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            return true;
+        }
+        graph->cancelWaitForFrame(name);
+        return false;
+    }
+
+    /**
+     * @brief Returns a future that receives the transform once it can be resolved
+     * 
+     * The future is fulfilled by the thread that adds the missing frame or edge.
+     */
+    std::shared_future<envire::core::Transform> waitForTransform(const envire::core::FrameId& origin, const envire::core::FrameId& target) {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        return graph->waitForTransform(origin, target);
+    }
+
+    /**
+     * @brief Blocks until the transform can be resolved or the timeout expired
+     * 
+     * The wait is given up if the timeout expired.
+     * 
+     * @warning do not call this while holding the lock (see lock()), otherwise no other thread can modify the graph
+     * @param tf receives the transform if it could be resolved
+     * @return true if the transform could be resolved
+     */
+    bool waitForTransform(const envire::core::FrameId& origin, const envire::core::FrameId& target,
+                          const std::chrono::milliseconds& timeout, envire::core::Transform& tf) {
+        std::shared_future<envire::core::Transform> future = waitForTransform(origin, target);
+        if (future.wait_for(timeout) != std::future_status::ready) {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            //the transform might have been resolved after the timeout expired
+            if (future.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+                graph->cancelWaitForTransform(origin, target);
+                return false;
+            }
+        }
+        tf = future.get();
+        return true;
+    }
+
     /**********
     *   Items
     ***********/
@@ -157,6 +229,18 @@ class ThreadSaveEnvireGraph {
         graph->addItemToFrame(frameId, item);
     }
 
+    template <class Iterator>
+    void addItemsToFrame(const envire::core::FrameId& frameId, Iterator begin, Iterator end) {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        graph->addItemsToFrame(frameId, begin, end);
+    }
+
+    template <class ITEMTYPE, class... Args>
+    envire::core::ItemBase::PtrType<ITEMTYPE> emplaceItem(const envire::core::FrameId& frameId, Args&&... args) {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        return graph->emplaceItem<ITEMTYPE>(frameId, std::forward<Args>(args)...);
+    }
+
     void removeItemFromFrame(envire::core::ItemBase::Ptr item) {
         std::lock_guard<std::recursive_mutex> lock(mutex);
         graph->removeItemFromFrame(item);
@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+/*
+ * Minimal timing helpers shared by the benchmark executables.
+ * The benchmarks are not part of the test suite, they are meant to be run
+ * manually in release builds.
+ */
+
+#pragma once
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace envire { namespace core { namespace benchmark
+{
+    /** Runs @p func @p repetitions times and prints the average duration
+     *  of one call.
+     *  @return the average duration of one call in microseconds */
+    template <class Func>
+    double run(const std::string& name, const size_t repetitions, Func func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < repetitions; ++i)
+        {
+            func();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const double us = std::chrono::duration<double, std::micro>(end - start).count() / repetitions;
+        std::cout << std::left << std::setw(50) << name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(2)
+                  << us << " us" << std::endl;
+        return us;
+    }
+}}}
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * Compares testing many boxes one pair at a time through the virtual
+ * BoundingVolume interface with the batch kernels of AlignedBoxSet.
+ */
+
+#include <envire_core/items/AlignedBoundingBox.hpp>
+#include <envire_core/items/AlignedBoxSet.hpp>
+#include "Benchmark.hpp"
+#include <random>
+#include <vector>
+
+using namespace envire::core;
+
+namespace
+{
+    const size_t numBoxes = 50000;
+    const size_t repetitions = 200;
+
+    template <class Scalar>
+    void batch(const std::string& name, const std::vector<Eigen::AlignedBox3d>& boxes,
+               const Eigen::AlignedBox3d& query, const Eigen::Vector3d& point)
+    {
+        AlignedBoxSet<Scalar> set;
+        set.reserve(boxes.size());
+        for(const Eigen::AlignedBox3d& box : boxes)
+        {
+            set.push_back(box.cast<Scalar>());
+        }
+        const typename AlignedBoxSet<Scalar>::Box q = query.cast<Scalar>();
+        const typename AlignedBoxSet<Scalar>::Vector p = point.cast<Scalar>();
+        typename AlignedBoxSet<Scalar>::Mask hits;
+        typename AlignedBoxSet<Scalar>::Values distances;
+        size_t count = 0;
+        benchmark::run(name + " intersects", repetitions, [&]()
+        {
+            set.intersects(q, hits);
+            count += hits.count();
+        });
+        benchmark::run(name + " exteriorDistance", repetitions, [&]()
+        {
+            set.exteriorDistance(p, distances);
+        });
+        std::cout << "  (" << count / repetitions << " hits)" << std::endl;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(-100, 100);
+    std::uniform_real_distribution<double> extent(0, 5);
+    std::vector<Eigen::AlignedBox3d> boxes;
+    std::vector<boost::shared_ptr<BoundingVolume>> volumes;
+    for(size_t i = 0; i < numBoxes; ++i)
+    {
+        const Eigen::Vector3d min(coord(rng), coord(rng), coord(rng));
+        boxes.emplace_back(min, min + Eigen::Vector3d(extent(rng), extent(rng), extent(rng)));
+        volumes.emplace_back(new AlignedBoundingBox(boxes.back()));
+    }
+    const Eigen::AlignedBox3d query(Eigen::Vector3d(-20, -20, -20), Eigen::Vector3d(20, 20, 20));
+    const Eigen::Vector3d point(1, 2, 3);
+
+    std::cout << numBoxes << " boxes" << std::endl;
+    boost::shared_ptr<BoundingVolume> queryVolume(new AlignedBoundingBox(query));
+    size_t count = 0;
+    benchmark::run("virtual intersection", repetitions, [&]()
+    {
+        for(const auto& volume : volumes)
+        {
+            count += !volume->intersection(queryVolume)->getAlignedBox().isEmpty();
+        }
+    });
+    std::cout << "  (" << count / repetitions << " hits)" << std::endl;
+    benchmark::run("virtual exteriorDistance", repetitions, [&]()
+    {
+        double sum = 0;
+        for(const auto& volume : volumes)
+        {
+            sum += volume->exteriorDistance(point);
+        }
+        count += sum > 0;
+    });
+    batch<double>("AlignedBoxSetd", boxes, query, point);
+    batch<float>("AlignedBoxSetf", boxes, query, point);
+    return 0;
+}
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+/*
+ * Measures the cost of graph mutations with and without event subscribers.
+ */
+
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/events/GraphEventDispatcher.hpp>
+#include <envire_core/items/Item.hpp>
+#include "Benchmark.hpp"
+
+using namespace envire::core;
+
+namespace
+{
+    const size_t numFrames = 1000;
+    const size_t numItems = 10;
+
+    class NullSubscriber : public GraphEventDispatcher
+    {
+    public:
+        NullSubscriber(GraphEventPublisher* publisher) : GraphEventDispatcher(publisher) {}
+    };
+
+    /** Builds a chain of frames, adds items, modifies all edges and
+     *  tears everything down again. */
+    void mutate(EnvireGraph& graph)
+    {
+        Transform tf;
+        for(size_t i = 1; i < numFrames; ++i)
+        {
+            graph.addTransform("frame_" + std::to_string(i - 1),
+                               "frame_" + std::to_string(i), tf);
+        }
+        for(size_t i = 0; i < numFrames; ++i)
+        {
+            const FrameId frame = "frame_" + std::to_string(i);
+            for(size_t j = 0; j < numItems; ++j)
+            {
+                graph.addItemToFrame(frame, Item<int>::Ptr(new Item<int>(j)));
+            }
+        }
+        for(size_t i = 1; i < numFrames; ++i)
+        {
+            graph.updateTransform("frame_" + std::to_string(i - 1),
+                                  "frame_" + std::to_string(i), tf);
+        }
+        for(size_t i = 0; i < numFrames; ++i)
+        {
+            graph.clearFrame("frame_" + std::to_string(i));
+        }
+        for(size_t i = 1; i < numFrames; ++i)
+        {
+            graph.removeTransform("frame_" + std::to_string(i - 1),
+                                  "frame_" + std::to_string(i));
+        }
+        for(size_t i = 0; i < numFrames; ++i)
+        {
+            graph.removeFrame("frame_" + std::to_string(i));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t repetitions = argc > 1 ? std::stoul(argv[1]) : 20;
+
+    EnvireGraph noSubscribers;
+    benchmark::run("mutations without subscribers", repetitions,
+                   [&]() { mutate(noSubscribers); });
+
+    EnvireGraph disabled;
+    NullSubscriber ignored(&disabled);
+    disabled.enableEvents(false);
+    benchmark::run("mutations with disabled events", repetitions,
+                   [&]() { mutate(disabled); });
+
+    EnvireGraph subscribed;
+    NullSubscriber subscriber(&subscribed);
+    benchmark::run("mutations with one subscriber", repetitions,
+                   [&]() { mutate(subscribed); });
+    return 0;
+}
@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+/*
+ * Compares the allocation strategies for items: plain new, make_shared and
+ * the per-size pools, as well as the uuid generators. The churn benchmark frees and re-creates random items
+ * to show how the strategies behave once the heap is fragmented.
+ */
+
+#include <envire_core/items/Item.hpp>
+#include <envire_core/items/RandomGenerator.hpp>
+#include "Benchmark.hpp"
+#include <fstream>
+#include <random>
+#include <unistd.h>
+
+using namespace envire::core;
+
+namespace
+{
+    const size_t numItems = 100000;
+
+    /** Eigen based payload like the one of real pose items */
+    typedef Eigen::Affine3d Pose;
+    static_assert(!ItemPayloadIsShared<Pose>::value, "poses must be stored inline without an extra allocation");
+
+    /** @return the resident set size in KiB or 0 if it is not available */
+    size_t residentKiB()
+    {
+        std::ifstream statm("/proc/self/statm");
+        size_t pages = 0, resident = 0;
+        if(!(statm >> pages >> resident))
+        {
+            return 0;
+        }
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    template <class Factory>
+    void churn(const std::string& name, const size_t repetitions, Factory factory)
+    {
+        std::vector<Item<Pose>::Ptr> items;
+        items.reserve(numItems);
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            items.push_back(factory());
+        }
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pick(0, numItems - 1);
+        const size_t before = residentKiB();
+        benchmark::run(name, repetitions, [&]()
+        {
+            for(size_t i = 0; i < numItems / 2; ++i)
+            {
+                items[pick(rng)] = factory();
+            }
+        });
+        std::cout << "  resident set growth: " << residentKiB() - before << " KiB" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t repetitions = argc > 1 ? std::stoul(argv[1]) : 20;
+
+    std::cout << "sizeof(Item<Pose>): " << sizeof(Item<Pose>) << " bytes" << std::endl;
+
+    std::vector<Item<Pose>::Ptr> items;
+    items.reserve(numItems);
+
+    benchmark::run("new Item<Pose> (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            items.emplace_back(new Item<Pose>());
+        }
+        items.clear();
+    });
+
+    benchmark::run("Item<Pose>::create() (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            items.push_back(Item<Pose>::create());
+        }
+        items.clear();
+    });
+
+    benchmark::run("Item<Pose>::createPooled() (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            items.push_back(Item<Pose>::createPooled());
+        }
+        items.clear();
+    });
+
+    boost::uuids::uuid id;
+    benchmark::run("random_generator uuids (100k)", repetitions, [&]()
+    {
+        boost::uuids::random_generator& generator = RandomGenerator::getRandomGenerator();
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            id = generator();
+        }
+    });
+
+    benchmark::run("UUIDGenerator uuids (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            id = UUIDGenerator::generate();
+        }
+    });
+
+    const base::Time time = base::Time::fromSeconds(1);
+    benchmark::run("Item<Pose>::create(data, time) (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            items.push_back(Item<Pose>::create(Pose(), time));
+        }
+        items.clear();
+    });
+
+    ItemBase::setLazyIDs(true);
+    benchmark::run("Item<Pose>::create() with lazy ids (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            items.push_back(Item<Pose>::create());
+        }
+        items.clear();
+    });
+    ItemBase::setLazyIDs(false);
+
+    Item<Pose> item;
+    benchmark::run("contentsChanged() without listener (100k)", repetitions, [&]()
+    {
+        for(size_t i = 0; i < numItems; ++i)
+        {
+            item.contentsChanged();
+        }
+    });
+
+    churn("churn new Item<Pose> (50k)", repetitions, []() { return Item<Pose>::Ptr(new Item<Pose>()); });
+    churn("churn Item<Pose>::create() (50k)", repetitions, []() { return Item<Pose>::create(); });
+    churn("churn Item<Pose>::createPooled() (50k)", repetitions, []() { return Item<Pose>::createPooled(); });
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+/*
+ * Measures the cost of item storage and lookup in frames and of adding
+ * items with large payloads.
+ */
+
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/items/Item.hpp>
+#include "Benchmark.hpp"
+
+using namespace envire::core;
+
+namespace
+{
+    const size_t numFrames = 10000;
+    const size_t numIterationItems = 1000000;
+
+    /** The caster that was used by ItemIterator before, for comparison */
+    template <class TARGET>
+    struct DynamicItemCaster
+    {
+        TARGET& operator()(const ItemBase::Ptr p) const
+        {
+            return *(boost::dynamic_pointer_cast<TARGET>(p));
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const size_t repetitions = argc > 1 ? std::stoul(argv[1]) : 20;
+
+    std::cout << "sizeof(Frame): " << sizeof(Frame) << " bytes" << std::endl;
+
+    EnvireGraph graph;
+    std::vector<GraphTraits::vertex_descriptor> frames;
+    for(size_t i = 0; i < numFrames; ++i)
+    {
+        const FrameId frame = "frame_" + std::to_string(i);
+        frames.push_back(graph.addFrame(frame));
+        graph.addItemToFrame(frame, Item<int>::Ptr(new Item<int>(i)));
+        graph.addItemToFrame(frame, Item<double>::Ptr(new Item<double>(i)));
+    }
+
+    size_t found = 0;
+    benchmark::run("getItems<T>() on all frames", repetitions, [&]()
+    {
+        for(const GraphTraits::vertex_descriptor frame : frames)
+        {
+            const auto range = graph.getItems<Item<double>>(frame);
+            found += range.first != range.second;
+        }
+    });
+
+    benchmark::run("getItems(type_index) on all frames", repetitions, [&]()
+    {
+        const std::type_index type(typeid(Item<int>));
+        for(const GraphTraits::vertex_descriptor frame : frames)
+        {
+            found += graph.getItems(frame, type).size();
+        }
+    });
+
+    benchmark::run("addItemToFrame + clearFrame", repetitions, [&]()
+    {
+        for(size_t i = 0; i < 1000; ++i)
+        {
+            const FrameId frame = "frame_" + std::to_string(i);
+            graph.addItemToFrame(frame, Item<float>::Ptr(new Item<float>(i)));
+        }
+        for(size_t i = 0; i < 1000; ++i)
+        {
+            graph.clearFrame("frame_" + std::to_string(i));
+        }
+    });
+
+    graph.addFrame("iteration");
+    for(size_t i = 0; i < numIterationItems; ++i)
+    {
+        graph.emplaceItem<Item<int>>("iteration", int(i));
+    }
+    const Frame::ItemList& list = graph.getItems("iteration", typeid(Item<int>));
+    long long sum = 0;
+
+    benchmark::run("iterate 1M items with dynamic_pointer_cast", repetitions, [&]()
+    {
+        using DynamicIterator = boost::transform_iterator<DynamicItemCaster<Item<int>>,
+                                                          Frame::ItemList::const_iterator, Item<int>&>;
+        DynamicIterator it(list.begin(), DynamicItemCaster<Item<int>>());
+        const DynamicIterator end(list.end(), DynamicItemCaster<Item<int>>());
+        for(; it != end; ++it)
+        {
+            sum += it->getData();
+        }
+    });
+
+    benchmark::run("iterate 1M items with ItemIterator", repetitions, [&]()
+    {
+        EnvireGraph::ItemIterator<Item<int>> it, end;
+        std::tie(it, end) = graph.getItems<Item<int>>("iteration");
+        for(; it != end; ++it)
+        {
+            sum += it->getData();
+        }
+    });
+
+    benchmark::run("iterate 1M items with ItemSpan", repetitions, [&]()
+    {
+        const EnvireGraph::ItemSpan<Item<int>> span = graph.getItemSpan<Item<int>>("iteration");
+        for(size_t i = 0; i < span.size(); ++i)
+        {
+            sum += span[i].getData();
+        }
+    });
+    found += sum != 0;
+    graph.clearFrame("iteration");
+
+    //4 MiB payload: copying it dominates everything else
+    const size_t payloadSize = 1 << 19;
+    std::vector<double> payload;
+    benchmark::run("add 4 MiB payload by copy", repetitions, [&]()
+    {
+        payload.assign(payloadSize, 1.0);
+        graph.addItemToFrame("frame_0", Item<std::vector<double>>::Ptr(new Item<std::vector<double>>(payload)));
+        graph.clearFrame("frame_0");
+    });
+
+    benchmark::run("add 4 MiB payload by move", repetitions, [&]()
+    {
+        payload.assign(payloadSize, 1.0);
+        graph.addItemToFrame("frame_0", Item<std::vector<double>>::create(std::move(payload)));
+        graph.clearFrame("frame_0");
+    });
+
+    benchmark::run("emplaceItem 4 MiB payload", repetitions, [&]()
+    {
+        payload.assign(payloadSize, 1.0);
+        graph.emplaceItem<Item<std::vector<double>>>("frame_0", std::move(payload));
+        graph.clearFrame("frame_0");
+    });
+
+    std::vector<Item<int>::Ptr> batch;
+    benchmark::run("addItemsToFrame 1000 items", repetitions, [&]()
+    {
+        batch.clear();
+        for(size_t i = 0; i < 1000; ++i)
+        {
+            batch.push_back(Item<int>::create(i));
+        }
+        graph.addItemsToFrame("frame_1", batch.begin(), batch.end());
+        graph.clearFrame("frame_1");
+    });
+
+    return found > 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * Throughput of moving a point cloud from a sensor frame into the world
+ * frame: the manual loop over base::TransformWithCovariance compared to
+ * EnvireGraph::transformPoints() in float and double with several threads.
+ */
+
+#include <envire_core/graph/EnvireGraph.hpp>
+#include "Benchmark.hpp"
+#include <thread>
+
+using namespace envire::core;
+
+namespace
+{
+    const size_t numPoints = 2000000;
+    const size_t repetitions = 20;
+
+    void report(const double us)
+    {
+        std::cout << "  " << std::fixed << std::setprecision(1)
+                  << numPoints / us << " Mpoints/s" << std::endl;
+    }
+
+    template <class Scalar>
+    void kernel(const std::string& name, const EnvireGraph& graph, const unsigned threads)
+    {
+        std::vector<Eigen::Matrix<Scalar, 3, 1>> points(numPoints, Eigen::Matrix<Scalar, 3, 1>(1, 2, 3));
+        std::vector<Eigen::Matrix<Scalar, 3, 1>> out(numPoints);
+        report(benchmark::run(name + " " + std::to_string(threads) + " thread(s)", repetitions, [&]()
+        {
+            graph.transformPoints("sensor", "world", points.front().data(), out.front().data(),
+                                  numPoints, threads);
+        }));
+    }
+}
+
+int main()
+{
+    EnvireGraph graph;
+    Transform tf;
+    tf.transform.translation << 1, 2, 3;
+    tf.transform.orientation = Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitZ());
+    graph.addTransform("world", "base", tf);
+    graph.addTransform("base", "sensor", tf);
+
+    std::cout << numPoints << " points" << std::endl;
+    std::vector<Eigen::Vector3d> points(numPoints, Eigen::Vector3d(1, 2, 3));
+    std::vector<Eigen::Vector3d> out(numPoints);
+    report(benchmark::run("manual loop", repetitions, [&]()
+    {
+        const base::TransformWithCovariance worldToSensor = graph.getTransform("world", "sensor").transform;
+        for(size_t i = 0; i < numPoints; ++i)
+        {
+            out[i] = worldToSensor.orientation * points[i] + worldToSensor.translation;
+        }
+    }));
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned threads = 1; threads <= cores; threads *= 2)
+    {
+        kernel<double>("transformPoints<double>", graph, threads);
+        kernel<float>("transformPoints<float>", graph, threads);
+    }
+    return 0;
+}
@@ -26,8 +26,13 @@
 
 #include <Eigen/Geometry>
 #include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+#include <random>
 #include <envire_core/items/SpatialItem.hpp>
 #include <envire_core/items/AlignedBoundingBox.hpp>
+#include <envire_core/items/AlignedBoxSet.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/graph/SpatialIndex.hpp>
 
 using namespace envire::core;
 
@@ -82,3 +87,216 @@ BOOST_AUTO_TEST_CASE(boundary_test_with_points)
     BOOST_CHECK(vector_item.contains(point_three));
 }
 
+
+static SpatialItem<Eigen::Vector3d>::Ptr makeSpatialItem(const Eigen::Vector3d& min, const Eigen::Vector3d& max)
+{
+    SpatialItem<Eigen::Vector3d>::Ptr item(new SpatialItem<Eigen::Vector3d>());
+    boost::shared_ptr<AlignedBoundingBox> box(new AlignedBoundingBox);
+    box->extend(min);
+    box->extend(max);
+    item->setBoundary(box);
+    return item;
+}
+
+static Transform translation(const Eigen::Vector3d& t)
+{
+    Transform tf;
+    tf.transform.translation = t;
+    tf.transform.orientation.setIdentity();
+    return tf;
+}
+
+static bool containsItem(const std::vector<ItemBase::Ptr>& items, const ItemBase::Ptr& item)
+{
+    return std::find(items.begin(), items.end(), item) != items.end();
+}
+
+BOOST_AUTO_TEST_CASE(spatial_index_query_test)
+{
+    EnvireGraph graph;
+    graph.addTransform("world", "a", translation(Eigen::Vector3d(10, 0, 0)));
+    graph.addFrame("unconnected");
+
+    SpatialItem<Eigen::Vector3d>::Ptr inWorld = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    SpatialItem<Eigen::Vector3d>::Ptr inA = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    SpatialItem<Eigen::Vector3d>::Ptr inUnconnected = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    graph.addItemToFrame("world", inWorld);
+    //existing items are indexed on construction
+    SpatialIndex index(graph, "world");
+    graph.addItemToFrame("a", inA);
+    graph.addItemToFrame("unconnected", inUnconnected);
+    //items that are not spatial are ignored
+    graph.addItemToFrame("a", ItemBase::Ptr(new Item<int>(42)));
+
+    BOOST_CHECK_EQUAL(index.size(), 2);
+
+    SpatialIndex::Box box;
+    BOOST_CHECK(index.getBoundary(*inA, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(9, -1, -1)));
+    BOOST_CHECK(box.max().isApprox(Eigen::Vector3d(11, 1, 1)));
+    BOOST_CHECK(!index.getBoundary(*inUnconnected, box));
+
+    std::vector<ItemBase::Ptr> result = index.queryBox(SpatialIndex::Box(Eigen::Vector3d(8, 0, 0), Eigen::Vector3d(9.5, 0.5, 0.5)));
+    BOOST_CHECK_EQUAL(result.size(), 1);
+    BOOST_CHECK(containsItem(result, inA));
+
+    result = index.querySphere(Eigen::Vector3d(5, 0, 0), 3.5);
+    BOOST_CHECK(result.empty());
+    result = index.querySphere(Eigen::Vector3d(5, 0, 0), 4.5);
+    BOOST_CHECK_EQUAL(result.size(), 2);
+
+    result = index.queryNearest(Eigen::Vector3d(7, 0, 0), 2);
+    BOOST_CHECK_EQUAL(result.size(), 2);
+    BOOST_CHECK(result[0] == inA);
+    BOOST_CHECK(result[1] == inWorld);
+}
+
+BOOST_AUTO_TEST_CASE(spatial_index_update_test)
+{
+    EnvireGraph graph;
+    graph.addTransform("world", "a", translation(Eigen::Vector3d(10, 0, 0)));
+    graph.addFrame("b");
+    SpatialIndex index(graph, "world");
+
+    SpatialItem<Eigen::Vector3d>::Ptr inA = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    SpatialItem<Eigen::Vector3d>::Ptr inB = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    graph.addItemToFrame("a", inA);
+    graph.addItemToFrame("b", inB);
+    BOOST_CHECK_EQUAL(index.size(), 1);
+
+    //moving the frame refits its items
+    graph.updateTransform("world", "a", translation(Eigen::Vector3d(0, 20, 0)));
+    SpatialIndex::Box box;
+    BOOST_CHECK(index.getBoundary(*inA, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(-1, 19, -1)));
+
+    //connecting a frame indexes its items
+    graph.addTransform("a", "b", translation(Eigen::Vector3d(0, 0, 5)));
+    BOOST_CHECK_EQUAL(index.size(), 2);
+    BOOST_CHECK(index.getBoundary(*inB, box));
+    BOOST_CHECK(box.max().isApprox(Eigen::Vector3d(1, 21, 6)));
+
+    //changing the boundary refits the item after contentsChanged()
+    inB->extendBoundary(Eigen::Vector3d(0, 0, 3));
+    inB->contentsChanged();
+    BOOST_CHECK(index.getBoundary(*inB, box));
+    BOOST_CHECK(box.max().isApprox(Eigen::Vector3d(1, 21, 8)));
+
+    graph.removeItemFromFrame(inA);
+    BOOST_CHECK_EQUAL(index.size(), 1);
+    BOOST_CHECK(!index.getBoundary(*inA, box));
+
+    graph.removeTransform("a", "b");
+    BOOST_CHECK_EQUAL(index.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(spatial_index_subtree_update_test)
+{
+    EnvireGraph graph;
+    graph.addTransform("world", "a", translation(Eigen::Vector3d(10, 0, 0)));
+    graph.addTransform("a", "b", translation(Eigen::Vector3d(0, 10, 0)));
+    graph.addTransform("world", "c", translation(Eigen::Vector3d(0, 0, 10)));
+    SpatialIndex index(graph, "world");
+
+    SpatialItem<Eigen::Vector3d>::Ptr inB = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    SpatialItem<Eigen::Vector3d>::Ptr inC = makeSpatialItem(Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1));
+    graph.addItemToFrame("b", inB);
+    graph.addItemToFrame("c", inC);
+    SpatialIndex::Box box;
+    BOOST_CHECK(index.getBoundary(*inB, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(9, 9, -1)));
+
+    //moving an inner edge moves the whole subtree below it
+    graph.updateTransform("world", "a", translation(Eigen::Vector3d(20, 0, 0)));
+    BOOST_CHECK(index.getBoundary(*inB, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(19, 9, -1)));
+    BOOST_CHECK(index.getBoundary(*inC, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(-1, -1, 9)));
+
+    //the inverse direction of a tree edge works as well
+    graph.updateTransform("b", "a", translation(Eigen::Vector3d(0, -30, 0)));
+    BOOST_CHECK(index.getBoundary(*inB, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(19, 29, -1)));
+
+    //removing a tree edge makes its subtree unreachable, re-adding it restores it
+    graph.removeTransform("a", "b");
+    BOOST_CHECK(!index.getBoundary(*inB, box));
+    graph.addTransform("c", "b", translation(Eigen::Vector3d(5, 0, 0)));
+    BOOST_CHECK(index.getBoundary(*inB, box));
+    BOOST_CHECK(box.min().isApprox(Eigen::Vector3d(4, -1, 9)));
+    BOOST_CHECK_EQUAL(index.size(), 2);
+}
+
+typedef boost::mpl::list<float, double> box_set_scalars;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(aligned_box_set_test, Scalar, box_set_scalars)
+{
+    typedef AlignedBoxSet<Scalar> BoxSet;
+    typedef typename BoxSet::Box Box;
+    typedef typename BoxSet::Vector Vector;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<Scalar> coord(-10, 10);
+    std::uniform_real_distribution<Scalar> extent(0, 3);
+    auto randomVector = [&]() { return Vector(coord(rng), coord(rng), coord(rng)); };
+    auto randomBox = [&]()
+    {
+        const Vector min = randomVector();
+        return Box(min, min + Vector(extent(rng), extent(rng), extent(rng)));
+    };
+
+    const size_t n = 1000;
+    BoxSet set;
+    for(size_t i = 0; i < n; ++i)
+    {
+        set.push_back(randomBox());
+    }
+    set.push_back(Box()); //empty boxes never hit
+    BOOST_CHECK_EQUAL(set.size(), n + 1);
+
+    const Box query = randomBox().extend(randomBox());
+    const Vector point = randomVector();
+    typename BoxSet::Mask hits;
+    typename BoxSet::Values distances;
+    BoxSet intersections;
+
+    set.intersects(query, hits);
+    BOOST_CHECK_EQUAL(hits.size(), n + 1);
+    for(size_t i = 0; i <= n; ++i)
+    {
+        BOOST_CHECK_EQUAL(hits[i], set.get(i).intersects(query));
+    }
+    set.intersection(query, intersections);
+    for(size_t i = 0; i < n; ++i)
+    {
+        BOOST_CHECK_EQUAL(intersections.get(i).isEmpty(), !hits[i]);
+        if(hits[i])
+        {
+            BOOST_CHECK(intersections.get(i).isApprox(set.get(i).intersection(query)));
+        }
+    }
+    set.contains(point, hits);
+    for(size_t i = 0; i <= n; ++i)
+    {
+        BOOST_CHECK_EQUAL(hits[i], set.get(i).contains(point));
+    }
+    set.squaredExteriorDistance(point, distances);
+    for(size_t i = 0; i < n; ++i)
+    {
+        BOOST_CHECK_CLOSE(distances[i] + 1, set.get(i).squaredExteriorDistance(point) + 1, 1e-3);
+    }
+
+    typename BoxSet::PointSet points(n, 3);
+    for(size_t i = 0; i < n; ++i)
+    {
+        points.row(i) = randomVector().transpose();
+    }
+    BoxSet::contains(query, points, hits);
+    BoxSet::squaredExteriorDistance(query, points, distances);
+    for(size_t i = 0; i < n; ++i)
+    {
+        const Vector p = points.row(i).transpose();
+        BOOST_CHECK_EQUAL(hits[i], query.contains(p));
+        BOOST_CHECK_CLOSE(distances[i] + 1, query.squaredExteriorDistance(p) + 1, 1e-3);
+    }
+}
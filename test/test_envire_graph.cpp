@@ -32,12 +32,31 @@
 #include <envire_core/events/GraphItemEventDispatcher.hpp>
 #include <envire_core/items/Item.hpp>
 #include <envire_core/graph/GraphDrawing.hpp>
+#include <envire_core/util/ThreadSaveEnvireGraph.hpp>
+#include <envire_core/serialization/SerializationRegistration.hpp>
+#include <envire_core/items/ItemMetadata.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
 #include <vector>
+#include <sstream>
+#include <thread>
+#include <set>
 
 
 using namespace envire::core;
 using namespace std;
 
+typedef Item<vector<int>> IntVectorItem;
+ENVIRE_REGISTER_SERIALIZATION(envire::core::Item<std::vector<int>>, std::vector<int>)
+static MetadataInitializer intVectorItemMetadata(typeid(IntVectorItem), "std::vector<int>",
+                                                 "envire::core::Item<std::vector<int>>");
+
+typedef Item<vector<string>> StringVectorItem;
+ENVIRE_REGISTER_SERIALIZATION(envire::core::Item<std::vector<std::string>>, std::vector<std::string>)
+static MetadataInitializer stringVectorItemMetadata(typeid(StringVectorItem), "std::vector<std::string>",
+                                                    "envire::core::Item<std::vector<std::string>>");
+
 
 
 class EnvireDispatcher : public GraphEventDispatcher {
@@ -130,6 +149,38 @@ BOOST_AUTO_TEST_CASE(copy_with_items_test)
     BOOST_CHECK(g2.getTotalItemCount(frame) == 2);
 }
 
+BOOST_AUTO_TEST_CASE(copy_assignment_test)
+{
+    EnvireGraph g;
+    g.addTransform("a", "b", Transform(base::Position(1, 0, 0), base::Orientation::Identity()));
+    g.addItemToFrame("b", Item<string>::create("lalala"));
+    g.enableStatistics();
+
+    EnvireGraph g2;
+    g2.addTransform("a", "c", Transform(base::Position(0, 1, 0), base::Orientation::Identity()));
+    g2.addItemToFrame("c", Item<string>::create("lululu"));
+    g2.addItemToFrame("c", Item<string>::create("lelele"));
+    EnvireDispatcher dispatcher(g2);
+    TreeView view;
+    g2.getTree("a", true, &view);
+
+    g2 = g;
+    BOOST_CHECK(g2.containsFrame("b"));
+    BOOST_CHECK(!g2.containsFrame("c"));
+    BOOST_CHECK_EQUAL(g2.getAllItemCount<Item<string>>(), 1);
+    BOOST_CHECK_EQUAL(g2.getItem<Item<string>>("b")->getData(), "lalala");
+    //the subscribers of g2 are kept and see the replacement
+    BOOST_CHECK_EQUAL(dispatcher.itemRemovedEvents.size(), 2);
+    BOOST_CHECK_EQUAL(dispatcher.itemAddedEvents.size(), 1);
+    BOOST_CHECK(view.vertexExists(g2.getVertex("b")));
+    BOOST_CHECK(g2.getStatistics() == nullptr);
+
+    //the source keeps its own state
+    g2.addFrame("d");
+    BOOST_CHECK(!g.containsFrame("d"));
+    BOOST_CHECK(g.getStatistics() != nullptr);
+}
+
 BOOST_AUTO_TEST_CASE(simple_add_item_test)
 {
     FrameId aFrame = "frame_a";
@@ -776,6 +827,127 @@ BOOST_AUTO_TEST_CASE(envire_graph_save_load_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(envire_graph_skip_unknown_items_test)
+{
+    EnvireGraph graph;
+    graph.addTransform("a", "b", Transform(base::Position(1, 2, 3), base::Orientation::Identity()));
+    for(int i = 0; i < 3; ++i)
+    {
+        graph.addItemToFrame("a", IntVectorItem::create(vector<int>(10, i)));
+        graph.addItemToFrame("b", StringVectorItem::create(vector<string>(i + 1, "text")));
+    }
+    graph.saveToFile("skip_unknown_items_test");
+
+    EnvireGraph loadGraph;
+    loadGraph.loadFromFile("skip_unknown_items_test");
+    BOOST_CHECK_EQUAL(loadGraph.getItemCount<IntVectorItem>("a"), 3);
+    BOOST_CHECK_EQUAL(loadGraph.getItemCount<StringVectorItem>("b"), 3);
+    BOOST_CHECK_EQUAL(loadGraph.getItem<IntVectorItem>("a", 2)->getData()[9], 2);
+
+    //unknown items are skipped using their size, the following items are loaded
+    const string intVectorClass = "envire::core::Item<std::vector<int>>";
+    auto handle = Serialization::getHandleMap()[intVectorClass];
+    Serialization::getHandleMap().erase(intVectorClass);
+    EnvireGraph partialGraph;
+    partialGraph.loadFromFile("skip_unknown_items_test");
+    Serialization::getHandleMap()[intVectorClass] = handle;
+
+    BOOST_CHECK_EQUAL(partialGraph.getTotalItemCount("a"), 0);
+    BOOST_CHECK_EQUAL(partialGraph.getItemCount<StringVectorItem>("b"), 3);
+    BOOST_CHECK_EQUAL(partialGraph.getItem<StringVectorItem>("b", 2)->getData().size(), 3);
+    BOOST_CHECK(partialGraph.getTransform("a", "b").transform.translation.isApprox(base::Position(1, 2, 3)));
+    std::remove("skip_unknown_items_test");
+}
+
+BOOST_AUTO_TEST_CASE(envire_graph_partial_load_test)
+{
+    EnvireGraph graph;
+    Transform tf(base::Position(1, 0, 0), base::Orientation::Identity());
+    graph.addTransform("world", "robot", tf);
+    graph.addTransform("robot", "arm", tf);
+    graph.addTransform("world", "map", tf);
+    for(const FrameId& frame : std::vector<FrameId>{"robot", "arm", "map"})
+    {
+        graph.addItemToFrame(frame, IntVectorItem::create(vector<int>(10, 1)));
+        graph.addItemToFrame(frame, StringVectorItem::create(vector<string>(2, frame)));
+    }
+    graph.saveToFile("partial_load_test");
+
+    GraphLoadOptions structureOnly;
+    structureOnly.structureOnly = true;
+    EnvireGraph structure;
+    structure.loadFromFile("partial_load_test", structureOnly);
+    BOOST_CHECK_EQUAL(structure.num_vertices(), 4);
+    BOOST_CHECK_EQUAL(structure.num_edges(), 6);
+    BOOST_CHECK_EQUAL(structure.getTotalItemCount("robot"), 0);
+
+    EnvireGraph strings;
+    strings.loadFromFile("partial_load_test", GraphLoadOptions().includeItems<StringVectorItem>());
+    BOOST_CHECK_EQUAL(strings.getTotalItemCount("arm"), 1);
+    BOOST_CHECK_EQUAL(strings.getItem<StringVectorItem>("arm")->getData()[0], "arm");
+
+    EnvireGraph robot;
+    GraphLoadOptions subtree;
+    subtree.selectSubtree(structure, structure.getTree("world"), "robot");
+    subtree.excludeItems<StringVectorItem>();
+    robot.loadFromFile("partial_load_test", subtree);
+    BOOST_CHECK_EQUAL(robot.num_vertices(), 2);
+    BOOST_CHECK_EQUAL(robot.num_edges(), 2);
+    BOOST_CHECK(!robot.containsFrame("map"));
+    BOOST_CHECK_EQUAL(robot.getTotalItemCount("arm"), 1);
+    BOOST_CHECK_EQUAL(robot.getItemCount<IntVectorItem>("arm"), 1);
+
+    //unselected frames are dropped before anyone can see them
+    struct RemovalCounter : public GraphEventDispatcher
+    {
+        explicit RemovalCounter(EnvireGraph& graph) : GraphEventDispatcher(&graph) {}
+        void frameRemoved(const FrameRemovedEvent& e) override { ++removals; }
+        void edgeRemoved(const EdgeRemovedEvent& e) override { ++removals; }
+        int removals = 0;
+    };
+    EnvireGraph map;
+    RemovalCounter counter(map);
+    map.loadFromFile("partial_load_test", GraphLoadOptions().selectFramesMatching("world|map"));
+    BOOST_CHECK_EQUAL(counter.removals, 0);
+    BOOST_CHECK_EQUAL(map.num_vertices(), 2);
+    BOOST_CHECK_EQUAL(map.num_edges(), 2);
+    BOOST_CHECK_EQUAL(map.getTotalItemCount("map"), 2);
+    BOOST_CHECK(map.getTransform("world", "map").transform.translation.isApprox(base::Position(1, 0, 0)));
+    std::remove("partial_load_test");
+}
+
+BOOST_AUTO_TEST_CASE(envire_graph_text_item_records_test)
+{
+    EnvireGraph graph;
+    graph.addFrame("a");
+    graph.addFrame("b");
+    graph.addItemToFrame("a", IntVectorItem::create(vector<int>(3, 7)));
+    graph.addItemToFrame("b", StringVectorItem::create(vector<string>(2, "readable_text")));
+
+    //text archives embed the items as text
+    std::stringstream stream;
+    {
+        boost::archive::text_oarchive oa(stream);
+        oa << graph;
+    }
+    BOOST_CHECK(stream.str().find("readable_text") != string::npos);
+
+    const string intVectorClass = "envire::core::Item<std::vector<int>>";
+    auto handle = Serialization::getHandleMap()[intVectorClass];
+    Serialization::getHandleMap().erase(intVectorClass);
+    EnvireGraph loadGraph;
+    {
+        boost::archive::text_iarchive ia(stream);
+        ia >> loadGraph;
+    }
+    Serialization::getHandleMap()[intVectorClass] = handle;
+
+    BOOST_CHECK_EQUAL(loadGraph.getTotalItemCount("a"), 0);
+    BOOST_REQUIRE_EQUAL(loadGraph.getItemCount<StringVectorItem>("b"), 1);
+    const StringVectorItem& item = *loadGraph.getItem<StringVectorItem>("b");
+    BOOST_CHECK(item.getData() == vector<string>(2, "readable_text"));
+}
+
 BOOST_AUTO_TEST_CASE(envire_graph_structural_copy_test)
 {
     FrameId a = "frame_a";
@@ -825,3 +997,791 @@ BOOST_AUTO_TEST_CASE(bfs_visitor_test)
     BOOST_CHECK_NO_THROW(graph.getFrames(a, a));
 }
 
+BOOST_AUTO_TEST_CASE(transaction_item_events_test)
+{
+    EnvireGraph g;
+    EnvireDispatcher dispatcher(g);
+    g.addFrame("a");
+
+    Item<string>::Ptr kept(new Item<string>("kept"));
+    Item<string>::Ptr removed(new Item<string>("removed"));
+    {
+        EnvireGraph::Transaction transaction(g);
+        g.addItemToFrame("a", kept);
+        g.addItemToFrame("a", removed);
+        g.removeItemFromFrame(removed);
+        BOOST_CHECK(dispatcher.itemAddedEvents.empty());
+        BOOST_CHECK(dispatcher.itemRemovedEvents.empty());
+    }
+    BOOST_CHECK(dispatcher.itemAddedEvents.size() == 2);
+    BOOST_CHECK(dispatcher.itemRemovedEvents.size() == 1);
+    BOOST_CHECK(dispatcher.itemAddedEvents[0].item == kept);
+    BOOST_CHECK(g.getItemCount<Item<string>>("a") == 1);
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_frame_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    //existing frames are ready immediately
+    BOOST_CHECK(g.waitForFrame("a").wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    BOOST_CHECK(!g.hasActiveSubscribers());
+
+    std::shared_future<void> b = g.waitForFrame("b");
+    std::shared_future<void> b2 = g.waitForFrame("b");
+    BOOST_CHECK(b.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    BOOST_CHECK(g.hasActiveSubscribers());
+    g.addFrame("c");
+    BOOST_CHECK(b.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    g.addFrame("b");
+    BOOST_CHECK(b.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    BOOST_CHECK(b2.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    //the waiter unsubscribes once nothing is pending
+    BOOST_CHECK(!g.hasActiveSubscribers());
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_transform_test)
+{
+    EnvireGraph g;
+    Transform ab(base::Position(1, 0, 0), base::Orientation::Identity());
+    Transform bc(base::Position(0, 2, 0), base::Orientation::Identity());
+
+    std::shared_future<Transform> ac = g.waitForTransform("a", "c");
+    g.addTransform("a", "b", ab);
+    BOOST_CHECK(ac.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    {
+        EnvireGraph::Transaction transaction(g);
+        g.addTransform("b", "c", bc);
+        BOOST_CHECK(ac.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    }
+    BOOST_REQUIRE(ac.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    BOOST_CHECK(ac.get().transform.translation.isApprox(base::Position(1, 2, 0)));
+
+    std::shared_future<Transform> ba = g.waitForTransform("b", "a");
+    BOOST_REQUIRE(ba.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    BOOST_CHECK(ba.get().transform.translation.isApprox(base::Position(-1, 0, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(wait_for_transform_broken_promise_test)
+{
+    std::shared_future<Transform> future;
+    {
+        EnvireGraph g;
+        future = g.waitForTransform("a", "b");
+    }
+    BOOST_CHECK_THROW(future.get(), std::future_error);
+}
+
+BOOST_AUTO_TEST_CASE(cancel_wait_test)
+{
+    EnvireGraph g;
+    std::shared_future<void> a = g.waitForFrame("a");
+    std::shared_future<void> a2 = g.waitForFrame("a");
+    //the wait is kept while someone still waits for it
+    g.cancelWaitForFrame("a");
+    BOOST_CHECK(g.hasActiveSubscribers());
+    g.cancelWaitForFrame("a");
+    BOOST_CHECK(!g.hasActiveSubscribers());
+    BOOST_CHECK_THROW(a2.get(), std::future_error);
+
+    g.waitForTransform("a", "b");
+    g.cancelWaitForTransform("a", "b");
+    BOOST_CHECK(!g.hasActiveSubscribers());
+    //fulfilled waits cannot be cancelled
+    g.cancelWaitForFrame("c");
+}
+
+BOOST_AUTO_TEST_CASE(thread_save_wait_for_transform_test)
+{
+    ThreadSaveEnvireGraph g;
+    Transform tf(base::Position(1, 0, 0), base::Orientation::Identity());
+    BOOST_CHECK(!g.waitForFrame("a", std::chrono::milliseconds(1)));
+    //the timed out wait does not stay subscribed
+    BOOST_CHECK(!g.getUnsafeGraph()->hasActiveSubscribers());
+    Transform unresolved;
+    BOOST_CHECK(!g.waitForTransform("a", "b", std::chrono::milliseconds(1), unresolved));
+    BOOST_CHECK(!g.getUnsafeGraph()->hasActiveSubscribers());
+
+    std::thread producer([&g, &tf]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        g.addTransform("a", "b", tf);
+    });
+    Transform result;
+    BOOST_CHECK(g.waitForTransform("a", "b", std::chrono::seconds(10), result));
+    BOOST_CHECK(result.transform.translation.isApprox(tf.transform.translation));
+    BOOST_CHECK(g.waitForFrame("a", std::chrono::milliseconds(0)));
+    producer.join();
+}
+
+BOOST_AUTO_TEST_CASE(item_type_map_test)
+{
+    const ItemTypeId stringId = getItemTypeId<Item<string>>();
+    const ItemTypeId intId = getItemTypeId<Item<int>>();
+    BOOST_CHECK(stringId != intId);
+    BOOST_CHECK(getItemTypeId(std::type_index(typeid(Item<string>))) == stringId);
+    BOOST_CHECK(Item<string>("a").getTypeId() == stringId);
+
+    Frame::ItemMap map;
+    BOOST_CHECK(map.empty());
+    map[std::type_index(typeid(Item<string>))].push_back(Item<string>::Ptr(new Item<string>("a")));
+    map.getOrCreate(std::type_index(typeid(Item<int>)), intId).push_back(Item<int>::Ptr(new Item<int>(1)));
+    BOOST_CHECK(map.size() == 2);
+    BOOST_CHECK(map.find(intId) == map.find(std::type_index(typeid(Item<int>))));
+    BOOST_CHECK(map.find(stringId)->second.size() == 1);
+    BOOST_CHECK(map.find(getItemTypeId<Item<double>>()) == map.end());
+    BOOST_CHECK_THROW(map.at(std::type_index(typeid(Item<double>))), std::out_of_range);
+    //the insertion order is retained
+    BOOST_CHECK(map.begin()->first == std::type_index(typeid(Item<string>)));
+    BOOST_CHECK(map.erase(std::type_index(typeid(Item<string>))) == 1);
+    BOOST_CHECK(map.size() == 1);
+    BOOST_CHECK(map.begin()->typeId == intId);
+}
+
+BOOST_AUTO_TEST_CASE(remove_item_iterator_keeps_remaining_items_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    Item<int>::Ptr first(new Item<int>(1));
+    Item<int>::Ptr second(new Item<int>(2));
+    g.addItemToFrame("a", first);
+    g.addItemToFrame("a", second);
+
+    //removing the last item of a list must not drop the other items
+    EnvireGraph::ItemIterator<Item<int>> it = g.getItem<Item<int>>("a", 1);
+    g.removeItemFromFrame("a", it);
+    BOOST_CHECK(g.getItemCount<Item<int>>("a") == 1);
+    BOOST_CHECK(g.getItem<Item<int>>("a")->getData() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(item_uuid_index_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    g.addFrame("b");
+    std::vector<Item<int>::Ptr> items;
+    for(int i = 0; i < 5; ++i)
+    {
+        items.emplace_back(new Item<int>(i));
+        g.addItemToFrame("a", items.back());
+    }
+    Item<std::string>::Ptr other(new Item<std::string>("other"));
+    g.addItemToFrame("b", other);
+
+    for(const Item<int>::Ptr& item : items)
+    {
+        BOOST_CHECK(g.containsItem(item->getID()));
+        BOOST_CHECK(g.getItemById(item->getID()) == item);
+    }
+    BOOST_CHECK(g.getItemById(other->getID()) == other);
+
+    //swap-remove moves the last item into the gap, the index has to follow
+    g.removeItemById(items[1]->getID());
+    BOOST_CHECK(!g.containsItem(items[1]->getID()));
+    BOOST_CHECK(items[1]->getFrame().empty());
+    BOOST_CHECK_THROW(g.getItemById(items[1]->getID()), UnknownItemIdException);
+    BOOST_CHECK_THROW(g.removeItemById(items[1]->getID()), UnknownItemIdException);
+    BOOST_CHECK(g.getItemCount<Item<int>>("a") == 4);
+    BOOST_CHECK(g.getItemById(items[4]->getID()) == items[4]);
+
+    g.removeItemFromFrame(items[4]);
+    g.removeItemFromFrame(items[0]);
+    BOOST_CHECK(g.getItemCount<Item<int>>("a") == 2);
+    BOOST_CHECK(g.getItemById(items[2]->getID()) == items[2]);
+    BOOST_CHECK(g.getItemById(items[3]->getID()) == items[3]);
+
+    EnvireGraph::ItemIterator<Item<int>> it = g.getItem<Item<int>>("a", 0);
+    const boost::uuids::uuid removed = it->getID();
+    const Item<int>::Ptr kept = items[it->getData() == 2 ? 3 : 2];
+    g.removeItemFromFrame("a", it);
+    BOOST_CHECK(!g.containsItem(removed));
+    BOOST_CHECK(g.getItemById(kept->getID()) == kept);
+
+    //copies have their own index
+    EnvireGraph copy(g);
+    BOOST_CHECK(copy.containsItem(kept->getID()));
+    BOOST_CHECK(copy.containsItem(other->getID()));
+
+    g.clearFrame("a");
+    BOOST_CHECK(!g.containsItem(kept->getID()));
+    BOOST_CHECK(g.containsItem(other->getID()));
+    g.removeFrame("b");
+    BOOST_CHECK(!g.containsItem(other->getID()));
+    BOOST_CHECK(copy.containsItem(kept->getID()));
+}
+
+BOOST_AUTO_TEST_CASE(item_type_index_test)
+{
+    EnvireGraph g;
+    BOOST_CHECK(g.getAllItemCount<Item<int>>() == 0);
+    EnvireGraph::ItemIteratorPair<Item<int>> range = g.getAllItems<Item<int>>();
+    BOOST_CHECK(range.first == range.second);
+
+    g.addFrame("a");
+    g.addFrame("b");
+    g.addFrame("c");
+    Item<int>::Ptr a1(new Item<int>(1));
+    Item<int>::Ptr a2(new Item<int>(2));
+    Item<int>::Ptr b3(new Item<int>(3));
+    Item<std::string>::Ptr c(new Item<std::string>("c"));
+    g.addItemToFrame("a", a1);
+    g.addItemToFrame("a", a2);
+    g.addItemToFrame("b", b3);
+    g.addItemToFrame("c", c);
+
+    BOOST_CHECK(g.getAllItemCount<Item<int>>() == 3);
+    BOOST_CHECK(g.getAllItemCount<Item<std::string>>() == 1);
+    BOOST_CHECK(g.getAllItemCount(std::type_index(typeid(Item<int>))) == 3);
+    int sum = 0;
+    range = g.getAllItems<Item<int>>();
+    for(EnvireGraph::ItemIterator<Item<int>> it = range.first; it != range.second; ++it)
+    {
+        sum += it->getData();
+        BOOST_CHECK(it->getFrame() == (it->getData() == 3 ? "b" : "a"));
+    }
+    BOOST_CHECK(sum == 6);
+
+    g.removeItemFromFrame(a1);
+    BOOST_CHECK(g.getAllItemCount<Item<int>>() == 2);
+    g.removeFrame("b");
+    BOOST_CHECK(g.getAllItemCount<Item<int>>() == 1);
+    BOOST_CHECK(g.getAllItems<Item<int>>().first->getData() == 2);
+    const Frame::ItemList& strings = g.getAllItems(std::type_index(typeid(Item<std::string>)));
+    BOOST_CHECK(strings.size() == 1 && strings[0] == c);
+
+    EnvireGraph copy(g);
+    BOOST_CHECK(copy.getAllItemCount<Item<int>>() == 1);
+    g.clear();
+    BOOST_CHECK(g.getAllItemCount<Item<int>>() == 0);
+    BOOST_CHECK(g.getAllItemCount<Item<std::string>>() == 0);
+    BOOST_CHECK(copy.getAllItemCount<Item<std::string>>() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(item_factory_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    Item<int>::Ptr created = Item<int>::create(42);
+    Item<int>::Ptr pooled = Item<int>::createPooled(43);
+    Item<std::string>::Ptr empty = Item<std::string>::createPooled();
+    BOOST_CHECK(created->getData() == 42);
+    BOOST_CHECK(pooled->getData() == 43);
+    BOOST_CHECK(empty->getData().empty());
+    BOOST_CHECK(created->getID() != pooled->getID());
+
+    g.addItemToFrame("a", created);
+    g.addItemToFrame("a", pooled);
+    BOOST_CHECK(g.getItemCount<Item<int>>("a") == 2);
+    g.clearFrame("a");
+
+    //memory of destroyed items is reused
+    std::vector<Item<int>::Ptr> items;
+    for(int i = 0; i < 100; ++i)
+    {
+        items.push_back(Item<int>::createPooled(i));
+    }
+    items.erase(items.begin(), items.begin() + 50);
+    for(int i = 0; i < 50; ++i)
+    {
+        items.push_back(Item<int>::createPooled(i));
+    }
+    int sum = 0;
+    for(const Item<int>::Ptr& item : items)
+    {
+        sum += item->getData();
+    }
+    BOOST_CHECK(sum == (50 + 99) * 50 / 2 + 49 * 50 / 2);
+}
+
+BOOST_AUTO_TEST_CASE(uuid_generator_test)
+{
+    std::vector<std::vector<boost::uuids::uuid>> ids(4);
+    std::vector<std::thread> threads;
+    for(std::vector<boost::uuids::uuid>& threadIds : ids)
+    {
+        threads.emplace_back([&threadIds]()
+        {
+            for(int i = 0; i < 10000; ++i)
+            {
+                threadIds.push_back(UUIDGenerator::generate());
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    std::set<boost::uuids::uuid> unique;
+    for(const std::vector<boost::uuids::uuid>& threadIds : ids)
+    {
+        unique.insert(threadIds.begin(), threadIds.end());
+    }
+    BOOST_CHECK(unique.size() == 40000);
+    const boost::uuids::uuid id = UUIDGenerator::generate();
+    BOOST_CHECK(id.version() == boost::uuids::uuid::version_random_number_based);
+    BOOST_CHECK(id.variant() == boost::uuids::uuid::variant_rfc_4122);
+}
+
+BOOST_AUTO_TEST_CASE(lazy_item_id_test)
+{
+    ItemBase::setLazyIDs(true);
+    Item<int> lazy(1);
+    Item<int> other(2);
+    ItemBase::setLazyIDs(false);
+
+    const boost::uuids::uuid id = lazy.getID();
+    BOOST_CHECK(!id.is_nil());
+    BOOST_CHECK(lazy.getID() == id);
+    BOOST_CHECK(other.getID() != id);
+
+    //copies keep the id, even if it has not been generated yet
+    ItemBase::setLazyIDs(true);
+    Item<int> original(3);
+    ItemBase::setLazyIDs(false);
+    Item<int> copy(original);
+    BOOST_CHECK(!copy.getID().is_nil());
+    BOOST_CHECK(copy.getID() == original.getID());
+
+    ItemBase::setLazyIDs(true);
+    Item<int> assigned(4);
+    ItemBase::setLazyIDs(false);
+    const boost::uuids::uuid fixed = UUIDGenerator::generate();
+    assigned.setID(fixed);
+    BOOST_CHECK(assigned.getID() == fixed);
+}
+
+/**Counts how often the id is requested */
+class IdCountingItem : public Item<int>
+{
+public:
+    IdCountingItem() : idRequests(0) {}
+
+    virtual const boost::uuids::uuid& getID() const
+    {
+        ++idRequests;
+        return Item<int>::getID();
+    }
+
+    mutable int idRequests;
+};
+
+BOOST_AUTO_TEST_CASE(lazy_item_id_graph_test)
+{
+    ItemBase::setLazyIDs(true);
+    boost::shared_ptr<IdCountingItem> first = boost::make_shared<IdCountingItem>();
+    boost::shared_ptr<IdCountingItem> second = boost::make_shared<IdCountingItem>();
+    ItemBase::setLazyIDs(false);
+
+    //the graph does not need the ids until an item is searched by id
+    EnvireGraph g;
+    g.addFrame("a");
+    g.addItemToFrame("a", first);
+    g.addItemToFrame("a", second);
+    g.removeItemFromFrame(first);
+    g.addItemToFrame("a", first);
+    BOOST_CHECK_EQUAL(first->idRequests, 0);
+    BOOST_CHECK_EQUAL(second->idRequests, 0);
+
+    BOOST_CHECK(g.getItemById(second->getID()) == second);
+    BOOST_CHECK(g.containsItem(first->getID()));
+    g.removeItemById(first->getID());
+    BOOST_CHECK(!g.containsItem(first->getID()));
+    //the index is kept up to date afterwards
+    Item<int>::Ptr added = Item<int>::create(3);
+    g.addItemToFrame("a", added);
+    BOOST_CHECK(g.getItemById(added->getID()) == added);
+}
+
+BOOST_AUTO_TEST_CASE(item_time_constructor_test)
+{
+    const base::Time time = base::Time::fromSeconds(42);
+    Item<std::string> copied(std::string("copied"), time, "a");
+    BOOST_CHECK(copied.getTime() == time);
+    BOOST_CHECK(copied.getFrame() == "a");
+    BOOST_CHECK(copied.getData() == "copied");
+
+    std::vector<int> data(100, 1);
+    const int* buffer = data.data();
+    Item<std::vector<int>>::Ptr moved = Item<std::vector<int>>::create(std::move(data), time);
+    BOOST_CHECK(moved->getData().data() == buffer);
+    BOOST_CHECK(moved->getTime() == time);
+    BOOST_CHECK(moved->getFrame().empty());
+
+    //moved-from items stay usable
+    Item<std::vector<int>> source(std::vector<int>(10, 1));
+    Item<std::vector<int>> target(std::move(source));
+    BOOST_CHECK(target.getData().size() == 10);
+    BOOST_CHECK(source.getData().empty());
+    source.getMutableData().push_back(2);
+    target = std::move(source);
+    BOOST_CHECK(target.getData().size() == 1);
+    BOOST_CHECK(source.getData().empty());
+
+    EnvireGraph g;
+    g.addFrame("b");
+    g.addItem(Item<int>::create(1, time, "b"));
+    BOOST_CHECK(g.getItem<Item<int>>("b")->getTime() == time);
+}
+
+namespace
+{
+    /**Payload that counts how often it has been copied */
+    struct CountedPayload
+    {
+        static int copies;
+        std::vector<int> data;
+        CountedPayload() = default;
+        explicit CountedPayload(size_t size) : data(size, 1) {}
+        CountedPayload(const CountedPayload& other) : data(other.data) { ++copies; }
+        CountedPayload(CountedPayload&& other) = default;
+        CountedPayload& operator=(const CountedPayload& other) { data = other.data; ++copies; return *this; }
+        CountedPayload& operator=(CountedPayload&& other) = default;
+    };
+    int CountedPayload::copies = 0;
+}
+
+BOOST_AUTO_TEST_CASE(emplace_item_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    CountedPayload::copies = 0;
+
+    Item<CountedPayload>::Ptr item = g.emplaceItem<Item<CountedPayload>>("a", CountedPayload(1000));
+    BOOST_CHECK(CountedPayload::copies == 0);
+    BOOST_CHECK(item->getData().data.size() == 1000);
+    BOOST_CHECK(item->getFrame() == "a");
+    BOOST_CHECK(g.getItemCount<Item<CountedPayload>>("a") == 1);
+
+    CountedPayload payload(10);
+    Item<CountedPayload> moved(std::move(payload));
+    BOOST_CHECK(CountedPayload::copies == 0);
+    ItemBase::Ptr clone = moved.clone();
+    BOOST_CHECK(CountedPayload::copies == 0);
+    BOOST_CHECK(clone->getID() == moved.getID());
+
+    BOOST_CHECK_THROW(g.emplaceItem<Item<int>>("unknown", 1), UnknownFrameException);
+}
+
+BOOST_AUTO_TEST_CASE(add_items_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    g.addFrame("b");
+    std::vector<Item<int>::Ptr> items;
+    for(int i = 0; i < 10; ++i)
+    {
+        items.push_back(Item<int>::create(i));
+    }
+    g.addItemsToFrame("a", items.begin(), items.end());
+    BOOST_CHECK(g.getItemCount<Item<int>>("a") == 10);
+    BOOST_CHECK(items[3]->getFrame() == "a");
+
+    std::vector<ItemBase::Ptr> mixed;
+    mixed.push_back(Item<int>::create(1, base::Time::now(), "b"));
+    mixed.push_back(Item<std::string>::create("x", base::Time::now(), "b"));
+    g.addItems(mixed.begin(), mixed.end());
+    BOOST_CHECK(g.getTotalItemCount("b") == 2);
+    BOOST_CHECK_THROW(g.addItemsToFrame("c", items.begin(), items.end()), UnknownFrameException);
+}
+
+BOOST_AUTO_TEST_CASE(copy_on_write_item_test)
+{
+    CountedPayload::copies = 0;
+    Item<CountedPayload> original(CountedPayload(10));
+    BOOST_CHECK(!original.isDataShared());
+
+    Item<CountedPayload>::Ptr clone = boost::static_pointer_cast<Item<CountedPayload>>(original.clone());
+    Item<CountedPayload> copy(original);
+    BOOST_CHECK(original.isDataShared());
+    BOOST_CHECK(CountedPayload::copies == 0);
+    const Item<CountedPayload>& constClone = *clone;
+    const Item<CountedPayload>& constCopy = copy;
+    BOOST_CHECK(&constClone.getData() == &constCopy.getData());
+    //reading through non-const items does not detach either
+    BOOST_CHECK(&clone->getData() == &copy.getData());
+    BOOST_CHECK(clone->isDataShared());
+    BOOST_CHECK(CountedPayload::copies == 0);
+
+    //the first write detaches
+    clone->getMutableData().data[0] = 42;
+    BOOST_CHECK(CountedPayload::copies == 1);
+    BOOST_CHECK(!clone->isDataShared());
+    BOOST_CHECK(constCopy.getData().data[0] == 1);
+    clone->getMutableData().data[1] = 43;
+    BOOST_CHECK(CountedPayload::copies == 1);
+
+    //setData replaces shared data without copying it
+    copy.setData(CountedPayload(5));
+    BOOST_CHECK(CountedPayload::copies == 1);
+    BOOST_CHECK(!original.isDataShared());
+    BOOST_CHECK(original.getData().data.size() == 10);
+
+    //small payloads are stored inline
+    Item<int> small(1);
+    Item<int> smallCopy(small);
+    smallCopy.getMutableData() = 2;
+    BOOST_CHECK(!small.isDataShared());
+    BOOST_CHECK(small.getData() == 1);
+    //inline payloads can be written in place
+    small.getData() = 3;
+    BOOST_CHECK(small.getData() == 3);
+    BOOST_CHECK(!ItemPayloadIsShared<Eigen::Vector3d>::value);
+    BOOST_CHECK(!ItemPayloadIsShared<Eigen::Quaterniond>::value);
+    BOOST_CHECK(!ItemPayloadIsShared<Eigen::Affine3d>::value);
+    BOOST_CHECK(ItemPayloadIsShared<Eigen::VectorXd>::value);
+    BOOST_CHECK(ItemPayloadIsShared<std::vector<double>>::value);
+}
+
+BOOST_AUTO_TEST_CASE(isolated_copy_test)
+{
+    EnvireGraph g;
+    g.addTransform("a", "b", Transform());
+    Item<std::string>::Ptr item = Item<std::string>::create("original");
+    g.addItemToFrame("a", item);
+    g.addItemToFrame("b", Item<int>::create(1));
+
+    EnvireGraph copy;
+    g.createIsolatedCopy(copy);
+    BOOST_CHECK(copy.num_edges() == g.num_edges());
+    BOOST_CHECK(copy.getTotalItemCount("b") == 1);
+    EnvireGraph::ItemIterator<Item<std::string>> copied = copy.getItem<Item<std::string>>("a");
+    BOOST_CHECK(copied->getID() == item->getID());
+    BOOST_CHECK(copied->isDataShared());
+
+    copied->getMutableData() = "modified";
+    BOOST_CHECK(item->getData() == "original");
+    BOOST_CHECK(g.getItem<Item<std::string>>("a")->getData() == "original");
+    copy.clearFrame("a");
+    BOOST_CHECK(g.getItemCount<Item<std::string>>("a") == 1);
+}
+
+BOOST_AUTO_TEST_CASE(item_span_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    BOOST_CHECK(g.getItemSpan<Item<int>>("a").empty());
+    BOOST_CHECK_THROW(g.getItemSpan<Item<int>>("unknown"), UnknownFrameException);
+
+    for(int i = 0; i < 5; ++i)
+    {
+        g.addItemToFrame("a", Item<int>::create(i));
+    }
+    g.addItemToFrame("a", Item<std::string>::create("x"));
+
+    EnvireGraph::ItemSpan<Item<int>> span = g.getItemSpan<Item<int>>("a");
+    BOOST_CHECK(span.size() == 5);
+    int sum = 0;
+    for(size_t i = 0; i < span.size(); ++i)
+    {
+        sum += span[i].getData();
+    }
+    BOOST_CHECK(sum == 10);
+    sum = 0;
+    for(const Item<int>& item : span)
+    {
+        sum += item.getData();
+    }
+    BOOST_CHECK(sum == 10);
+    BOOST_CHECK(g.getItemSpan<Item<std::string>>("a")[0].getData() == "x");
+}
+
+BOOST_AUTO_TEST_CASE(time_index_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    g.enableTimeIndex<Item<int>>("a");
+    BOOST_CHECK(g.hasTimeIndex<Item<int>>("a"));
+    BOOST_CHECK(!g.hasTimeIndex<Item<double>>("a"));
+    BOOST_CHECK_THROW(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(1)), NoItemsOfTypeInFrameException);
+
+    //out of order timestamps
+    const int seconds[] = {5, 1, 9, 3, 7};
+    std::vector<Item<int>::Ptr> items;
+    for(const int s : seconds)
+    {
+        items.push_back(Item<int>::create(s, base::Time::fromSeconds(s)));
+        g.addItemToFrame("a", items.back());
+        g.addItemToFrame("a", Item<double>::create(s, base::Time::fromSeconds(s)));
+    }
+
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        //the first pass uses the index, the second one scans the lists
+        std::vector<Item<int>::Ptr> range = g.getItemsInRange<Item<int>>("a", base::Time::fromSeconds(3),
+                                                                          base::Time::fromSeconds(7));
+        BOOST_REQUIRE(range.size() == 3);
+        BOOST_CHECK(range[0]->getData() == 3);
+        BOOST_CHECK(range[1]->getData() == 5);
+        BOOST_CHECK(range[2]->getData() == 7);
+        BOOST_CHECK(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(8.2))->getData() == 9);
+        BOOST_CHECK(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(0))->getData() == 1);
+        BOOST_CHECK(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(100))->getData() == 9);
+        BOOST_CHECK(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(4.4))->getData() == 5);
+        g.disableTimeIndex<Item<int>>("a");
+    }
+    BOOST_CHECK(g.getNearestItem<Item<double>>("a", base::Time::fromSeconds(2.9))->getData() == 3);
+
+    //the index follows removals and copies
+    g.enableTimeIndex<Item<int>>("a");
+    g.removeItemFromFrame(items[2]);
+    BOOST_CHECK(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(100))->getData() == 7);
+    EnvireGraph copy(g);
+    BOOST_CHECK(copy.hasTimeIndex<Item<int>>("a"));
+    BOOST_CHECK(copy.getItemsInRange<Item<int>>("a", base::Time::fromSeconds(0),
+                                                base::Time::fromSeconds(100)).size() == 4);
+    g.clearFrame("a");
+    BOOST_CHECK(g.hasTimeIndex<Item<int>>("a"));
+    BOOST_CHECK(g.getItemsInRange<Item<int>>("a", base::Time::fromSeconds(0),
+                                             base::Time::fromSeconds(100)).empty());
+    g.removeFrame("a");
+    g.addFrame("a");
+    BOOST_CHECK(!g.hasTimeIndex<Item<int>>("a"));
+}
+
+BOOST_AUTO_TEST_CASE(retention_policy_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    ItemEventSubscriber sub(g);
+
+    EnvireGraph::RetentionPolicy policy;
+    policy.maxCount = 10;
+    policy.checkInterval = 4;
+    g.setRetentionPolicy<Item<int>>("a", policy);
+    BOOST_CHECK(g.hasRetentionPolicy<Item<int>>("a"));
+    BOOST_CHECK(g.hasTimeIndex<Item<int>>("a"));
+    BOOST_CHECK(!g.hasRetentionPolicy<Item<float>>("a"));
+
+    for(int i = 0; i < 20; ++i)
+    {
+        g.addItemToFrame("a", Item<int>::create(i, base::Time::fromSeconds(i)));
+        g.addItemToFrame("a", Item<float>::create(i, base::Time::fromSeconds(i)));
+        //the limit is checked every checkInterval insertions
+        BOOST_CHECK(g.getItemCount<Item<int>>("a") < policy.maxCount + policy.checkInterval);
+    }
+    BOOST_CHECK_EQUAL(g.getItemCount<Item<float>>("a"), 20);
+    BOOST_CHECK_EQUAL(g.enforceRetentionPolicies(), g.getItemCount<Item<int>>("a") - policy.maxCount);
+    BOOST_CHECK_EQUAL(g.getItemCount<Item<int>>("a"), policy.maxCount);
+    //evicted items went through removeItemFromFrame, oldest first
+    BOOST_CHECK_EQUAL(sub.intItemRemovedEvents.size(), 10);
+    BOOST_CHECK_EQUAL(sub.intItemRemovedEvents.front().item->getData(), 0);
+    BOOST_CHECK_EQUAL(g.getItemsInRange<Item<int>>("a", base::Time::fromSeconds(0),
+                                                   base::Time::fromSeconds(9)).size(), 0);
+
+    //the age is relative to the newest item
+    policy = EnvireGraph::RetentionPolicy();
+    policy.maxAge = base::Time::fromSeconds(3);
+    g.setRetentionPolicy<Item<int>>("a", policy);
+    std::vector<Item<int>::Ptr> left = g.getItemsInRange<Item<int>>("a", base::Time::fromSeconds(0),
+                                                                    base::Time::fromSeconds(100));
+    BOOST_REQUIRE_EQUAL(left.size(), 4);
+    BOOST_CHECK_EQUAL(left.front()->getData(), 16);
+
+    //the size is estimated using getDataSize()
+    policy = EnvireGraph::RetentionPolicy();
+    policy.maxBytes = 2 * sizeof(int);
+    policy.checkInterval = 1;
+    g.setRetentionPolicy<Item<int>>("a", policy);
+    BOOST_CHECK_EQUAL(g.getItemCount<Item<int>>("a"), 2);
+    g.addItemToFrame("a", Item<int>::create(100, base::Time::fromSeconds(100)));
+    BOOST_CHECK_EQUAL(g.getItemCount<Item<int>>("a"), 2);
+    BOOST_CHECK(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(0))->getData() == 19);
+
+    //the byte total follows removals and a disabled time index is rebuilt
+    g.removeItemFromFrame(g.getNearestItem<Item<int>>("a", base::Time::fromSeconds(100)));
+    g.disableTimeIndex<Item<int>>("a");
+    g.addItemToFrame("a", Item<int>::create(102, base::Time::fromSeconds(102)));
+    BOOST_CHECK_EQUAL(g.getItemCount<Item<int>>("a"), 2);
+    BOOST_CHECK(g.hasTimeIndex<Item<int>>("a"));
+
+    //policies are copied and removed with their frame
+    EnvireGraph copy(g);
+    BOOST_CHECK(copy.hasRetentionPolicy<Item<int>>("a"));
+    g.removeRetentionPolicy<Item<int>>("a");
+    BOOST_CHECK(!g.hasRetentionPolicy<Item<int>>("a"));
+    g.addItemToFrame("a", Item<int>::create(101, base::Time::fromSeconds(101)));
+    BOOST_CHECK_EQUAL(g.getItemCount<Item<int>>("a"), 3);
+    copy.removeFrame("a");
+    copy.addFrame("a");
+    BOOST_CHECK(!copy.hasRetentionPolicy<Item<int>>("a"));
+}
+
+namespace
+{
+    struct EventCounter : public GraphEventSubscriber
+    {
+        EventCounter(EnvireGraph& graph) : GraphEventSubscriber(&graph) {}
+        virtual void notifyGraphEvent(const GraphEvent& event) { types.push_back(event.getType()); }
+        vector<GraphEvent::Type> types;
+    };
+}
+
+BOOST_AUTO_TEST_CASE(retention_policy_batch_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    for(int i = 0; i < 100; ++i)
+    {
+        g.addItemToFrame("a", Item<int>::create(i, base::Time::fromSeconds(i)));
+    }
+    EventCounter counter(g);
+    ItemEventSubscriber sub(g);
+    EnvireGraph::RetentionPolicy policy;
+    policy.maxCount = 10;
+    g.setRetentionPolicy<Item<int>>("a", policy);
+    //the evicted items are removed in a single batch
+    BOOST_REQUIRE_EQUAL(counter.types.size(), 1);
+    BOOST_CHECK(counter.types[0] == GraphEvent::EVENT_BATCH);
+    BOOST_CHECK_EQUAL(sub.intItemRemovedEvents.size(), 90);
+
+    //nothing to evict, nothing to deliver
+    BOOST_CHECK_EQUAL(g.enforceRetentionPolicies(), 0);
+    BOOST_CHECK_EQUAL(counter.types.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(memory_report_test)
+{
+    //size estimates of common payloads
+    BOOST_CHECK_EQUAL(ItemDataSize<int>::get(1), sizeof(int));
+    std::vector<double> values(100);
+    BOOST_CHECK_EQUAL(ItemDataSize<std::vector<double>>::get(values),
+                      sizeof(values) + values.capacity() * sizeof(double));
+    BOOST_CHECK_EQUAL(ItemDataSize<std::string>::get("a"), sizeof(std::string));
+    const std::string longText(1000, 'x');
+    BOOST_CHECK(ItemDataSize<std::string>::get(longText) > 1000);
+    BOOST_CHECK(ItemDataSize<std::vector<std::string>>::get(std::vector<std::string>(2, longText)) > 2000);
+    Eigen::MatrixXd matrix(10, 10);
+    BOOST_CHECK_EQUAL(ItemDataSize<Eigen::MatrixXd>::get(matrix), sizeof(matrix) + 100 * sizeof(double));
+
+    EnvireGraph g;
+    Transform tf;
+    tf.setIdentity();
+    g.addTransform("a", "b", tf);
+    for(int i = 0; i < 10; ++i)
+    {
+        g.addItemToFrame("a", Item<std::vector<double>>::create(std::vector<double>(1000)));
+    }
+    g.addItemToFrame("b", Item<int>::create(1));
+    TreeView view;
+    g.getTree("a", true, &view);
+
+    const EnvireGraph::MemoryReport report = g.getMemoryReport();
+    BOOST_CHECK_EQUAL(report.items.count, 11);
+    BOOST_CHECK_EQUAL(report.itemsByFrame.at("a").count, 10);
+    BOOST_CHECK_EQUAL(report.itemsByFrame.at("b").count, 1);
+    BOOST_CHECK(report.itemsByFrame.at("a").bytes > 10 * 1000 * sizeof(double));
+    BOOST_CHECK(report.itemsByFrame.at("b").bytes < 1000);
+    BOOST_CHECK_EQUAL(report.itemsByType.size(), 2);
+    BOOST_CHECK_EQUAL(report.items.bytes, report.itemsByFrame.at("a").bytes + report.itemsByFrame.at("b").bytes);
+    BOOST_CHECK(report.vertexBytes > 0);
+    BOOST_CHECK(report.edgeBytes >= 2 * sizeof(Transform));
+    BOOST_CHECK(report.labelMapBytes > 0);
+    BOOST_CHECK(report.indexBytes > 0);
+    BOOST_CHECK(report.treeViewBytes > 0);
+    BOOST_CHECK_EQUAL(report.getTotal(), report.items.bytes + report.getGraphOverhead());
+
+    g.unsubscribeTreeView(&view);
+    g.clearFrame("a");
+    BOOST_CHECK_EQUAL(g.getMemoryReport().items.count, 1);
+    BOOST_CHECK_EQUAL(g.getMemoryReport().treeViewBytes, 0);
+}
@@ -1665,5 +1665,453 @@ BOOST_AUTO_TEST_CASE(event_queue_test)
     BOOST_CHECK(queue.dispatcher.edgeRemovedEvents.size() == 0);
 }
 
+class EventTypeRecorder : public GraphEventSubscriber
+{
+public:
+    EventTypeRecorder(Gra& graph) : GraphEventSubscriber(&graph) {}
+
+    virtual void notifyGraphEvent(const GraphEvent& event)
+    {
+        types.push_back(event.getType());
+    }
+
+    vector<GraphEvent::Type> types;
+};
+
+BOOST_AUTO_TEST_CASE(transaction_batch_event_test)
+{
+    Gra graph;
+    EventTypeRecorder recorder(graph);
+    Dispatcher dispatcher(graph);
+
+    FrameId a = "frame_a";
+    FrameId b = "frame_b";
+    FrameId c = "frame_c";
+    EdgeProp ep;
+
+    graph.beginTransaction();
+    BOOST_CHECK(graph.isInTransaction());
+    graph.addFrame(a);
+    graph.add_edge(a, b, ep);
+    graph.add_edge(a, c, ep);
+    graph.setEdgeProperty(a, b, ep);
+    graph.remove_edge(a, c);
+    graph.removeFrame(c);
+    BOOST_CHECK(recorder.types.empty());
+    BOOST_CHECK(dispatcher.frameAddedEvents.empty());
+    graph.commitTransaction();
+    BOOST_CHECK(!graph.isInTransaction());
+
+    //exactly one event containing the net changes
+    BOOST_CHECK(recorder.types.size() == 1);
+    BOOST_CHECK(recorder.types[0] == GraphEvent::EVENT_BATCH);
+    BOOST_CHECK(dispatcher.frameAddedEvents.size() == 2);
+    BOOST_CHECK(dispatcher.frameRemovedEvents.size() == 0);
+    BOOST_CHECK(dispatcher.edgeAddedEvents.size() == 1);
+    BOOST_CHECK(dispatcher.edgeModifiedEvents.size() == 1);
+    BOOST_CHECK(dispatcher.edgeRemovedEvents.size() == 0);
+
+    //outside of a transaction events are delivered immediately
+    graph.remove_edge(a, b);
+    BOOST_CHECK(recorder.types.size() == 2);
+    BOOST_CHECK(recorder.types[1] == GraphEvent::EDGE_REMOVED);
+
+    BOOST_CHECK_THROW(graph.commitTransaction(), NoActiveTransactionException);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_nested_raii_test)
+{
+    Gra graph;
+    EventTypeRecorder recorder(graph);
+    EdgeProp ep;
+    {
+        Gra::Transaction outer(graph);
+        {
+            Gra::Transaction inner(graph);
+            graph.add_edge("a", "b", ep);
+        }
+        //inner commit does not deliver anything
+        BOOST_CHECK(recorder.types.empty());
+        graph.add_edge("b", "c", ep);
+    }
+    BOOST_CHECK(recorder.types.size() == 1);
 
+    //empty transactions do not cause events
+    {
+        Gra::Transaction transaction(graph);
+    }
+    BOOST_CHECK(recorder.types.size() == 1);
+}
 
+class ThrowingSubscriber : public GraphEventSubscriber
+{
+public:
+    ThrowingSubscriber(Gra& graph) : GraphEventSubscriber(&graph) {}
+
+    virtual void notifyGraphEvent(const GraphEvent& event)
+    {
+        throw std::runtime_error("handler failed");
+    }
+};
+
+BOOST_AUTO_TEST_CASE(transaction_exception_test)
+{
+    Gra graph;
+    EdgeProp ep;
+    EventTypeRecorder recorder(graph);
+    ThrowingSubscriber thrower(graph);
+
+    //exceptions of handlers are propagated on a regular scope exit
+    auto regularExit = [&]()
+    {
+        Gra::Transaction transaction(graph);
+        graph.add_edge("a", "b", ep);
+    };
+    BOOST_CHECK_THROW(regularExit(), std::runtime_error);
+    BOOST_CHECK(!graph.isInTransaction());
+
+    BOOST_CHECK(recorder.types.size() == 1);
+
+    //while the stack is unwound they are dropped instead of terminating
+    try
+    {
+        Gra::Transaction transaction(graph);
+        graph.add_edge("b", "c", ep);
+        throw std::logic_error("aborted");
+    }
+    catch(const std::logic_error&)
+    {
+    }
+    BOOST_CHECK(!graph.isInTransaction());
+    //there is no rollback, the applied modifications are published
+    BOOST_CHECK(graph.containsEdge("b", "c"));
+    BOOST_CHECK(recorder.types.size() == 2);
+
+    //the subscriber list is still usable after a handler threw
+    thrower.unsubscribe();
+    {
+        Gra::Transaction transaction(graph);
+        graph.add_edge("c", "d", ep);
+    }
+    BOOST_CHECK(recorder.types.size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_tree_view_test)
+{
+    Gra graph;
+    EdgeProp ep;
+    graph.add_edge("A", "B", ep);
+    graph.add_edge("B", "C", ep);
+
+    TreeView view;
+    graph.getTree("A", true, &view);
+
+    graph.beginTransaction();
+    graph.remove_edge("B", "C");
+    graph.add_edge("A", "C", ep);
+    graph.add_edge("C", "D", ep);
+    //the view is not updated while the transaction is active
+    BOOST_CHECK(view.tree.find(graph.getVertex("D")) == view.tree.end());
+    graph.commitTransaction();
+
+    const GraphTraits::vertex_descriptor vA = graph.getVertex("A");
+    const GraphTraits::vertex_descriptor vB = graph.getVertex("B");
+    const GraphTraits::vertex_descriptor vC = graph.getVertex("C");
+    const GraphTraits::vertex_descriptor vD = graph.getVertex("D");
+    BOOST_CHECK(view.root == vA);
+    BOOST_CHECK(view.tree[vA].children.size() == 2);
+    BOOST_CHECK(view.tree[vB].children.size() == 0);
+    BOOST_CHECK(view.tree[vC].parent == vA);
+    BOOST_CHECK(view.tree[vD].parent == vC);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_tree_view_net_changes_test)
+{
+    Gra graph;
+    EdgeProp ep;
+    graph.add_edge("A", "B", ep);
+    graph.add_edge("B", "C", ep);
+    graph.add_edge("A", "D", ep);
+
+    TreeView view;
+    graph.getTree("A", true, &view);
+    std::vector<std::pair<GraphTraits::vertex_descriptor, GraphTraits::vertex_descriptor>> removed;
+    int added = 0;
+    view.edgeRemoved.connect([&](GraphTraits::vertex_descriptor origin, GraphTraits::vertex_descriptor target)
+    {
+        removed.emplace_back(origin, target);
+    });
+    view.edgeAdded.connect([&](GraphTraits::vertex_descriptor, GraphTraits::vertex_descriptor)
+    {
+        ++added;
+    });
+
+    graph.beginTransaction();
+    graph.remove_edge("B", "C");
+    graph.commitTransaction();
+
+    BOOST_CHECK(removed.size() == 1);
+    BOOST_CHECK(removed[0].first == graph.getVertex("B"));
+    BOOST_CHECK(removed[0].second == graph.getVertex("C"));
+    BOOST_CHECK(added == 0);
+    BOOST_CHECK(!view.vertexExists(graph.getVertex("C")));
+    BOOST_CHECK(view.edgeExists(graph.getVertex("A"), graph.getVertex("D")));
+
+    //removing and re-adding an edge is no change at all
+    removed.clear();
+    graph.beginTransaction();
+    graph.remove_edge("A", "D");
+    graph.add_edge("A", "D", ep);
+    graph.add_edge("D", "E", ep);
+    graph.commitTransaction();
+    BOOST_CHECK(removed.empty());
+    BOOST_CHECK(added == 1);
+    BOOST_CHECK(view.tree[graph.getVertex("E")].parent == graph.getVertex("D"));
+}
+
+
+
+
+BOOST_AUTO_TEST_CASE(active_subscribers_test)
+{
+    Gra graph;
+    BOOST_CHECK(!graph.hasActiveSubscribers());
+    {
+        EventTypeRecorder recorder(graph);
+        BOOST_CHECK(graph.hasActiveSubscribers());
+        graph.enableEvents(false);
+        BOOST_CHECK(!graph.hasActiveSubscribers());
+        graph.add_edge("a", "b", EdgeProp());
+        BOOST_CHECK(recorder.types.empty());
+        graph.enableEvents(true);
+    }
+    BOOST_CHECK(!graph.hasActiveSubscribers());
+    //mutations without subscribers still work
+    graph.add_edge("b", "c", EdgeProp());
+    graph.remove_edge("a", "b");
+    graph.removeFrame("a");
+    BOOST_CHECK(graph.num_vertices() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(event_statistics_test)
+{
+    Gra graph;
+    EventTypeRecorder recorder(graph);
+    BOOST_CHECK(graph.getStatistics() == nullptr);
+
+    graph.add_edge("a", "b", EdgeProp());
+    graph.enableStatistics();
+    BOOST_REQUIRE(graph.getStatistics() != nullptr);
+    //events published before enabling are not counted
+    BOOST_CHECK(graph.getStatistics()->getEventTypeStatistics(GraphEvent::FRAME_ADDED).count == 0);
+
+    graph.add_edge("b", "c", EdgeProp());
+    graph.setEdgeProperty("b", "c", EdgeProp());
+    graph.setEdgeProperty("b", "c", EdgeProp());
+
+    const GraphEventStatistics* stats = graph.getStatistics();
+    BOOST_CHECK(stats->getEventTypeStatistics(GraphEvent::FRAME_ADDED).count == 1);
+    BOOST_CHECK(stats->getEventTypeStatistics(GraphEvent::EDGE_ADDED).count == 1);
+    BOOST_CHECK(stats->getEventTypeStatistics(GraphEvent::EDGE_MODIFIED).count == 2);
+    BOOST_CHECK(stats->getEventRate(GraphEvent::EDGE_MODIFIED) > 0.0);
+    const GraphEventStatistics::SubscriberStatistics subStats = stats->getSubscriberStatistics(&recorder);
+    BOOST_CHECK(subStats.calls == 4);
+    BOOST_CHECK(subStats.maxTime <= subStats.totalTime);
+    BOOST_CHECK(subStats.typeName.find("EventTypeRecorder") != std::string::npos);
+
+    std::stringstream report;
+    graph.dumpStatistics(report);
+    BOOST_CHECK(report.str().find("EDGE_MODIFIED") != std::string::npos);
+    BOOST_CHECK(report.str().find("EventTypeRecorder") != std::string::npos);
+
+    graph.resetStatistics();
+    BOOST_CHECK(stats->getSubscriberStatistics(&recorder).calls == 0);
+    BOOST_CHECK(stats->getEventTypeStatistics(GraphEvent::EDGE_MODIFIED).count == 0);
+
+    graph.enableStatistics(false);
+    BOOST_CHECK(graph.getStatistics() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(event_queue_statistics_test)
+{
+    Gra graph;
+    EventQueue queue(graph);
+    EdgeProp ep;
+
+    graph.addFrame("a");
+    graph.add_edge("a", "b", ep);
+    graph.setEdgeProperty("a", "b", ep);
+    graph.setEdgeProperty("a", "b", ep);
+    graph.remove_edge("a", "b");
+
+    const GraphEventQueue::Statistics& stats = queue.getStatistics();
+    BOOST_CHECK(stats.receivedEvents == 6);
+    //the edge events cancel each other out
+    BOOST_CHECK(queue.getQueueDepth() == 2);
+    BOOST_CHECK(stats.mergedEvents == 4);
+    BOOST_CHECK(stats.maxDepth == 4);
+    BOOST_CHECK_CLOSE(stats.getMergeRate(), 4.0 / 6.0, 0.001);
+
+    queue.flush();
+    BOOST_CHECK(stats.processedEvents == 2);
+    BOOST_CHECK(queue.getQueueDepth() == 0);
+
+    std::stringstream report;
+    queue.dumpStatistics(report);
+    BOOST_CHECK(report.str().find("max depth") != std::string::npos);
+
+    queue.resetStatistics();
+    BOOST_CHECK(stats.receivedEvents == 0);
+}
+
+BOOST_AUTO_TEST_CASE(frame_subscription_scope_test)
+{
+    Gra graph;
+    Dispatcher all(graph);
+    Dispatcher scoped(graph);
+    EdgeProp ep;
+    graph.setSubscriptionScope(&scoped, {"a", "b"});
+    BOOST_CHECK(graph.hasSubscriptionScope(&scoped));
+    BOOST_CHECK(!graph.hasSubscriptionScope(&all));
+
+    graph.add_edge("c", "d", ep);
+    BOOST_CHECK(all.edgeAddedEvents.size() == 1);
+    BOOST_CHECK(scoped.edgeAddedEvents.empty());
+    BOOST_CHECK(scoped.frameAddedEvents.empty());
+
+    //edge events are delivered if one of the frames is in scope, but only once
+    graph.add_edge("a", "c", ep);
+    graph.add_edge("a", "b", ep);
+    BOOST_CHECK(scoped.edgeAddedEvents.size() == 2);
+    BOOST_CHECK(scoped.frameAddedEvents.size() == 2);
+
+    graph.removeFromSubscriptionScope(&scoped, "b");
+    graph.setEdgeProperty("c", "d", ep);
+    graph.setEdgeProperty("a", "b", ep);
+    BOOST_CHECK(scoped.edgeModifiedEvents.size() == 1);
+    BOOST_CHECK(all.edgeModifiedEvents.size() == 2);
+
+    graph.addToSubscriptionScope(&scoped, "d");
+    graph.setEdgeProperty("c", "d", ep);
+    BOOST_CHECK(scoped.edgeModifiedEvents.size() == 2);
+
+    graph.clearSubscriptionScope(&scoped);
+    graph.setEdgeProperty("b", "a", ep);
+    BOOST_CHECK(scoped.edgeModifiedEvents.size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(frame_subscription_scope_unsubscribed_test)
+{
+    Gra graph;
+    Dispatcher detached;
+    BOOST_CHECK_THROW(graph.setSubscriptionScope(&detached, {"a"}), UnknownSubscriberException);
+    BOOST_CHECK(!graph.hasSubscriptionScope(&detached));
+
+    Dispatcher scoped(graph);
+    graph.setSubscriptionScope(&scoped, {"a"});
+    scoped.unsubscribe();
+    BOOST_CHECK(!graph.hasSubscriptionScope(&scoped));
+    BOOST_CHECK_THROW(graph.setSubscriptionScope(&scoped, {"a"}), UnknownSubscriberException);
+
+    //re-subscribing starts without a scope
+    scoped.subscribe(&graph);
+    graph.add_edge("c", "d", EdgeProp());
+    BOOST_CHECK(scoped.edgeAddedEvents.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(frame_subscription_scope_batch_test)
+{
+    Gra graph;
+    Dispatcher scoped(graph);
+    EventTypeRecorder recorder(graph);
+    graph.setSubscriptionScope(&scoped, {"a"});
+    graph.setSubscriptionScope(&recorder, {"x"});
+    {
+        Gra::Transaction transaction(graph);
+        graph.add_edge("a", "b", EdgeProp());
+        graph.add_edge("c", "d", EdgeProp());
+    }
+    BOOST_CHECK(scoped.frameAddedEvents.size() == 1);
+    BOOST_CHECK(scoped.frameAddedEvents[0].frame == "a");
+    BOOST_CHECK(scoped.edgeAddedEvents.size() == 1);
+    //empty batches are not delivered
+    BOOST_CHECK(recorder.types.empty());
+}
+
+BOOST_AUTO_TEST_CASE(subtree_subscription_scope_test)
+{
+    Gra graph;
+    EdgeProp ep;
+    graph.add_edge("A", "B", ep);
+    graph.add_edge("B", "C", ep);
+    graph.add_edge("A", "D", ep);
+
+    TreeView view;
+    graph.getTree("A", true, &view);
+
+    Dispatcher scoped(graph);
+    graph.setSubtreeSubscriptionScope(&scoped, view, "B");
+    BOOST_CHECK(graph.isInSubscriptionScope(&scoped, "B"));
+    BOOST_CHECK(graph.isInSubscriptionScope(&scoped, "C"));
+    BOOST_CHECK(!graph.isInSubscriptionScope(&scoped, "A"));
+    BOOST_CHECK(!graph.isInSubscriptionScope(&scoped, "D"));
+
+    //frames that are connected to the subtree join the scope
+    graph.add_edge("C", "E", ep);
+    BOOST_CHECK(scoped.edgeAddedEvents.size() == 1);
+    BOOST_CHECK(graph.isInSubscriptionScope(&scoped, "E"));
+
+    graph.add_edge("D", "F", ep);
+    BOOST_CHECK(scoped.edgeAddedEvents.size() == 1);
+
+    //frames that are disconnected leave the scope
+    graph.remove_edge("B", "C");
+    BOOST_CHECK(scoped.edgeRemovedEvents.size() == 1);
+    BOOST_CHECK(!graph.isInSubscriptionScope(&scoped, "C"));
+    BOOST_CHECK(!graph.isInSubscriptionScope(&scoped, "E"));
+    graph.setEdgeProperty("C", "E", ep);
+    BOOST_CHECK(scoped.edgeModifiedEvents.empty());
+
+    //the subtree is updated after transactions as well
+    {
+        Gra::Transaction transaction(graph);
+        graph.add_edge("B", "G", ep);
+    }
+    BOOST_CHECK(graph.isInSubscriptionScope(&scoped, "G"));
+    BOOST_CHECK(!graph.isInSubscriptionScope(&scoped, "D"));
+    graph.setEdgeProperty("B", "G", ep);
+    BOOST_CHECK(scoped.edgeModifiedEvents.size() == 1);
+
+    scoped.unsubscribe();
+    BOOST_CHECK(!graph.hasSubscriptionScope(&scoped));
+    BOOST_CHECK(graph.subtreeScopes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(subtree_subscription_scope_batch_removal_test)
+{
+    Gra graph;
+    EdgeProp ep;
+    graph.add_edge("A", "B", ep);
+    graph.add_edge("B", "C", ep);
+    graph.add_edge("C", "D", ep);
+
+    TreeView view;
+    graph.getTree("A", true, &view);
+    Dispatcher scoped(graph);
+    graph.setSubtreeSubscriptionScope(&scoped, view, "B");
+
+    //C and D leave the scope during the transaction, their removals are still delivered
+    {
+        Gra::Transaction transaction(graph);
+        graph.remove_edge("C", "D");
+        graph.removeFrame("D");
+        graph.remove_edge("B", "C");
+        graph.add_edge("C", "E", ep);
+    }
+    BOOST_CHECK(!graph.isInSubscriptionScope(&scoped, "C"));
+    BOOST_CHECK(scoped.edgeRemovedEvents.size() == 2);
+    BOOST_CHECK(scoped.frameRemovedEvents.size() == 1);
+    //events of frames that are out of scope are not delivered
+    BOOST_CHECK(scoped.edgeAddedEvents.empty());
+    BOOST_CHECK(scoped.frameAddedEvents.empty());
+}
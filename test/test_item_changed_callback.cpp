@@ -202,3 +202,29 @@ BOOST_AUTO_TEST_CASE(item_changed_callback_autoconnect)
      
 }
 
+
+BOOST_AUTO_TEST_CASE(item_version_test)
+{
+     Item<string>::Ptr item(new Item<string>("lalala"));
+     BOOST_CHECK(item->getVersion() == 0);
+
+     //no callback connected
+     item->contentsChanged();
+     item->contentsChanged();
+     BOOST_CHECK(item->getVersion() == 2);
+
+     ItemContentReactor reactor;
+     item->connectContentsChangedCallback([&reactor](const ItemBase& item){reactor.called=true;});
+     item->contentsChanged();
+     BOOST_CHECK(reactor.called == true);
+     BOOST_CHECK(item->getVersion() == 3);
+
+     //copies do not inherit the callbacks
+     reactor.reset();
+     Item<string> copy(*item);
+     BOOST_CHECK(copy.getVersion() == 3);
+     copy.contentsChanged();
+     BOOST_CHECK(reactor.called == false);
+     BOOST_CHECK(copy.getVersion() == 4);
+     BOOST_CHECK(item->getVersion() == 3);
+}
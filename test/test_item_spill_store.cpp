@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/vector.hpp>
+#include <envire_core/items/Item.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/graph/ItemSpillStore.hpp>
+#include <envire_core/serialization/SerializationRegistration.hpp>
+#include <envire_core/items/ItemMetadata.hpp>
+#include <envire_core/events/GraphItemEventDispatcher.hpp>
+#include <vector>
+
+using namespace envire::core;
+
+typedef Item<std::vector<double>> VectorItem;
+ENVIRE_REGISTER_SERIALIZATION(envire::core::Item<std::vector<double>>, std::vector<double>)
+static MetadataInitializer vectorItemMetadata(typeid(VectorItem), "std::vector<double>",
+                                              "envire::core::Item<std::vector<double>>");
+
+typedef Item<float> FloatItem;
+ENVIRE_REGISTER_SERIALIZATION(envire::core::Item<float>, float)
+static MetadataInitializer floatItemMetadata(typeid(FloatItem), "float", "envire::core::Item<float>");
+
+namespace
+{
+    const std::string spillDirectory = "/tmp/envire_core_spill_test";
+
+    std::size_t countFiles()
+    {
+        return std::distance(boost::filesystem::directory_iterator(spillDirectory),
+                             boost::filesystem::directory_iterator());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(item_spill_store_test)
+{
+    boost::filesystem::remove_all(spillDirectory);
+    EnvireGraph g;
+    g.addFrame("a");
+    std::vector<VectorItem::Ptr> items;
+    for(int i = 0; i < 10; ++i)
+    {
+        items.push_back(VectorItem::create(std::vector<double>(100, i)));
+        g.addItemToFrame("a", items.back());
+    }
+    //not serializable, stays resident
+    Item<std::string>::Ptr text = Item<std::string>::create("text");
+    g.addItemToFrame("a", text);
+
+    //the estimate includes the heap memory of the vector
+    const std::size_t itemSize = items.front()->getDataSize();
+    BOOST_CHECK_GE(itemSize, 100 * sizeof(double));
+    {
+        ItemSpillStore store(g, spillDirectory, 4 * itemSize);
+        BOOST_CHECK_EQUAL(store.getResidentBytes(), 4 * itemSize);
+        BOOST_CHECK_EQUAL(store.getSpilledItemCount(), 6);
+        BOOST_CHECK_EQUAL(countFiles(), 6);
+        //the oldest items are spilled first
+        BOOST_CHECK(!items[0]->isDataResident());
+        BOOST_CHECK(items[9]->isDataResident());
+        BOOST_CHECK(text->isDataResident());
+
+        //accessing the data restores it transparently
+        const boost::uuids::uuid id = items[0]->getID();
+        int expected = 0;
+        EnvireGraph::ItemIteratorPair<VectorItem> range = g.getItems<VectorItem>("a");
+        for(EnvireGraph::ItemIterator<VectorItem> it = range.first; it != range.second; ++it)
+        {
+            BOOST_CHECK_EQUAL(it->getData().size(), 100);
+            BOOST_CHECK_EQUAL(it->getData()[0], expected++);
+        }
+        BOOST_CHECK(items[0]->getID() == id);
+        BOOST_CHECK_EQUAL(store.getSpilledItemCount(), 0);
+        BOOST_CHECK_EQUAL(countFiles(), 0);
+
+        //recently used items get a second chance
+        store.enforceBudget();
+        BOOST_CHECK_EQUAL(store.getResidentBytes(), 4 * itemSize);
+        items[3]->getData();
+        store.setMemoryBudget(2 * itemSize);
+        BOOST_CHECK(items[3]->isDataResident());
+
+        //items that share their payload with a copy cannot be released
+        ItemBase::Ptr copy = items[9]->clone();
+        BOOST_CHECK(!store.spill(items[9]));
+        copy.reset();
+        BOOST_CHECK(store.spill(items[9]));
+
+        //removed items keep their data
+        g.removeItemFromFrame(items[9]);
+        BOOST_CHECK_EQUAL(items[9]->getData()[0], 9);
+        g.removeItemFromFrame(items[0]);
+        BOOST_CHECK(!items[0]->isDataResident());
+        items[0].reset(); //its file is removed on the next enforcement
+        store.enforceBudget();
+        BOOST_CHECK_EQUAL(countFiles(), store.getSpilledItemCount());
+
+        //items added later are managed, adding them does not spill
+        const std::size_t spilledBefore = store.getSpilledItemCount();
+        g.addItemToFrame("a", VectorItem::create(std::vector<double>(100, 42)));
+        BOOST_CHECK_EQUAL(store.getSpilledItemCount(), spilledBefore);
+        BOOST_CHECK_GT(store.getResidentBytes(), 2 * itemSize);
+        store.enforceBudget();
+        BOOST_CHECK(store.getResidentBytes() <= 2 * itemSize);
+    }
+    //the store restores all items before it is destroyed
+    for(std::size_t i = 1; i < items.size(); ++i)
+    {
+        BOOST_CHECK(items[i]->isDataResident());
+        BOOST_CHECK_EQUAL(items[i]->getData()[0], i);
+    }
+    BOOST_CHECK_EQUAL(countFiles(), 0);
+    boost::filesystem::remove_all(spillDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(item_spill_store_lost_file_test)
+{
+    boost::filesystem::remove_all(spillDirectory);
+    EnvireGraph g;
+    g.addFrame("a");
+    VectorItem::Ptr item = VectorItem::create(std::vector<double>(100, 1));
+    g.addItemToFrame("a", item);
+    {
+        ItemSpillStore store(g, spillDirectory, 0);
+        BOOST_CHECK(!item->isDataResident());
+        boost::filesystem::remove_all(spillDirectory);
+    }
+    //the data is lost but the item does not refer to the destroyed store
+    BOOST_CHECK(item->isDataResident());
+    const VectorItem& constItem = *item;
+    BOOST_CHECK(constItem.getData().empty());
+}
+
+BOOST_AUTO_TEST_CASE(item_spill_store_inline_test)
+{
+    boost::filesystem::remove_all(spillDirectory);
+    EnvireGraph g;
+    g.addFrame("a");
+    //registered, but the data is stored inline and cannot be freed
+    FloatItem::Ptr small = FloatItem::create(1.0f);
+    g.addItemToFrame("a", small);
+    BOOST_CHECK(!small->hasReleasableData());
+    VectorItem::Ptr shared = VectorItem::create(std::vector<double>(100, 1));
+    VectorItem copy(*shared);
+    g.addItemToFrame("a", shared);
+    BOOST_CHECK(!shared->canReleaseData());
+    {
+        ItemSpillStore store(g, spillDirectory, 0);
+        BOOST_CHECK_EQUAL(store.getResidentBytes(), shared->getDataSize());
+        BOOST_CHECK_EQUAL(store.getSpilledItemCount(), 0);
+        BOOST_CHECK(!store.spill(small));
+        BOOST_CHECK(!store.spill(shared));
+        //nothing has been written
+        BOOST_CHECK_EQUAL(countFiles(), 0);
+        BOOST_CHECK(small->isDataResident());
+    }
+    boost::filesystem::remove_all(spillDirectory);
+}
+
+BOOST_AUTO_TEST_CASE(item_spill_store_retention_test)
+{
+    boost::filesystem::remove_all(spillDirectory);
+    EnvireGraph g;
+    g.addFrame("a");
+    std::vector<VectorItem::Ptr> items;
+    for(int i = 0; i < 4; ++i)
+    {
+        items.push_back(VectorItem::create(std::vector<double>(100, i), base::Time::fromSeconds(i)));
+        g.addItemToFrame("a", items.back());
+    }
+    const std::size_t itemSize = g.getItem<VectorItem>("a")->getDataSize();
+    EnvireGraph::RetentionPolicy policy;
+    policy.maxBytes = 4 * itemSize;
+    policy.checkInterval = 1;
+    g.setRetentionPolicy<VectorItem>("a", policy);
+    {
+        ItemSpillStore store(g, spillDirectory, 0);
+        BOOST_CHECK_EQUAL(store.getSpilledItemCount(), 4);
+
+        //spilled items are counted with the size recorded when they were added
+        g.removeItemFromFrame(items[3]);
+        g.addItemToFrame("a", VectorItem::create(std::vector<double>(100, 4), base::Time::fromSeconds(4)));
+        BOOST_CHECK_EQUAL(g.getItemCount<VectorItem>("a"), 4);
+        g.addItemToFrame("a", VectorItem::create(std::vector<double>(100, 5), base::Time::fromSeconds(5)));
+        BOOST_CHECK_EQUAL(g.getItemCount<VectorItem>("a"), 4);
+        BOOST_CHECK(!g.containsItem(items[0]->getID()));
+    }
+    boost::filesystem::remove_all(spillDirectory);
+}
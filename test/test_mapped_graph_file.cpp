@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2015, Deutsches Forschungszentrum für Künstliche Intelligenz GmbH.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/vector.hpp>
+#include <envire_core/items/Item.hpp>
+#include <envire_core/graph/EnvireGraph.hpp>
+#include <envire_core/graph/GraphExceptions.hpp>
+#include <envire_core/graph/MappedGraphFile.hpp>
+#include <envire_core/serialization/SerializationRegistration.hpp>
+#include <envire_core/items/ItemMetadata.hpp>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace envire::core;
+
+typedef Item<std::vector<float>> FloatVectorItem;
+ENVIRE_REGISTER_SERIALIZATION(envire::core::Item<std::vector<float>>, std::vector<float>)
+static MetadataInitializer floatVectorItemMetadata(typeid(FloatVectorItem), "std::vector<float>",
+                                                   "envire::core::Item<std::vector<float>>");
+
+typedef Item<double> DoubleItem;
+ENVIRE_REGISTER_SERIALIZATION(envire::core::Item<double>, double)
+static MetadataInitializer doubleItemMetadata(typeid(DoubleItem), "double",
+                                              "envire::core::Item<double>");
+
+namespace
+{
+    const std::string mappedGraphFile = "/tmp/envire_core_mapped_graph_test";
+}
+
+BOOST_AUTO_TEST_CASE(mapped_graph_file_test)
+{
+    EnvireGraph g;
+    Transform ab(base::Time::fromSeconds(1), base::Position(1, 2, 3),
+                 base::Orientation(Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitZ())),
+                 base::Matrix6d::Identity() * 0.25);
+    Transform bc(base::Position(0, 0, 1), base::Orientation::Identity());
+    g.addTransform("a", "b", ab);
+    g.addTransform("b", "c", bc);
+    g.addFrame("d");
+
+    std::vector<FloatVectorItem::Ptr> items;
+    for(int i = 0; i < 5; ++i)
+    {
+        items.push_back(FloatVectorItem::create(std::vector<float>(1000, i), base::Time::fromSeconds(i)));
+        g.addItemToFrame("b", items.back());
+    }
+    DoubleItem::Ptr number = DoubleItem::create(42.0);
+    g.addItemToFrame("c", number);
+    //not registered, is not stored
+    g.addItemToFrame("c", Item<std::string>::create("text"));
+
+    MappedGraphFile::save(g, mappedGraphFile);
+
+    EnvireGraph loaded;
+    {
+        MappedGraphFile file(mappedGraphFile);
+        BOOST_CHECK_EQUAL(file.getFrameCount(), 4);
+        BOOST_CHECK_EQUAL(file.getEdgeCount(), 2);
+        BOOST_CHECK_EQUAL(file.getItemCount(), 6);
+        BOOST_CHECK_EQUAL(file.load(loaded), 6);
+
+        //the structure is available without decoding any item
+        BOOST_CHECK_EQUAL(loaded.num_vertices(), 4);
+        BOOST_CHECK_EQUAL(loaded.num_edges(), 4);
+        BOOST_CHECK(loaded.containsFrame("d"));
+        const Transform tf = loaded.getTransform("a", "b");
+        BOOST_CHECK(tf.time == ab.time);
+        BOOST_CHECK(tf.transform.translation.isApprox(ab.transform.translation));
+        BOOST_CHECK(tf.transform.orientation.isApprox(ab.transform.orientation));
+        BOOST_CHECK(tf.transform.cov.isApprox(ab.transform.cov));
+        BOOST_CHECK(loaded.getTransform("c", "a").transform.translation.isApprox(g.getTransform("c", "a").transform.translation));
+        BOOST_CHECK_EQUAL(file.getLazyItemCount(), 5);
+
+        BOOST_CHECK_EQUAL(loaded.getItemCount<FloatVectorItem>("b"), 5);
+        const EnvireGraph::ItemIterator<FloatVectorItem> first = loaded.getItem<FloatVectorItem>("b");
+        BOOST_CHECK(first->getID() == items[0]->getID());
+        BOOST_CHECK(first->getTime() == items[0]->getTime());
+        BOOST_CHECK_EQUAL(first->getFrame(), "b");
+        BOOST_CHECK(!first->isDataResident());
+
+        //the data is decoded on access
+        BOOST_CHECK_EQUAL(first->getData().size(), 1000);
+        BOOST_CHECK_EQUAL(first->getData()[0], 0);
+        BOOST_CHECK(first->isDataResident());
+        BOOST_CHECK_EQUAL(file.getLazyItemCount(), 4);
+
+        //inline data is decoded during the load
+        const EnvireGraph::ItemIterator<DoubleItem> numberIt = loaded.getItem<DoubleItem>("c");
+        BOOST_CHECK(numberIt->isDataResident());
+        BOOST_CHECK_EQUAL(numberIt->getData(), 42.0);
+        BOOST_CHECK(numberIt->getID() == number->getID());
+
+        //time queries do not decode the data
+        const FloatVectorItem::Ptr nearest = loaded.getNearestItem<FloatVectorItem>("b", base::Time::fromSeconds(3.9));
+        BOOST_CHECK(nearest->getID() == items[4]->getID());
+        BOOST_CHECK_EQUAL(file.getLazyItemCount(), 4);
+    }
+    //closing the file decodes the remaining items
+    EnvireGraph::ItemIteratorPair<FloatVectorItem> range = loaded.getItems<FloatVectorItem>("b");
+    int expected = 0;
+    for(EnvireGraph::ItemIterator<FloatVectorItem> it = range.first; it != range.second; ++it)
+    {
+        BOOST_CHECK(it->isDataResident());
+        BOOST_CHECK_EQUAL(it->getData()[999], expected++);
+    }
+    BOOST_CHECK_EQUAL(expected, 5);
+
+    //an empty graph
+    MappedGraphFile::save(EnvireGraph(), mappedGraphFile);
+    {
+        EnvireGraph empty;
+        MappedGraphFile file(mappedGraphFile);
+        BOOST_CHECK_EQUAL(file.load(empty), 0);
+        BOOST_CHECK_EQUAL(empty.num_vertices(), 0);
+    }
+
+    //files of the boost serialization are rejected
+    g.saveToFile(mappedGraphFile);
+    BOOST_CHECK_THROW(MappedGraphFile file(mappedGraphFile), InvalidGraphFileException);
+    {
+        std::ofstream truncated(mappedGraphFile, std::ios::trunc);
+        truncated << "ENVGRAPH";
+    }
+    BOOST_CHECK_THROW(MappedGraphFile file(mappedGraphFile), InvalidGraphFileException);
+    boost::filesystem::remove(mappedGraphFile);
+    BOOST_CHECK_THROW(MappedGraphFile file(mappedGraphFile), InvalidGraphFileException);
+}
+
+BOOST_AUTO_TEST_CASE(mapped_graph_file_partial_load_test)
+{
+    EnvireGraph g;
+    Transform tf(base::Position(1, 0, 0), base::Orientation::Identity());
+    g.addTransform("world", "robot", tf);
+    g.addTransform("robot", "arm", tf);
+    g.addTransform("arm", "hand", tf);
+    g.addTransform("world", "map", tf);
+    for(const FrameId& frame : std::vector<FrameId>{"robot", "arm", "map"})
+    {
+        g.addItemToFrame(frame, FloatVectorItem::create(std::vector<float>(10, 1)));
+    }
+    g.addItemToFrame("hand", DoubleItem::create(1.0));
+    g.addItemToFrame("map", DoubleItem::create(2.0));
+    MappedGraphFile::save(g, mappedGraphFile);
+
+    MappedGraphFile file(mappedGraphFile);
+    GraphLoadOptions structureOnly;
+    structureOnly.structureOnly = true;
+    EnvireGraph structure;
+    BOOST_CHECK_EQUAL(file.load(structure, structureOnly), 0);
+    BOOST_CHECK_EQUAL(structure.num_vertices(), 5);
+    BOOST_CHECK_EQUAL(structure.num_edges(), 8);
+    BOOST_CHECK_EQUAL(file.getLazyItemCount(), 0);
+
+    EnvireGraph numbers;
+    BOOST_CHECK_EQUAL(file.load(numbers, GraphLoadOptions().includeItems<DoubleItem>()), 2);
+    BOOST_CHECK_EQUAL(numbers.getTotalItemCount("map"), 1);
+    BOOST_CHECK_EQUAL(numbers.getItemCount<DoubleItem>("map"), 1);
+
+    EnvireGraph vectors;
+    BOOST_CHECK_EQUAL(file.load(vectors, GraphLoadOptions().excludeItems<DoubleItem>()), 3);
+    BOOST_CHECK_EQUAL(vectors.getTotalItemCount("hand"), 0);
+    BOOST_CHECK_EQUAL(file.getLazyItemCount(), 3);
+
+    //the subtree is selected using the structure
+    EnvireGraph robot;
+    GraphLoadOptions subtree;
+    subtree.selectSubtree(structure, structure.getTree("world"), "robot");
+    BOOST_CHECK_EQUAL(file.load(robot, subtree), 3);
+    BOOST_CHECK_EQUAL(robot.num_vertices(), 3);
+    BOOST_CHECK_EQUAL(robot.num_edges(), 4);
+    BOOST_CHECK(!robot.containsFrame("world"));
+    BOOST_CHECK_EQUAL(robot.getItemCount<DoubleItem>("hand"), 1);
+    BOOST_CHECK(robot.getTransform("robot", "hand").transform.translation.isApprox(base::Position(2, 0, 0)));
+
+    EnvireGraph map;
+    BOOST_CHECK_EQUAL(file.load(map, GraphLoadOptions().selectFramesMatching("ma.*")), 2);
+    BOOST_CHECK_EQUAL(map.num_vertices(), 1);
+    BOOST_CHECK_EQUAL(map.num_edges(), 0);
+    BOOST_CHECK_EQUAL(map.getItem<DoubleItem>("map")->getData(), 2.0);
+    BOOST_CHECK_EQUAL(map.getItem<FloatVectorItem>("map")->getData()[9], 1);
+}
+
+BOOST_AUTO_TEST_CASE(mapped_graph_file_concurrent_decode_test)
+{
+    EnvireGraph g;
+    g.addFrame("a");
+    for(int i = 0; i < 50; ++i)
+    {
+        g.addItemToFrame("a", FloatVectorItem::create(std::vector<float>(1000, i)));
+    }
+    MappedGraphFile::save(g, mappedGraphFile);
+
+    EnvireGraph loaded;
+    MappedGraphFile file(mappedGraphFile);
+    BOOST_CHECK_EQUAL(file.load(loaded), 50);
+    std::vector<FloatVectorItem::Ptr> items;
+    EnvireGraph::ItemIteratorPair<FloatVectorItem> range = loaded.getItems<FloatVectorItem>("a");
+    for(EnvireGraph::ItemIterator<FloatVectorItem> it = range.first; it != range.second; ++it)
+    {
+        items.push_back(boost::dynamic_pointer_cast<FloatVectorItem>(*it.base()));
+    }
+
+    //every item is decoded exactly once while all threads read it
+    std::vector<std::thread> threads;
+    std::vector<float> sums(4, 0);
+    for(std::size_t t = 0; t < sums.size(); ++t)
+    {
+        threads.emplace_back([&items, &sums, t]()
+        {
+            for(const FloatVectorItem::Ptr& item : items)
+            {
+                sums[t] += item->getData()[999];
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for(const float sum : sums)
+    {
+        BOOST_CHECK_EQUAL(sum, 49 * 50 / 2);
+    }
+    BOOST_CHECK_EQUAL(file.getLazyItemCount(), 0);
+    boost::filesystem::remove(mappedGraphFile);
+}
@@ -608,3 +608,60 @@ BOOST_AUTO_TEST_CASE(get_path_transform_dirty_exception_test)
     BOOST_CHECK_THROW(graph.getTransform(path), InvalidPathException);
 }
 
+
+BOOST_AUTO_TEST_CASE(transform_points_test)
+{
+    Tfg g;
+    Transform worldToA;
+    worldToA.transform.translation << 1, 2, 3;
+    worldToA.transform.orientation = Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitZ());
+    Transform aToSensor;
+    aToSensor.transform.translation << 0, 0, 1;
+    aToSensor.transform.orientation = Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX());
+    g.addTransform("world", "a", worldToA);
+    g.addTransform("a", "sensor", aToSensor);
+    g.addFrame("unconnected");
+
+    //large enough to be split across threads
+    const size_t n = 200000;
+    std::vector<Eigen::Vector3d> points(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        points[i] << i * 0.001, -0.5 * (i % 100), 7;
+    }
+    const std::vector<Eigen::Vector3d> original(points);
+    const Eigen::Affine3d expected = g.getTransform("world", "sensor").transform.getTransform();
+
+    g.transformPoints("sensor", "world", points, 4);
+    for(size_t i = 0; i < n; i += 997)
+    {
+        BOOST_CHECK(points[i].isApprox(expected * original[i]));
+    }
+    //transforming back restores the points
+    g.transformPoints("world", "sensor", points, 0);
+    for(size_t i = 0; i < n; i += 997)
+    {
+        BOOST_CHECK_SMALL((points[i] - original[i]).norm(), 1e-9);
+    }
+
+    //float into an output buffer
+    Eigen::Matrix3Xf in(3, 10);
+    in.setRandom();
+    Eigen::Matrix3Xf out(3, 10);
+    g.transformPoints("sensor", "world", in.data(), out.data(), 10);
+    Eigen::Matrix3Xf normals(in);
+    g.transformNormals("sensor", "world", normals);
+    const Eigen::Affine3f expectedf = expected.cast<float>();
+    for(int i = 0; i < 10; ++i)
+    {
+        BOOST_CHECK(out.col(i).isApprox(expectedf * in.col(i).eval(), 1e-5f));
+        BOOST_CHECK(normals.col(i).isApprox(expectedf.linear() * in.col(i), 1e-5f));
+    }
+
+    //same frame is the identity
+    g.transformPoints("sensor", "sensor", out);
+    BOOST_CHECK(out.col(0).isApprox(expectedf * in.col(0).eval(), 1e-5f));
+
+    BOOST_CHECK_THROW(g.transformPoints("sensor", "unconnected", points), UnknownTransformException);
+    BOOST_CHECK_THROW(g.transformPoints("sensor", "missing", points), UnknownFrameException);
+}